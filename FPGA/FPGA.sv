@@ -3,7 +3,8 @@
 // Date: 11/7/2018
 // Summary: Top-level module for FPGA multi-effects 
 
-module FPGA(input logic clk,                        // 40 MHz clock
+module FPGA #(parameter STEREO = 1'b0)               // also send ADC channel 1 to the Pi
+            (input logic clk,                       // 40 MHz clock
             input logic reset,                      // hardware reset
             input logic dinAdc,                     // MISO from ADC
             input logic echo,                       // echo pin of ultrasonic sensor
@@ -19,7 +20,14 @@ module FPGA(input logic clk,                        // 40 MHz clock
     // Wires between modules
     logic [12:0] address;       // address at which we read or write to RAM
     logic WE;                   // write enable for RAM
-    logic [9:0] sampleVoltage;  // voltage read from ADC (unsigned)
+    logic [9:0] adcVoltage;     // shift register of the ADC (unsigned)
+    logic [9:0] sampleVoltage;  // voltage read from ADC channel 0 (unsigned)
+    logic [9:0] leftVoltage;    // voltage latched from ADC channel 0 in stereo (unsigned)
+    logic [9:0] rightVoltage;   // voltage latched from ADC channel 1 in stereo (unsigned)
+    logic [9:0] rightOffset;    // voltage bias of ADC channel 1 (unsigned)
+    logic [10:0] rightDiff;     // channel 1 voltage after removing offset (2's comp)
+    logic [10:0] rightSend;     // channel 1 voltage to send to pi (sign-magnitude)
+    logic [21:0] piVoltage;     // all voltages to send to pi this round (sign-magnitude)
     logic [10:0] readVoltage;   // voltage read from RAM (sign-magnitude)
     logic [10:0] writeVoltage;  // voltage to write into RAM (sign-magnitude)
     logic [10:0] sendVoltage;   // voltage to send to pi (sign-magnitude)
@@ -27,10 +35,12 @@ module FPGA(input logic clk,                        // 40 MHz clock
     logic [3:0] intensity;      // inverse of distance detected by ultrasonic sensor
 
     // Modules
-    adc adc1(sclkAdc, reset, !counter[9], 1'b0, dinAdc, doutAdc, ncsAdc, sampleVoltage);
-    pi pi1(sclkPi, reset, !counter[9], sendVoltage, doutPi, ncsPi);
+    adc adc1(sclkAdc, reset, STEREO ? !counter[8] : !counter[9], STEREO ? counter[9] : 1'b0, 
+        dinAdc, doutAdc, ncsAdc, adcVoltage);
+    pi #(STEREO ? 22 : 11) pi1(sclkPi, reset, !counter[9], piVoltage, doutPi, ncsPi);
     mem mem1(clk, WE, address, writeVoltage, readVoltage);
     calibrate calibrate1(reset, !counter[9], switch, sampleVoltage, offset);
+    calibrate calibrate2(reset, !counter[9], switch, rightVoltage, rightOffset);
     distance distance1(clk, reset, echo, trig, intensity);
     effects effects1(clk, reset, switch, counter, sampleVoltage, offset, readVoltage, intensity, 
         sendVoltage, writeVoltage, address);
@@ -40,10 +50,23 @@ module FPGA(input logic clk,                        // 40 MHz clock
         if (reset)  counter <= 1'b0;
         else        counter <= (counter == 10'd832) ? 1'b0 : counter + 1'b1;
 
+    // In stereo, the ADC converts channel 0 in the first half of each round and channel 1 in 
+    // the second half, so latch each voltage before the next conversion shifts over it
+    always_ff @(posedge clk)
+        if (counter == 10'h1FF)         leftVoltage <= adcVoltage;
+        else if (counter == 10'd832)    rightVoltage <= adcVoltage;
+
     // Assign wires
     assign WE = (counter == 10'd832);           // store writeVoltage on last clk of each cycle
     assign sclkAdc = counter[3];                // ADC's sclk = 2.5 MHz (16 clks)
-    assign sclkPi = counter[5];                 // Pi's sclk  = 625 KHz (64 clks)
+    assign sclkPi = STEREO ? counter[4]         // Pi's sclk  = 1.25 MHz (32 clks) in stereo
+        : counter[5];                           // otherwise 625 KHz (64 clks)
+    assign sampleVoltage = STEREO ? leftVoltage : adcVoltage;
+
+    // Channel 1 bypasses the effects: remove its offset and send it after channel 0
+    assign rightDiff = {1'b0, rightVoltage} - {1'b0, rightOffset};
+    assign rightSend = rightDiff[10] ? {1'b1, -rightDiff[9:0]} : {1'b0, rightDiff[9:0]};
+    assign piVoltage = STEREO ? {sendVoltage, rightSend} : {11'b0, sendVoltage};
     assign led = switch[4] ?                    // LEDs display distance sensor if it is on
         {4'b0, intensity} : sendVoltage[9:2];   // otherwise, they display sendVoltage 
 endmodule
@@ -392,6 +392,24 @@ typedef struct
 #define GPLEV1bits (* (volatile gplev1bits*) (gpio + 14))   
 #define GPLEV1 (* (volatile unsigned int *) (gpio + 14)) 
 
+// Event Detect Status (write 1 to clear)
+#define GPEDS    ((volatile unsigned int *) (gpio + 16))
+#define GPEDS0 (* (volatile unsigned int *) (gpio + 16))
+#define GPEDS1 (* (volatile unsigned int *) (gpio + 17))
+
+// Rising Edge Detect Enable
+#define GPREN    ((volatile unsigned int *) (gpio + 19))
+#define GPREN0 (* (volatile unsigned int *) (gpio + 19))
+#define GPREN1 (* (volatile unsigned int *) (gpio + 20))
+
+// Falling Edge Detect Enable
+#define GPFEN    ((volatile unsigned int *) (gpio + 22))
+#define GPFEN0 (* (volatile unsigned int *) (gpio + 22))
+#define GPFEN1 (* (volatile unsigned int *) (gpio + 23))
+
+// GPIO interrupts (gpio_int[0..3]) in IRQ_ENABLE2/IRQ_DISABLE2
+#define GPIO_IRQS (0xF << 17)
+
 /////////////////////////////////////////////////////////////////////
 // SPI Registers
 /////////////////////////////////////////////////////////////////////
@@ -608,8 +626,12 @@ typedef struct
 #define PWM_CTLbits (* (volatile pwm_ctlbits *) (pwm + 0))
 #define PWM_CTL (*(volatile unsigned int *) (pwm + 0))
 
+#define PWM_STA (*(volatile unsigned int *) (pwm + 1))
 #define PWM_RNG1 (*(volatile unsigned int *) (pwm + 4))
 #define PWM_DAT1 (*(volatile unsigned int *) (pwm + 5))
+#define PWM_FIF1 (*(volatile unsigned int *) (pwm + 6))
+#define PWM_RNG2 (*(volatile unsigned int *) (pwm + 8))
+#define PWM_DAT2 (*(volatile unsigned int *) (pwm + 9))
 
 /////////////////////////////////////////////////////////////////////
 // Clock Manager Registers
@@ -839,6 +861,63 @@ int digitalReads(int pins[], int numPins) {
     return val;
 }
 
+/**
+ * Returns the levels of pins 0-31 in a single read
+ */
+unsigned int digitalReadAll(void) {
+    return GPLEV0;
+}
+
+// GPIO interrupts masked by pinEdgeDetect and pins it latches edges of
+unsigned int edgeIrqs, edgePins[2];
+
+/**
+ * Latch rising and/or falling edges of a pin in GPEDS.
+ * The kernel's GPIO driver ignores events on pins it doesn't own without
+ * clearing them, so the GPIO interrupts would fire continuously; they are
+ * masked in the ARM interrupt controller instead, which stops the kernel's
+ * own GPIO interrupts (gpio-keys and the like) until pinEdgeRelease() gives
+ * them back.  Requires pioInit().
+ */
+void pinEdgeDetect(int pin, int rising, int falling) {
+    int reg = pin / 32;
+    int offset = pin % 32;
+
+    edgeIrqs |= IRQ_ENABLE2 & GPIO_IRQS;
+    IRQ_DISABLE2 = GPIO_IRQS;
+    edgePins[reg] |= 1 << offset;
+    if (rising)  GPREN[reg] |=  (1 << offset);
+    else         GPREN[reg] &= ~(1 << offset);
+    if (falling) GPFEN[reg] |=  (1 << offset);
+    else         GPFEN[reg] &= ~(1 << offset);
+    GPEDS[reg] = 1 << offset;   // discard any stale event
+}
+
+/**
+ * Stop latching edges of the pins given to pinEdgeDetect and unmask the GPIO
+ * interrupts it masked.  Safe to call from a signal handler.
+ */
+void pinEdgeRelease(void) {
+    for (int reg = 0; reg < 2; ++reg) {
+        GPREN[reg] &= ~edgePins[reg];
+        GPFEN[reg] &= ~edgePins[reg];
+        GPEDS[reg] = edgePins[reg];
+        edgePins[reg] = 0;
+    }
+    IRQ_ENABLE2 = edgeIrqs;
+    edgeIrqs = 0;
+}
+
+/**
+ * Returns the latched edge events of the pins 0-31 selected by mask
+ * and clears them, so each edge is reported once
+ */
+unsigned int readEdgeEvents(unsigned int mask) {
+    unsigned int events = GPEDS0 & mask;
+    GPEDS0 = events;
+    return events;
+}
+
 /////////////////////////////////////////////////////////////////////
 // Timer Functions
 /////////////////////////////////////////////////////////////////////
@@ -939,6 +1018,8 @@ void pwmInit() {
     while (!CM_PWMCTLbits.BUSY);    // Wait for generator to start    
     PWM_CTLbits.MSEN1 = 0;  // Use PW algorithm (not mark/space)
     PWM_CTLbits.PWEN1 = 1;  // Enable pwm Channel 1
+    PWM_CTLbits.MSEN2 = 0;  // Channel 2 (GPIO 41) drives the other side of the audio jack
+    PWM_CTLbits.PWEN2 = 1;  // Enable pwm Channel 2
 }
 
 /**
@@ -950,6 +1031,44 @@ void setPWM(float freq, float dut) {
     PWM_DAT1 = (int)(dut * (CM_FREQUENCY / freq));
 }
 
+/**
+ * Same as setPWM, but for PWM channel 2 (GPIO 41)
+ */
+void setPWM2(float freq, float dut) {
+    PWM_RNG2 = (int)(CM_FREQUENCY / freq);
+    PWM_DAT2 = (int)(dut * (CM_FREQUENCY / freq));
+}
+
+/**
+ * Feed both PWM channels from the FIFO instead of DAT1 and DAT2.
+ * The channels take words from the FIFO in turn, and repeat their
+ * last word if it runs empty.
+ * range is the number of PWM clock cycles in each period
+ */
+void pwmFifoInit(unsigned int range) {
+    PWM_RNG1 = range;
+    PWM_RNG2 = range;
+    PWM_CTLbits.CLRF1 = 1;  // Empty the FIFO
+    PWM_CTLbits.RPTL1 = 1;
+    PWM_CTLbits.RPTL2 = 1;
+    PWM_CTLbits.USEF1 = 1;
+    PWM_CTLbits.USEF2 = 1;
+}
+
+/**
+ * Returns true when the PWM FIFO can't take another word
+ */
+int pwmFifoFull() {
+    return PWM_STA & 0x1;
+}
+
+/**
+ * Queue a word for the next PWM channel to start a period
+ */
+void pwmFifoWrite(unsigned int data) {
+    PWM_FIF1 = data;
+}
+
 void analogWrite(int val) {
 	setPWM(78125, val/255.0);
 }
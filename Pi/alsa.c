@@ -0,0 +1,221 @@
+// Date: 10/19/2026
+// Summary: Plays the output through an ALSA device (USB, HDMI or headphones) instead of the PWM
+
+#include <string.h>
+#include <unistd.h>
+#include "alsa.h"
+
+#ifdef HAVE_ALSA
+
+/**
+ * \brief Thread which recovers the stream from the errors the audio loop hands it
+ */
+static void* recoverThread(void* arg)
+{
+    AlsaOutput* out = arg;
+    int error;
+
+    while (!atomic_load(&out->stop))
+    {
+        error = atomic_load(&out->error);
+        if (error)
+        {
+            snd_pcm_recover(out->pcm, error, 1);
+            atomic_store(&out->error, 0);
+        }
+        usleep(ALSA_RECOVER_POLL);
+    }
+    return NULL;
+}
+
+/**
+ * \brief Close a stream whose helper thread isn't running
+ */
+static void closePcm(AlsaOutput* out)
+{
+    if (out->pcm != NULL)
+    {
+        snd_pcm_close(out->pcm);
+        out->pcm = NULL;
+    }
+}
+
+int alsaOpen(AlsaOutput* out, const char* device, int channels, size_t period, size_t periods)
+{
+    snd_pcm_hw_params_t* params;
+    snd_pcm_uframes_t periodFrames = period;
+    snd_pcm_uframes_t bufferFrames = period * periods;
+    unsigned int rate = SAMPLE_RATE;
+
+    out->pcm = NULL;
+    out->channels = channels;
+    out->pendingFrames = 0;
+    out->xruns = 0;
+    out->dropped = 0;
+    atomic_init(&out->error, 0);
+    atomic_init(&out->stop, 0);
+    if (channels < 1 || channels > MAX_CHANNELS || period == 0 || period > ALSA_MAX_PERIOD
+        || periods < 2)
+    {
+        return -1;
+    }
+
+    // Open without blocking so that a full buffer never stalls the audio loop
+    if (snd_pcm_open(&out->pcm, device, SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK) < 0)
+    {
+        out->pcm = NULL;
+        return -1;
+    }
+    snd_pcm_hw_params_alloca(&params);
+    if (snd_pcm_hw_params_any(out->pcm, params) < 0
+        || snd_pcm_hw_params_set_access(out->pcm, params, SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0
+        || snd_pcm_hw_params_set_format(out->pcm, params, SND_PCM_FORMAT_S16) < 0
+        || snd_pcm_hw_params_set_channels(out->pcm, params, channels) < 0
+        || snd_pcm_hw_params_set_rate_near(out->pcm, params, &rate, NULL) < 0
+        || rate != SAMPLE_RATE
+        || snd_pcm_hw_params_set_period_size_near(out->pcm, params, &periodFrames, NULL) < 0
+        || snd_pcm_hw_params_set_buffer_size_near(out->pcm, params, &bufferFrames) < 0
+        || snd_pcm_hw_params(out->pcm, params) < 0)
+    {
+        closePcm(out);
+        return -1;
+    }
+
+    // The device may have rounded the sizes to ones it supports
+    snd_pcm_hw_params_get_period_size(params, &periodFrames, NULL);
+    snd_pcm_hw_params_get_buffer_size(params, &bufferFrames);
+    if (periodFrames > ALSA_MAX_PERIOD || bufferFrames < 2 * periodFrames)
+    {
+        closePcm(out);
+        return -1;
+    }
+    out->period = periodFrames;
+    out->buffer = bufferFrames;
+
+    if (pthread_create(&out->thread, NULL, recoverThread, out))
+    {
+        closePcm(out);
+        return -1;
+    }
+    return 0;
+}
+
+void alsaClose(AlsaOutput* out)
+{
+    if (out->pcm != NULL)
+    {
+        atomic_store(&out->stop, 1);
+        pthread_join(out->thread, NULL);
+        closePcm(out);
+    }
+}
+
+/**
+ * \brief Copy the pending period into the device's buffer
+ */
+static void writePeriod(AlsaOutput* out)
+{
+    const snd_pcm_channel_area_t* areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t frames;
+    snd_pcm_sframes_t avail;
+    size_t done = 0;
+    short* dst;
+
+    // The stream belongs to the helper thread until it has recovered
+    if (atomic_load(&out->error))
+    {
+        return;
+    }
+
+    // After an underrun the stream must be prepared again, which the helper thread does
+    avail = snd_pcm_avail_update(out->pcm);
+    if (avail < 0)
+    {
+        out->xruns++;
+        atomic_store(&out->error, (int)avail);
+        return;
+    }
+    if ((size_t)avail < out->period)
+    {
+        out->dropped++;
+        return;
+    }
+
+    // The free space may wrap around the end of the buffer, which takes two copies
+    while (done < out->period)
+    {
+        frames = out->period - done;
+        if (snd_pcm_mmap_begin(out->pcm, &areas, &offset, &frames) < 0)
+        {
+            return;
+        }
+        dst = (short*)((char*)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8);
+        memcpy(dst, out->pending + done * out->channels, frames * out->channels * sizeof(short));
+        if (snd_pcm_mmap_commit(out->pcm, offset, frames) != (snd_pcm_sframes_t)frames)
+        {
+            return;
+        }
+        done += frames;
+    }
+
+    // Writing through mmap never starts the stream, so start it once two periods are queued
+    if (snd_pcm_state(out->pcm) == SND_PCM_STATE_PREPARED
+        && out->buffer - avail + out->period >= 2 * out->period)
+    {
+        snd_pcm_start(out->pcm);
+    }
+}
+
+void alsaWrite(AlsaOutput* out, const short* frame)
+{
+    memcpy(out->pending + out->pendingFrames * out->channels, frame,
+        out->channels * sizeof(short));
+    if (++out->pendingFrames == out->period)
+    {
+        writePeriod(out);
+        out->pendingFrames = 0;
+    }
+}
+
+size_t alsaLatency(AlsaOutput* out)
+{
+    snd_pcm_sframes_t delay;
+
+    if (atomic_load(&out->error) || snd_pcm_delay(out->pcm, &delay) < 0 || delay < 0)
+    {
+        return 0;
+    }
+    return delay + out->pendingFrames;
+}
+
+#else
+
+int alsaOpen(AlsaOutput* out, const char* device, int channels, size_t period, size_t periods)
+{
+    (void)out;
+    (void)device;
+    (void)channels;
+    (void)period;
+    (void)periods;
+    return -1;
+}
+
+void alsaClose(AlsaOutput* out)
+{
+    (void)out;
+}
+
+void alsaWrite(AlsaOutput* out, const short* frame)
+{
+    (void)out;
+    (void)frame;
+}
+
+size_t alsaLatency(AlsaOutput* out)
+{
+    (void)out;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,80 @@
+// Date: 10/19/2026
+// Summary: Plays the output through an ALSA device (USB, HDMI or headphones) instead of the PWM
+
+#ifndef ALSA_H
+#define ALSA_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "wav.h"
+
+#ifdef HAVE_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+#define ALSA_PERIOD 64              // default frames per period (1.33 ms)
+#define ALSA_PERIODS 3              // default periods in the device's buffer
+#define ALSA_MAX_PERIOD 4096        // largest period accepted
+#define ALSA_RECOVER_POLL 1000      // time in us between checks for a stream to recover
+
+/**
+ * \brief An ALSA playback stream written through mmap
+ *
+ * The audio loop is paced by the FPGA, not by the sound card, so the stream never blocks:
+ * frames are gathered into a period and copied straight into the device's buffer once there
+ * is room for a whole period.  A period which finds no room is dropped.  An underrun (or a
+ * suspend) is handed to a helper thread, since snd_pcm_recover can sleep; periods are thrown
+ * away until it has prepared the stream, which restarts once two periods are queued again.
+ */
+typedef struct
+{
+#ifdef HAVE_ALSA
+    snd_pcm_t* pcm;                         // playback stream
+#endif
+    int channels;                           // channels played
+    size_t period;                          // frames per period
+    size_t buffer;                          // frames in the device's buffer
+    short pending[ALSA_MAX_PERIOD * MAX_CHANNELS];  // frames waiting to fill a period
+    size_t pendingFrames;                   // frames in pending
+    size_t xruns;                           // underruns recovered from
+    size_t dropped;                         // periods dropped because the buffer was full
+    atomic_int error;                       // error for the helper to recover from (0 if none)
+    atomic_int stop;                        // asks the helper thread to exit
+    pthread_t thread;                       // helper thread recovering the stream
+} AlsaOutput;
+
+/**
+ * \brief Open a playback device for interleaved 16-bit, 48 kHz audio
+ *
+ * \param out           stream to open
+ * \param device        ALSA device name (such as "default", "hw:1" or "null")
+ * \param channels      number of channels
+ * \param period        frames per period (the device may choose the nearest it supports)
+ * \param periods       periods in the buffer
+ *
+ * \returns 0 on success, -1 if the device could not be opened or configured (or the
+ *          receiver was built without ALSA)
+ */
+int alsaOpen(AlsaOutput* out, const char* device, int channels, size_t period, size_t periods);
+
+/**
+ * \brief Close the stream
+ */
+void alsaClose(AlsaOutput* out);
+
+/**
+ * \brief Queue one frame, writing a period to the device once one is gathered
+ *
+ * \param frame         out->channels samples
+ */
+void alsaWrite(AlsaOutput* out, const short* frame);
+
+/**
+ * \brief Frames between the next frame written and the speaker
+ *
+ * \returns the delay, or 0 if it is not known
+ */
+size_t alsaLatency(AlsaOutput* out);
+
+#endif
@@ -0,0 +1,228 @@
+// Date: 10/19/2026
+// Summary: Vectorized helpers for remixing, mixing and measuring interleaved audio
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "audio.h"
+
+// GCC lowers these shuffles of v8s vectors to zip/unzip instructions
+#define UNZIP_EVEN  ((v8s){0, 2, 4, 6, 8, 10, 12, 14})
+#define UNZIP_ODD   ((v8s){1, 3, 5, 7, 9, 11, 13, 15})
+#define DUP_LOW     ((v8s){0, 0, 1, 1, 2, 2, 3, 3})
+#define DUP_HIGH    ((v8s){4, 4, 5, 5, 6, 6, 7, 7})
+
+int remixChannels(short* buffer, size_t frames, int from, int to)
+{
+    size_t i;
+    v8s a, b, low, high;
+
+    if (from == to)
+    {
+        return 0;
+    }
+
+    // Mono to stereo: walk backwards so each frame is read before it is overwritten
+    if (from == 1 && to == 2)
+    {
+        for (i = frames; i % 8; )
+        {
+            --i;
+            buffer[2 * i + 1] = buffer[i];
+            buffer[2 * i] = buffer[i];
+        }
+        while (i >= 8)
+        {
+            i -= 8;
+            memcpy(&a, buffer + i, sizeof(v8s));
+            low = __builtin_shuffle(a, DUP_LOW);
+            high = __builtin_shuffle(a, DUP_HIGH);
+            memcpy(buffer + 2 * i, &low, sizeof(v8s));
+            memcpy(buffer + 2 * i + 8, &high, sizeof(v8s));
+        }
+        return 0;
+    }
+
+    // Stereo to mono: walk forwards, averaging each frame (halve first to avoid overflow)
+    if (from == 2 && to == 1)
+    {
+        for (i = 0; i + 8 <= frames; i += 8)
+        {
+            memcpy(&a, buffer + 2 * i, sizeof(v8s));
+            memcpy(&b, buffer + 2 * i + 8, sizeof(v8s));
+            low = __builtin_shuffle(a, b, UNZIP_EVEN) >> 1;
+            high = __builtin_shuffle(a, b, UNZIP_ODD) >> 1;
+            low += high;
+            memcpy(buffer + i, &low, sizeof(v8s));
+        }
+        for (; i < frames; ++i)
+        {
+            buffer[i] = (buffer[2 * i] >> 1) + (buffer[2 * i + 1] >> 1);
+        }
+        return 0;
+    }
+
+    return -1;
+}
+
+void mixSaturate(short* dst, const short* src, size_t samples)
+{
+    size_t i = 0;
+    int sum;
+    v8u a, b, s, overflow, limit;
+
+    // Add with wraparound, then replace lanes whose sign flipped away from both inputs with
+    // the limit matching the sign of the inputs
+    for (; i + 8 <= samples; i += 8)
+    {
+        memcpy(&a, dst + i, sizeof(v8u));
+        memcpy(&b, src + i, sizeof(v8u));
+        s = a + b;
+        overflow = (v8u)((v8s)((a ^ s) & (b ^ s)) >> 15);
+        limit = (v8u)((v8s)a >> 15) ^ 0x7FFF;
+        s = (s & ~overflow) | (limit & overflow);
+        memcpy(dst + i, &s, sizeof(v8u));
+    }
+
+    for (; i < samples; ++i)
+    {
+        sum = dst[i] + src[i];
+        dst[i] = sum > 32767 ? 32767 : sum < -32768 ? -32768 : sum;
+    }
+}
+
+float dotProduct(const float* a, const float* b, size_t samples)
+{
+    size_t i = 0;
+    v4f x0, x1, y0, y1;
+    v4f sum0 = {0, 0, 0, 0};
+    v4f sum1 = {0, 0, 0, 0};
+    float sum;
+
+    // Two accumulators hide the latency of the multiply-add
+    for (; i + 8 <= samples; i += 8)
+    {
+        memcpy(&x0, a + i, sizeof(v4f));
+        memcpy(&x1, a + i + 4, sizeof(v4f));
+        memcpy(&y0, b + i, sizeof(v4f));
+        memcpy(&y1, b + i + 4, sizeof(v4f));
+        sum0 += x0 * y0;
+        sum1 += x1 * y1;
+    }
+    sum0 += sum1;
+    sum = sum0[0] + sum0[1] + sum0[2] + sum0[3];
+
+    for (; i < samples; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void complexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm,
+    const float* bRe, const float* bIm, size_t bins)
+{
+    v4f ar, ai, br, bi, sr, si;
+
+    for (size_t k = 0; k < bins; k += 4)
+    {
+        memcpy(&ar, aRe + k, sizeof(v4f));
+        memcpy(&ai, aIm + k, sizeof(v4f));
+        memcpy(&br, bRe + k, sizeof(v4f));
+        memcpy(&bi, bIm + k, sizeof(v4f));
+        memcpy(&sr, accRe + k, sizeof(v4f));
+        memcpy(&si, accIm + k, sizeof(v4f));
+        sr += ar * br - ai * bi;
+        si += ar * bi + ai * br;
+        memcpy(accRe + k, &sr, sizeof(v4f));
+        memcpy(accIm + k, &si, sizeof(v4f));
+    }
+}
+
+void peakAbs(float* peak, const float* src, size_t samples)
+{
+    size_t i = 0;
+    v4f x, p;
+    v4u bigger;
+    const v4u magnitude = {0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF};
+
+    // Clearing the sign bit gives the magnitude, and the comparison mask picks the larger
+    for (; i + 4 <= samples; i += 4)
+    {
+        memcpy(&x, src + i, sizeof(v4f));
+        memcpy(&p, peak + i, sizeof(v4f));
+        x = (v4f)((v4u)x & magnitude);
+        bigger = (v4u)(x > p);
+        p = (v4f)(((v4u)x & bigger) | ((v4u)p & ~bigger));
+        memcpy(peak + i, &p, sizeof(v4f));
+    }
+    for (; i < samples; ++i)
+    {
+        peak[i] = fabsf(src[i]) > peak[i] ? fabsf(src[i]) : peak[i];
+    }
+}
+
+void multiplyGain(float* dst, const float* gain, size_t samples)
+{
+    size_t i = 0;
+    v4f x, g;
+
+    for (; i + 4 <= samples; i += 4)
+    {
+        memcpy(&x, dst + i, sizeof(v4f));
+        memcpy(&g, gain + i, sizeof(v4f));
+        x *= g;
+        memcpy(dst + i, &x, sizeof(v4f));
+    }
+    for (; i < samples; ++i)
+    {
+        dst[i] *= gain[i];
+    }
+}
+
+float blockEnergy(const short* src, size_t samples, unsigned int* peak)
+{
+    size_t i = 0;
+    v8s x, sign;
+    v8u magnitude, bigger;
+    v8u top = {0, 0, 0, 0, 0, 0, 0, 0};
+    v4f low, high;
+    v4f sum0 = {0, 0, 0, 0};
+    v4f sum1 = {0, 0, 0, 0};
+    const v4i bias = {0x4B400000, 0x4B400000, 0x4B400000, 0x4B400000};
+    const v4f offset = {12582912.0f, 12582912.0f, 12582912.0f, 12582912.0f};
+    unsigned int largest = 0;
+    float sum;
+
+    for (; i + 8 <= samples; i += 8)
+    {
+        memcpy(&x, src + i, sizeof(v8s));
+
+        // The magnitude of -32768 only fits unsigned
+        sign = x >> 15;
+        magnitude = (v8u)((x ^ sign) - sign);
+        bigger = (v8u)(magnitude > top);
+        top = (magnitude & bigger) | (top & ~bigger);
+
+        // Sign-extend each half of the 32-bit lanes and add it to the mantissa of 1.5 * 2^23,
+        // which turns it into a float exactly without a conversion instruction
+        low = (v4f)((((v4i)x << 16) >> 16) + bias) - offset;
+        high = (v4f)(((v4i)x >> 16) + bias) - offset;
+        sum0 += low * low;
+        sum1 += high * high;
+    }
+    sum0 += sum1;
+    sum = sum0[0] + sum0[1] + sum0[2] + sum0[3];
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        largest = top[lane] > largest ? top[lane] : largest;
+    }
+
+    for (; i < samples; ++i)
+    {
+        sum += (float)src[i] * src[i];
+        largest = (unsigned int)abs(src[i]) > largest ? (unsigned int)abs(src[i]) : largest;
+    }
+    *peak = largest;
+    return sum;
+}
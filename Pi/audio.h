@@ -0,0 +1,95 @@
+// Date: 10/19/2026
+// Summary: Vectorized helpers for remixing, mixing and measuring interleaved audio
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stddef.h>
+
+// Vectors of samples, each filling one NEON (or SSE) register: 8 lanes of 16-bit samples or 4
+// lanes of floats (or masks and indices the same width)
+typedef short v8s __attribute__((vector_size(16)));
+typedef unsigned short v8u __attribute__((vector_size(16)));
+typedef float v4f __attribute__((vector_size(16)));
+typedef unsigned int v4u __attribute__((vector_size(16)));
+typedef int v4i __attribute__((vector_size(16)));
+
+/**
+ * \brief Convert interleaved audio between mono and stereo in place
+ *
+ * Mono is duplicated into both channels and stereo is averaged into mono.  buffer must be
+ * large enough to hold frames * to samples.
+ *
+ * \param buffer        interleaved audio samples
+ * \param frames        number of frames in buffer
+ * \param from          current number of channels in buffer
+ * \param to            desired number of channels in buffer
+ *
+ * \returns 0 on success, -1 if the conversion is not supported
+ */
+int remixChannels(short* buffer, size_t frames, int from, int to);
+
+/**
+ * \brief Add one block of samples into another, saturating instead of wrapping
+ *
+ * \param dst           samples to add into
+ * \param src           samples to add
+ * \param samples       number of samples in each block
+ */
+void mixSaturate(short* dst, const short* src, size_t samples);
+
+/**
+ * \brief Dot product of two blocks of floats
+ *
+ * \param a             first block (no alignment required)
+ * \param b             second block (no alignment required)
+ * \param samples       number of samples in each block
+ *
+ * \returns sum of a[i] * b[i]
+ */
+float dotProduct(const float* a, const float* b, size_t samples);
+
+/**
+ * \brief Raise a block of peaks to the magnitudes of a block of samples
+ *
+ * \param peak          peaks to raise (peak[i] becomes the larger of itself and |src[i]|)
+ * \param src           samples
+ * \param samples       number of samples in each block
+ */
+void peakAbs(float* peak, const float* src, size_t samples);
+
+/**
+ * \brief Multiply a block of samples by a block of gains
+ *
+ * \param dst           samples to scale
+ * \param gain          gain for each sample
+ * \param samples       number of samples in each block
+ */
+void multiplyGain(float* dst, const float* gain, size_t samples);
+
+/**
+ * \brief Multiply two split-complex spectra and add the product to a third
+ *
+ * \param accRe         real parts to add into
+ * \param accIm         imaginary parts to add into
+ * \param aRe           real parts of the first spectrum
+ * \param aIm           imaginary parts of the first spectrum
+ * \param bRe           real parts of the second spectrum
+ * \param bIm           imaginary parts of the second spectrum
+ * \param bins          number of bins (a multiple of 4)
+ */
+void complexMultiplyAccumulate(float* accRe, float* accIm, const float* aRe, const float* aIm,
+    const float* bRe, const float* bIm, size_t bins);
+
+/**
+ * \brief Measure the energy and peak of a block of samples
+ *
+ * \param src           samples (interleaved channels are measured together)
+ * \param samples       number of samples
+ * \param peak          receives the largest magnitude of any sample
+ *
+ * \returns sum of the squares of the samples
+ */
+float blockEnergy(const short* src, size_t samples, unsigned int* peak);
+
+#endif
@@ -0,0 +1,535 @@
+// Date: 10/19/2026
+// Summary: Micro-benchmarks of the receiver's per-frame kernels, printed as JSON lines
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/utsname.h>
+#include "EasyPIO.h"
+#include "store.h"
+#include "metronome.h"
+#include "output.h"
+#include "audio.h"
+#include "wav.h"
+#include "logger.h"
+#include "split.h"
+#include "share.h"
+#include "tables.h"
+
+////////////////////////////////
+//  Constants and Types
+////////////////////////////////
+
+#ifndef BENCH_CFLAGS
+#define BENCH_CFLAGS "unknown"      // compiler flags (passed in by the Makefile)
+#endif
+
+#define BENCH_REPEATS 5             // default number of timed runs of each kernel
+#define BENCH_BUFFER 4096           // samples in the buffers the kernels work on
+#define BENCH_ARENA (64 << 20)      // bytes of recording arena for the append benchmark
+#define BENCH_PRE_ROLL 44           // chunks of history kept by the pre-roll (30 s of mono)
+#define BENCH_LOOP (2 * SAMPLE_RATE)    // frames of the mono loop played by loop_mix (2 s)
+#define BENCH_TAKE (349 * SAMPLE_RATE)   // frames of mono take split (5:49)
+#define BENCH_LIVE "/looper-bench"   // shared memory segment published to
+#define BENCH_NCS 17                // SPI pins polled in the GPIO benchmark
+#define BENCH_SCLK 5
+#define BENCH_MOSI 22
+
+/**
+ * \brief A kernel to time
+ */
+typedef struct
+{
+    const char* name;           // name in the results
+    const char* unit;           // what one operation is
+    size_t ops;                 // operations per timed run
+    void (*run)(size_t ops);    // performs ops operations
+    void (*prepare)(void);      // called before each run, untimed (NULL if not needed)
+} Kernel;
+
+////////////////////////////////
+//  Kernels
+////////////////////////////////
+
+static volatile int sink;                       // keeps results from being optimized away
+static unsigned short words[BENCH_BUFFER];      // 11-bit sign-magnitude words from the FPGA
+static short samples[BENCH_BUFFER];             // decoded samples
+static short loop[BENCH_BUFFER];                // samples of a recording being played
+static Recording recording;                     // recording being appended to
+static Recording history;                       // sliding window of input for the pre-roll
+static Recording loopTake;                      // loop mixed with the input
+static Metronome metronome;                     // metronome clicking every beat
+static Output output;                           // PWM output engine
+static unsigned int pwmWords[2 * OUTPUT_MAX_RATE];  // PWM words of one frame
+static FILE* wavFile;                           // file receiving WAV headers and payloads
+static FILE* logFile;                           // file receiving logged records
+static short* take;                             // long take to split at silences
+static Share share;                             // segment the recordings are published in
+
+/**
+ * \brief Decode 11-bit sign-magnitude words with VOLUME applied (one op per sample)
+ */
+static void benchDecode(size_t ops)
+{
+    for (size_t i = 0; i < ops; ++i)
+    {
+        samples[i & (BENCH_BUFFER - 1)] = decodeTable[words[i & (BENCH_BUFFER - 1)] & 0x7FF];
+    }
+    sink = samples[ops & (BENCH_BUFFER - 1)];
+}
+
+/**
+ * \brief Append mono frames to a recording, starting over when the arena fills
+ */
+static void benchAppend(size_t ops)
+{
+    short* frame;
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        frame = recordingAppend(&recording);
+        if (frame == NULL)
+        {
+            recordingClear(&recording);
+            frame = recordingAppend(&recording);
+        }
+        frame[0] = samples[i & (BENCH_BUFFER - 1)];
+    }
+}
+
+/**
+ * \brief Append mono frames to the pre-roll history, which drops a chunk whenever it starts one
+ */
+static void benchPreRoll(size_t ops)
+{
+    short* frame;
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        frame = recordingAppendRecent(&history, BENCH_PRE_ROLL);
+        if (frame != NULL)
+        {
+            frame[0] = samples[i & (BENCH_BUFFER - 1)];
+        }
+    }
+}
+
+/**
+ * \brief Mix the input with a loop as the audio loop does, one frame at a time: each frame of
+ *        the loop is found through its chunk table and the mix is stored for the output
+ */
+static void benchLoopMix(size_t ops)
+{
+    static float mix[BENCH_BUFFER];
+    size_t playIndex = 0;
+    const short* frame;
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        frame = recordingFrame(&loopTake, playIndex);
+        if ((playIndex & loopTake.frameMask) == 0)
+        {
+            recordingPrefetch(&loopTake, playIndex);
+        }
+        mix[i & (BENCH_BUFFER - 1)] = ((float)samples[i & (BENCH_BUFFER - 1)] + frame[0])
+            / (1 << 15);
+        if (++playIndex >= loopTake.frames)
+        {
+            playIndex = 0;
+        }
+    }
+    sink = mix[ops & (BENCH_BUFFER - 1)];
+}
+
+/**
+ * \brief Mix blocks of samples with saturation (one op per sample)
+ */
+static void benchSaturate(size_t ops)
+{
+    static short mix[BENCH_BUFFER];
+
+    for (size_t i = 0; i < ops; i += BENCH_BUFFER)
+    {
+        memcpy(mix, samples, sizeof(mix));
+        mixSaturate(mix, loop, BENCH_BUFFER);
+    }
+    sink = mix[0];
+}
+
+/**
+ * \brief Ramp a click down over each beat as the audio loop did before the wavetables (one op
+ *        per frame)
+ */
+static void benchClickRamp(size_t ops)
+{
+    size_t beatTime = metronome.beatTime;
+    size_t counter = 0;
+    float sum = 0;
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        if (++counter >= beatTime)
+        {
+            counter = 0;
+        }
+        sum += ((float)(beatTime - counter)) / beatTime * 0.5f;
+    }
+    sink = sum;
+}
+
+/**
+ * \brief Step the metronome one frame at a time as the audio loop does
+ */
+static void benchClick(size_t ops)
+{
+    int sum = 0;
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        sum += metronomeNext(&metronome);
+    }
+    sink = sum;
+}
+
+/**
+ * \brief Mix clicks into whole blocks of samples (one op per frame)
+ */
+static void benchClickBlock(size_t ops)
+{
+    static short mix[BENCH_BUFFER];
+
+    for (size_t i = 0; i < ops; i += BENCH_BUFFER)
+    {
+        memcpy(mix, samples, sizeof(mix));
+        metronomeMix(&metronome, mix, BENCH_BUFFER);
+    }
+    sink = mix[0];
+}
+
+/**
+ * \brief Bias the mix and click into a duty cycle and turn it into PWM words (one op per
+ *        frame)
+ */
+static void benchDuty(size_t ops)
+{
+    float duty[2];
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        duty[0] = (((float)samples[i & (BENCH_BUFFER - 1)] / (1 << 15)
+            + (float)loop[i & (BENCH_BUFFER - 1)] / (1 << 15)) / 2) + 0.5;
+        duty[1] = duty[0];
+        outputFrame(&output, duty, pwmWords);
+    }
+    sink = pwmWords[0];
+}
+
+/**
+ * \brief Write a WAV header (one op per header)
+ */
+static void benchWavHeader(size_t ops)
+{
+    for (size_t i = 0; i < ops; ++i)
+    {
+        rewind(wavFile);
+        wavWriteHeader(wavFile, 2, i);
+    }
+    fflush(wavFile);
+}
+
+/**
+ * \brief Write the payload of a stereo WAV in blocks (one op per frame)
+ */
+static void benchWavPayload(size_t ops)
+{
+    rewind(wavFile);
+    for (size_t i = 0; i < ops; i += BENCH_BUFFER / 2)
+    {
+        fwrite(samples, sizeof(short), BENCH_BUFFER, wavFile);
+    }
+    fflush(wavFile);
+}
+
+/**
+ * \brief Read NCS, SCLK and MOSI from the register file, as for each bit (one op per poll)
+ */
+static void benchGpioRead(size_t ops)
+{
+    int sum = 0;
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        sum += digitalRead(BENCH_NCS) + digitalRead(BENCH_SCLK) + digitalRead(BENCH_MOSI);
+    }
+    sink = sum;
+}
+
+/**
+ * \brief Read every pin from the register file at once (one op per poll)
+ */
+static void benchGpioReadAll(size_t ops)
+{
+    unsigned int sum = 0;
+
+    for (size_t i = 0; i < ops; ++i)
+    {
+        sum += digitalReadAll();
+    }
+    sink = sum;
+}
+
+/**
+ * \brief Log the verbose per-frame report (one op per record)
+ */
+static void benchLog(size_t ops)
+{
+    for (size_t i = 0; i < ops; ++i)
+    {
+        logPrint("per frame: %.2f us processing, %.2f us capture (%.2f us per channel), "
+            "%.2f us idle\n", 1.5f, 3.25f, 1.625f, (float)i);
+    }
+}
+
+/**
+ * \brief Find the songs in a 5:49 mono take (one op per frame)
+ */
+static void benchSplit(size_t ops)
+{
+    SplitPiece pieces[SPLIT_MAX];
+    size_t frames = ops < BENCH_TAKE ? ops : BENCH_TAKE;
+
+    for (size_t i = 0; i < ops; i += frames)
+    {
+        sink = splitFind(take, frames, 1, SPLIT_LEVEL, pieces, SPLIT_MAX);
+    }
+}
+
+/**
+ * \brief Publish the recordings and state to other processes as the audio loop does each frame
+ */
+static void benchShare(size_t ops)
+{
+    for (size_t i = 0; i < ops; ++i)
+    {
+        share.state.playIndex = i;
+        shareFrame(&share);
+    }
+}
+
+static const Kernel kernels[] = {
+    {"decode", "sample", 1 << 22, benchDecode, NULL},
+    {"record_append", "frame", 1 << 22, benchAppend, NULL},
+    {"pre_roll_append", "frame", 1 << 22, benchPreRoll, NULL},
+    {"loop_mix", "frame", 1 << 22, benchLoopMix, NULL},
+    {"mix_saturate", "sample", 1 << 22, benchSaturate, NULL},
+    {"click_ramp", "frame", 1 << 22, benchClickRamp, NULL},
+    {"click", "frame", 1 << 22, benchClick, NULL},
+    {"click_block", "frame", 1 << 22, benchClickBlock, NULL},
+    {"duty", "frame", 1 << 20, benchDuty, NULL},
+    {"wav_header", "header", 1 << 16, benchWavHeader, NULL},
+    {"wav_payload", "frame", 1 << 22, benchWavPayload, NULL},
+    {"gpio_read", "poll", 1 << 22, benchGpioRead, NULL},
+    {"gpio_read_all", "poll", 1 << 22, benchGpioReadAll, NULL},
+    {"split_find", "frame", BENCH_TAKE, benchSplit, NULL},
+    {"log", "record", LOG_RECORDS / 2, benchLog, logFlush},     // runs fit in the ring
+    {"live_publish", "frame", 1 << 22, benchShare, NULL},
+};
+
+////////////////////////////////
+//  Functions
+////////////////////////////////
+
+/**
+ * \brief Current time in ns
+ */
+static long long nowNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * \brief Fill the buffers and set up the state the kernels use
+ *
+ * \returns 0 on success, -1 if something could not be allocated
+ */
+static int setup(void)
+{
+    short* frame;
+
+    srand(1);
+    for (int i = 0; i < BENCH_BUFFER; ++i)
+    {
+        words[i] = rand() & 0x7FF;
+        samples[i] = decodeTable[words[i]];
+        loop[i] = rand() % 65536 - 32768;
+    }
+
+    // The take alternates between 10 s of input and 5 s of silence
+    take = malloc(BENCH_TAKE * sizeof(short));
+    for (size_t i = 0; take != NULL && i < BENCH_TAKE; ++i)
+    {
+        take[i] = (i / SAMPLE_RATE) % 15 < 10 ? samples[i & (BENCH_BUFFER - 1)] : 0;
+    }
+    metronomeInit(&metronome, SAMPLE_RATE / 2, 4, 2);
+    metronomeStart(&metronome);
+    outputInit(&output, OUTPUT_RATE, CM_FREQUENCY);
+
+    // The simulated register file stands in for the GPIO block
+    gpio = calloc(0x100, sizeof(unsigned int));
+    wavFile = tmpfile();
+    logFile = fopen("/dev/null", "w");
+    if (gpio == NULL || take == NULL || wavFile == NULL || logFile == NULL || storeInit(BENCH_ARENA, 0)
+        || recordingInit(&recording, 1) || recordingInit(&history, 1)
+        || recordingInit(&loopTake, 1) || logInit(logFile)
+        || shareCreate(&share, BENCH_LIVE, BENCH_ARENA))
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < BENCH_LOOP; ++i)
+    {
+        frame = recordingAppend(&loopTake);
+        if (frame == NULL)
+        {
+            return -1;
+        }
+        frame[0] = loop[i & (BENCH_BUFFER - 1)];
+    }
+
+    // Nothing reads the segment, so it only needs to stay mapped
+    shm_unlink(BENCH_LIVE);
+    shareWatch(&share, &recording, &history);
+    GPLEV0 = (1u << BENCH_NCS) | (1u << BENCH_MOSI);
+    return 0;
+}
+
+/**
+ * \brief Name of the board (the Pi model where the device tree has one)
+ */
+static void boardModel(char* model, size_t size)
+{
+    FILE* file = fopen("/proc/device-tree/model", "r");
+    struct utsname name;
+    size_t length = 0;
+
+    if (file != NULL)
+    {
+        length = fread(model, 1, size - 1, file);
+        fclose(file);
+    }
+    model[length] = '\0';
+    if (length == 0 && uname(&name) == 0)
+    {
+        snprintf(model, size, "%s", name.machine);
+    }
+}
+
+/**
+ * \brief Compare two doubles for qsort
+ */
+static int compareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief Print command line usage
+ */
+static void usage(const char* program)
+{
+    printf("usage: %s [options] [KERNEL...]\n", program);
+    printf("  -r, --repeats N   timed runs of each kernel (default %d)\n", BENCH_REPEATS);
+    printf("  -s, --scale F     multiply the operations in each run by F (default 1)\n");
+    printf("  -l, --list        list the kernels and exit\n");
+    printf("prints one JSON object per kernel with the fastest and median time per operation\n");
+}
+
+int main(int argc, char** argv)
+{
+    static struct option options[] = {
+        {"repeats", required_argument, NULL, 'r'},
+        {"scale", required_argument, NULL, 's'},
+        {"list", no_argument, NULL, 'l'},
+        {NULL, 0, NULL, 0}
+    };
+    int numKernels = sizeof(kernels) / sizeof(kernels[0]);
+    int repeats = BENCH_REPEATS, option, selected;
+    double scale = 1;
+    double times[64];
+    char model[128];
+    long long start;
+    size_t ops;
+
+    while ((option = getopt_long(argc, argv, "r:s:l", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+            case 'r': repeats = atoi(optarg); break;
+            case 's': scale = atof(optarg); break;
+            case 'l':
+                for (int k = 0; k < numKernels; ++k)
+                {
+                    printf("%s\n", kernels[k].name);
+                }
+                return 0;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (repeats < 1 || repeats > 64 || scale <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (setup())
+    {
+        printf("can't set up the benchmarks\n");
+        return 1;
+    }
+    boardModel(model, sizeof(model));
+
+    for (int k = 0; k < numKernels; ++k)
+    {
+        // Run only the kernels named on the command line, if any are
+        selected = optind == argc;
+        for (int i = optind; i < argc; ++i)
+        {
+            selected |= !strcmp(argv[i], kernels[k].name);
+        }
+        if (!selected)
+        {
+            continue;
+        }
+
+        // One untimed run warms the caches and commits the memory the kernel touches
+        ops = kernels[k].ops * scale;
+        ops = ops > 0 ? ops : 1;
+        if (kernels[k].prepare != NULL)
+        {
+            kernels[k].prepare();
+        }
+        kernels[k].run(ops);
+        for (int r = 0; r < repeats; ++r)
+        {
+            if (kernels[k].prepare != NULL)
+            {
+                kernels[k].prepare();
+            }
+            start = nowNanos();
+            kernels[k].run(ops);
+            times[r] = (double)(nowNanos() - start) / ops;
+        }
+        qsort(times, repeats, sizeof(double), compareDoubles);
+
+        printf("{\"kernel\": \"%s\", \"unit\": \"%s\", \"ops\": %zu, \"repeats\": %d, "
+            "\"ns_min\": %.3f, \"ns_median\": %.3f, \"compiler\": \"%s\", \"cflags\": \"%s\", "
+            "\"model\": \"%s\"}\n", kernels[k].name, kernels[k].unit, ops, repeats, times[0],
+            times[repeats / 2], __VERSION__, BENCH_CFLAGS, model);
+    }
+    return 0;
+}
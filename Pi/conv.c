@@ -0,0 +1,166 @@
+// Date: 10/19/2026
+// Summary: Uniformly partitioned FFT convolution with an impulse response (such as a cabinet)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "conv.h"
+#include "audio.h"
+
+#define SPECTRUM (2 * CONV_BINS)    // floats in a stored spectrum
+
+/**
+ * \brief Transform the workspace and keep the bins up to the Nyquist frequency
+ *
+ * \param spectrum      receives CONV_BINS real parts followed by CONV_BINS imaginary parts
+ */
+static void storeSpectrum(Convolver* conv, float* spectrum)
+{
+    fftForward(&conv->fft, conv->re, conv->im);
+    memset(spectrum, 0, SPECTRUM * sizeof(float));
+    memcpy(spectrum, conv->re, (CONV_BLOCK + 1) * sizeof(float));
+    memcpy(spectrum + CONV_BINS, conv->im, (CONV_BLOCK + 1) * sizeof(float));
+}
+
+int convInit(Convolver* conv, const char* path, int channels)
+{
+    WavInfo info;
+    short* samples;
+    size_t frames;
+    FILE* file;
+
+    conv->filter = NULL;
+    conv->history = NULL;
+    if (fftInit(&conv->fft, CONV_SIZE))
+    {
+        return -1;
+    }
+
+    file = fopen(path, "rb");
+    if (file == NULL || wavReadHeader(file, &info) || info.sampleRate != SAMPLE_RATE
+        || info.channels > MAX_CHANNELS)
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        convFree(conv);
+        return -1;
+    }
+
+    frames = info.frames < CONV_MAX_LENGTH ? info.frames : CONV_MAX_LENGTH;
+    conv->channels = channels;
+    conv->responses = info.channels < channels ? info.channels : channels;
+    conv->partitions = (frames + CONV_BLOCK - 1) / CONV_BLOCK;
+    conv->newest = 0;
+    memset(conv->input, 0, sizeof(conv->input));
+
+    samples = malloc(frames * info.channels * sizeof(short));
+    conv->filter = calloc(conv->responses * conv->partitions * SPECTRUM, sizeof(float));
+    conv->history = calloc(channels * conv->partitions * SPECTRUM, sizeof(float));
+    if (samples == NULL || conv->filter == NULL || conv->history == NULL || frames == 0
+        || fread(samples, info.channels * sizeof(short), frames, file) != frames)
+    {
+        free(samples);
+        fclose(file);
+        convFree(conv);
+        return -1;
+    }
+    fclose(file);
+
+    // Each partition is zero-padded to a whole transform, so the second half of every
+    // circular convolution is the linear one
+    for (int r = 0; r < conv->responses; ++r)
+    {
+        for (size_t p = 0; p < conv->partitions; ++p)
+        {
+            memset(conv->re, 0, sizeof(conv->re));
+            memset(conv->im, 0, sizeof(conv->im));
+            for (size_t i = 0; i < CONV_BLOCK && p * CONV_BLOCK + i < frames; ++i)
+            {
+                conv->re[i] = samples[(p * CONV_BLOCK + i) * info.channels + r]
+                    * (1.0f / (1 << 15));
+            }
+            storeSpectrum(conv, conv->filter + (r * conv->partitions + p) * SPECTRUM);
+        }
+    }
+
+    free(samples);
+    return 0;
+}
+
+void convReset(Convolver* conv)
+{
+    memset(conv->history, 0, conv->channels * conv->partitions * SPECTRUM * sizeof(float));
+    memset(conv->input, 0, sizeof(conv->input));
+    conv->newest = 0;
+}
+
+void convFree(Convolver* conv)
+{
+    fftFree(&conv->fft);
+    free(conv->filter);
+    free(conv->history);
+    conv->filter = NULL;
+    conv->history = NULL;
+}
+
+/**
+ * \brief Convolve one block of every channel in place
+ */
+static void convProcess(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Convolver* conv = state;
+    size_t partitions = conv->partitions;
+    float* history;
+    float* filter;
+    float* x;
+    float* h;
+
+    conv->newest = conv->newest + 1 < partitions ? conv->newest + 1 : 0;
+
+    for (int c = 0; c < numChannels && c < conv->channels; ++c)
+    {
+        history = conv->history + c * partitions * SPECTRUM;
+        filter = conv->filter + (c < conv->responses ? c : 0) * partitions * SPECTRUM;
+
+        // Slide the new block into the transform window and add its spectrum to the history
+        memmove(conv->input[c], conv->input[c] + CONV_BLOCK, CONV_BLOCK * sizeof(float));
+        memcpy(conv->input[c] + CONV_BLOCK, channels[c], frames * sizeof(float));
+        memcpy(conv->re, conv->input[c], sizeof(conv->re));
+        memset(conv->im, 0, sizeof(conv->im));
+        storeSpectrum(conv, history + conv->newest * SPECTRUM);
+
+        // Partition p of the response meets the input from p blocks ago
+        memset(conv->sumRe, 0, sizeof(conv->sumRe));
+        memset(conv->sumIm, 0, sizeof(conv->sumIm));
+        for (size_t p = 0; p < partitions; ++p)
+        {
+            x = history + (conv->newest >= p ? conv->newest - p : conv->newest + partitions - p)
+                * SPECTRUM;
+            h = filter + p * SPECTRUM;
+            complexMultiplyAccumulate(conv->sumRe, conv->sumIm, x, x + CONV_BINS,
+                h, h + CONV_BINS, CONV_BINS);
+        }
+
+        // Rebuild the negative frequencies from the positive ones (the output is real)
+        for (int k = 0; k <= CONV_BLOCK; ++k)
+        {
+            conv->re[k] = conv->sumRe[k];
+            conv->im[k] = conv->sumIm[k];
+        }
+        for (int k = CONV_BLOCK + 1; k < CONV_SIZE; ++k)
+        {
+            conv->re[k] = conv->sumRe[CONV_SIZE - k];
+            conv->im[k] = -conv->sumIm[CONV_SIZE - k];
+        }
+        fftInverse(&conv->fft, conv->re, conv->im);
+        memcpy(channels[c], conv->re + CONV_BLOCK, frames * sizeof(float));
+    }
+}
+
+DspProcessor convProcessor(Convolver* conv)
+{
+    DspProcessor processor = {"convolution", conv, convProcess, 0};
+    return processor;
+}
@@ -0,0 +1,67 @@
+// Date: 10/19/2026
+// Summary: Uniformly partitioned FFT convolution with an impulse response (such as a cabinet)
+
+#ifndef CONV_H
+#define CONV_H
+
+#include <stddef.h>
+#include "dsp.h"
+#include "fft.h"
+
+#define CONV_BLOCK DSP_BLOCK                    // frames in each partition of the response
+#define CONV_SIZE (2 * CONV_BLOCK)              // points in each FFT
+#define CONV_BINS ((CONV_BLOCK + 1 + 3) & ~3)   // bins kept per spectrum (padded for SIMD)
+#define CONV_MAX_LENGTH SAMPLE_RATE             // longest response used (longer is truncated)
+
+/**
+ * \brief State of a convolution (uniformly partitioned overlap-save)
+ *
+ * The response is cut into partitions of CONV_BLOCK frames, each stored as a spectrum.  Every
+ * block of input is transformed once and kept in a frequency-domain delay line, so each
+ * output block costs one forward and one inverse transform plus one complex multiply-add of
+ * the spectra per partition.  Partitions as short as a block keep the added latency to
+ * nothing beyond the chain's own queue.
+ */
+typedef struct
+{
+    Fft fft;                    // transforms of CONV_SIZE points
+    int channels;               // channels convolved
+    int responses;              // channels in the response (1 applies it to every channel)
+    size_t partitions;          // partitions in the response
+    float* filter;              // [responses][partitions] spectra of the response (re then im)
+    float* history;             // [channels][partitions] spectra of recent input blocks
+    size_t newest;              // partition of history holding the newest block
+    float input[MAX_CHANNELS][CONV_SIZE];   // last two blocks of input
+    float re[CONV_SIZE];        // transform workspace (real parts)
+    float im[CONV_SIZE];        // transform workspace (imaginary parts)
+    float sumRe[CONV_BINS];     // spectrum of the output block (real parts)
+    float sumIm[CONV_BINS];     // spectrum of the output block (imaginary parts)
+} Convolver;
+
+/**
+ * \brief Load an impulse response from a 48 kHz .wav file
+ *
+ * \param conv          convolver to initialize
+ * \param path          path of the .wav file (1 or 2 channels)
+ * \param channels      number of channels which will be processed
+ *
+ * \returns 0 on success, -1 if the file could not be used
+ */
+int convInit(Convolver* conv, const char* path, int channels);
+
+/**
+ * \brief Forget all input so the next block starts from silence
+ */
+void convReset(Convolver* conv);
+
+/**
+ * \brief Free the spectra
+ */
+void convFree(Convolver* conv);
+
+/**
+ * \brief Processor which applies the convolution to CONV_BLOCK frames at a time
+ */
+DspProcessor convProcessor(Convolver* conv);
+
+#endif
@@ -0,0 +1,179 @@
+// Date: 10/19/2026
+// Summary: Multi-tap feedback delay with modulated fractional taps for echo and chorus
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "delay.h"
+#include "audio.h"
+
+#define RING_MASK (DELAY_RING - 1)
+
+/**
+ * \brief Coefficient of a one-pole filter with a cutoff of frequency Hz
+ */
+static float onePole(float frequency)
+{
+    return 1 - expf(-2 * (float)M_PI * frequency / SAMPLE_RATE);
+}
+
+int delayInit(Delay* dl, int channels, float feedback)
+{
+    if (feedback < 0 || feedback > DELAY_MAX_FEEDBACK)
+    {
+        return -1;
+    }
+
+    dl->channels = channels;
+    dl->numTaps = 0;
+    dl->feedback = feedback;
+    dl->damping = onePole(DELAY_DAMPING);
+    dl->highpass = onePole(DELAY_HIGHPASS);
+    dl->ring = malloc(channels * DELAY_RING * sizeof(float));
+    if (dl->ring == NULL)
+    {
+        return -1;
+    }
+    delayReset(dl);
+    return 0;
+}
+
+int delayAddTap(Delay* dl, float time, float depth, float rate, float gain)
+{
+    DelayTap* tap = &dl->taps[dl->numTaps];
+
+    if (dl->numTaps == DELAY_MAX_TAPS || depth < 0 || rate < 0 || time + depth > DELAY_MAX_TIME
+        || (time - depth) * SAMPLE_RATE / 1000 < DELAY_MIN)
+    {
+        return -1;
+    }
+
+    tap->delay = time * SAMPLE_RATE / 1000;
+    tap->depth = depth * SAMPLE_RATE / 1000;
+    tap->rate = rate / SAMPLE_RATE;
+    tap->gain = powf(10, gain / 20);
+    tap->phase = 0;
+    dl->numTaps++;
+    return 0;
+}
+
+void delayReset(Delay* dl)
+{
+    memset(dl->ring, 0, dl->channels * DELAY_RING * sizeof(float));
+    memset(dl->low, 0, sizeof(dl->low));
+    memset(dl->high, 0, sizeof(dl->high));
+    dl->written = 0;
+    for (int t = 0; t < dl->numTaps; ++t)
+    {
+        dl->taps[t].phase = 0;
+    }
+}
+
+void delayFree(Delay* dl)
+{
+    free(dl->ring);
+    dl->ring = NULL;
+}
+
+/**
+ * \brief Read one tap for a block of frames into dl->tap
+ *
+ * The delay ramps from its value at phase to its value at the end of the block.  The index
+ * and fraction of each frame's position are found one lane at a time, and the Hermite
+ * polynomial is evaluated for 4 frames at once.
+ */
+static void readTap(Delay* dl, const float* ring, const DelayTap* tap, double phase,
+    size_t frames)
+{
+    float start = tap->delay + tap->depth * sinf(2 * (float)M_PI * (float)phase);
+    float end = tap->delay
+        + tap->depth * sinf(2 * (float)M_PI * (float)(phase + tap->rate * frames));
+    float step = (end - start) / frames;
+    float position;
+    int whole;
+    unsigned int at;
+    v4f xm1, x0, x1, x2, f, c1, c2, c3, y;
+
+    // Frames past the end of a short block are read too (they are in the ring already)
+    for (size_t i = 0; i < frames; i += 4)
+    {
+        for (int l = 0; l < 4; ++l)
+        {
+            position = (float)(i + l) - (start + step * (i + l));
+            whole = (int)position;
+            whole -= position < whole;
+            f[l] = position - whole;
+            at = dl->written + whole;
+            xm1[l] = ring[(at - 1) & RING_MASK];
+            x0[l] = ring[at & RING_MASK];
+            x1[l] = ring[(at + 1) & RING_MASK];
+            x2[l] = ring[(at + 2) & RING_MASK];
+        }
+
+        c1 = 0.5f * (x1 - xm1);
+        c2 = xm1 - 2.5f * x0 + 2 * x1 - 0.5f * x2;
+        c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        y = ((c3 * f + c2) * f + c1) * f + x0;
+        memcpy(dl->tap + i, &y, sizeof(v4f));
+    }
+}
+
+/**
+ * \brief Add the taps to one block of every channel and feed the first back into the ring
+ */
+static void delayProcess(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Delay* dl = state;
+    int count = numChannels < dl->channels ? numChannels : dl->channels;
+    float* ring;
+    float* x;
+    float feedback;
+    v4f sum, tap, gain;
+
+    for (int c = 0; c < count; ++c)
+    {
+        ring = dl->ring + (size_t)c * DELAY_RING;
+        x = channels[c];
+
+        memset(dl->wet, 0, sizeof(dl->wet));
+        for (int t = 0; t < dl->numTaps; ++t)
+        {
+            readTap(dl, ring, &dl->taps[t], dl->taps[t].phase - 0.25 * c, frames);
+            if (t == 0)
+            {
+                memcpy(dl->first, dl->tap, sizeof(dl->first));
+            }
+            gain = (v4f){0, 0, 0, 0} + dl->taps[t].gain;
+            for (size_t i = 0; i < frames; i += 4)
+            {
+                memcpy(&sum, dl->wet + i, sizeof(v4f));
+                memcpy(&tap, dl->tap + i, sizeof(v4f));
+                sum += gain * tap;
+                memcpy(dl->wet + i, &sum, sizeof(v4f));
+            }
+        }
+
+        // Write the input and the filtered feedback, then mix in the taps
+        for (size_t i = 0; i < frames; ++i)
+        {
+            feedback = dl->numTaps > 0 ? dl->feedback * dl->first[i] : 0;
+            dl->low[c] += dl->damping * (feedback - dl->low[c]);
+            dl->high[c] += dl->highpass * (dl->low[c] - dl->high[c]);
+            ring[(dl->written + i) & RING_MASK] = x[i] + dl->low[c] - dl->high[c];
+            x[i] += dl->wet[i];
+        }
+    }
+
+    for (int t = 0; t < dl->numTaps; ++t)
+    {
+        dl->taps[t].phase += dl->taps[t].rate * frames;
+        dl->taps[t].phase -= floor(dl->taps[t].phase);
+    }
+    dl->written += frames;
+}
+
+DspProcessor delayProcessor(Delay* dl)
+{
+    DspProcessor processor = {"delay", dl, delayProcess, 0};
+    return processor;
+}
@@ -0,0 +1,98 @@
+// Date: 10/19/2026
+// Summary: Multi-tap feedback delay with modulated fractional taps for echo and chorus
+
+#ifndef DELAY_H
+#define DELAY_H
+
+#include "dsp.h"
+
+#define DELAY_RING (1 << 18)                // frames in each channel's ring (5.46 s)
+#define DELAY_MAX_TAPS 8                    // most taps read from the ring
+#define DELAY_MIN (DSP_BLOCK + 2)           // shortest delay in frames (a block has been written)
+#define DELAY_MAX_TIME 5000                 // longest delay in ms
+#define DELAY_FEEDBACK 0.3f                 // default fraction of the first tap fed back
+#define DELAY_MAX_FEEDBACK 0.95f            // most feedback allowed
+#define DELAY_WET -6                        // default level in dB of each tap
+#define DELAY_DAMPING 4000                  // cutoff in Hz of the low-pass in the feedback path
+#define DELAY_HIGHPASS 100                  // cutoff in Hz of the high-pass in the feedback path
+
+/**
+ * \brief One read from the ring
+ */
+typedef struct
+{
+    float delay;                // center of the delay in frames
+    float depth;                // frames the LFO moves the delay either way
+    float rate;                 // LFO cycles per frame
+    float gain;                 // linear level of the tap
+    double phase;               // LFO phase in cycles at the start of the next block
+} DelayTap;
+
+/**
+ * \brief State of the delay
+ *
+ * Every tap's delay follows a sine LFO, evaluated at the ends of each block and ramped
+ * between them so it never steps, and is read between samples with 4-point cubic (Hermite)
+ * interpolation.  Taps are read a block at a time with the polynomial evaluated 4 frames at
+ * once; they only read frames written before the block, so the shortest delay is DELAY_MIN.
+ * The first tap is fed back into the ring through a low-pass (so repeats darken like tape)
+ * and a high-pass (so low end doesn't build up).  The second channel's LFOs run a quarter
+ * cycle behind the first's, which widens a stereo chorus.
+ */
+typedef struct
+{
+    int channels;                           // channels processed
+    int numTaps;                            // taps in use
+    DelayTap taps[DELAY_MAX_TAPS];          // reads in the order they were added
+    float feedback;                         // fraction of the first tap fed back
+    float damping;                          // coefficient of the feedback low-pass
+    float highpass;                         // coefficient of the feedback high-pass
+    float low[MAX_CHANNELS];                // state of each channel's low-pass
+    float high[MAX_CHANNELS];               // state of each channel's high-pass
+    float* ring;                            // [channels][DELAY_RING] recent input and feedback
+    unsigned int written;                   // frames written to the ring
+    float tap[DSP_BLOCK];                   // block read by one tap
+    float first[DSP_BLOCK];                 // block read by the first tap
+    float wet[DSP_BLOCK];                   // sum of every tap's block
+} Delay;
+
+/**
+ * \brief Allocate the ring
+ *
+ * \param dl            delay to initialize (with no taps)
+ * \param channels      number of channels which will be processed
+ * \param feedback      fraction of the first tap fed back (up to DELAY_MAX_FEEDBACK)
+ *
+ * \returns 0 on success, -1 if the feedback is out of range or the ring can't be allocated
+ */
+int delayInit(Delay* dl, int channels, float feedback);
+
+/**
+ * \brief Add a tap
+ *
+ * \param dl            delay to add the tap to
+ * \param time          delay in ms
+ * \param depth         ms the LFO moves the delay either way (0 for none)
+ * \param rate          LFO frequency in Hz
+ * \param gain          level of the tap in dB
+ *
+ * \returns 0 on success, -1 if there are too many taps or the delay is out of range
+ */
+int delayAddTap(Delay* dl, float time, float depth, float rate, float gain);
+
+/**
+ * \brief Forget all input so the next block starts from silence
+ */
+void delayReset(Delay* dl);
+
+/**
+ * \brief Free the ring
+ */
+void delayFree(Delay* dl);
+
+/**
+ * \brief Processor which adds the taps to up to DSP_BLOCK frames at a time
+ */
+DspProcessor delayProcessor(Delay* dl);
+
+#endif
@@ -0,0 +1,233 @@
+// Date: 10/19/2026
+// Summary: Spectral noise reduction which learns the noise of the rig while it calibrates
+
+#include <string.h>
+#include <math.h>
+#include "denoise.h"
+#include "audio.h"
+
+int denoiseInit(Denoiser* dn, int channels, float reduction)
+{
+    if (fftInit(&dn->fft, DENOISE_SIZE))
+    {
+        return -1;
+    }
+    dn->channels = channels;
+    dn->floor = powf(10, -reduction / 20);
+    dn->learnHops = DENOISE_LEARN_TIME * SAMPLE_RATE / 1000 / DENOISE_HOP;
+    memset(dn->specRe, 0, sizeof(dn->specRe));
+    memset(dn->specIm, 0, sizeof(dn->specIm));
+
+    // A periodic Hann window applied twice sums to 2 across four overlapping hops
+    for (int i = 0; i < DENOISE_SIZE; ++i)
+    {
+        dn->window[i] = sqrtf(0.5f - 0.5f * cosf(2 * M_PI * i / DENOISE_SIZE));
+        dn->synthesis[i] = dn->window[i] * (DENOISE_HOP * 2.0f / DENOISE_SIZE);
+    }
+    denoiseReset(dn);
+    return 0;
+}
+
+void denoiseReset(Denoiser* dn)
+{
+    memset(dn->input, 0, sizeof(dn->input));
+    memset(dn->overlap, 0, sizeof(dn->overlap));
+    memset(dn->ready, 0, sizeof(dn->ready));
+    memset(dn->noise, 0, sizeof(dn->noise));
+    memset(dn->snr, 0, sizeof(dn->snr));
+    dn->fill = 0;
+    dn->learned = 0;
+}
+
+void denoiseFree(Denoiser* dn)
+{
+    fftFree(&dn->fft);
+}
+
+/**
+ * \brief Window a transform of output and add it to the overlap, four samples at a time
+ */
+static void overlapAdd(float* overlap, const float* src, const float* window)
+{
+    v4f x, w, sum;
+
+    for (int i = 0; i < DENOISE_SIZE; i += 4)
+    {
+        memcpy(&x, src + i, sizeof(v4f));
+        memcpy(&w, window + i, sizeof(v4f));
+        memcpy(&sum, overlap + i, sizeof(v4f));
+        sum += x * w;
+        memcpy(overlap + i, &sum, sizeof(v4f));
+    }
+}
+
+/**
+ * \brief Find the gain of every bin of one channel from its power and the noise profile
+ */
+static void findGains(Denoiser* dn, int c)
+{
+    const v4f one = {1, 1, 1, 1};
+    const v4f tiny = {1e-20f, 1e-20f, 1e-20f, 1e-20f};
+    v4f floor = {dn->floor, dn->floor, dn->floor, dn->floor};
+    v4f power, noise, snr, post, prior, gain;
+    v4u above;
+
+    for (int k = 0; k < DENOISE_BINS; k += 4)
+    {
+        memcpy(&power, dn->power[c] + k, sizeof(v4f));
+        memcpy(&noise, dn->noise[c] + k, sizeof(v4f));
+        memcpy(&snr, dn->snr[c] + k, sizeof(v4f));
+
+        // Blend the SNR left after the last hop's gain with what this hop shows above the noise
+        post = power / (noise + tiny);
+        prior = post - one;
+        prior = (v4f)((v4u)prior & (v4u)(prior > 0));
+        prior = DENOISE_SMOOTHING * snr + (1 - DENOISE_SMOOTHING) * prior;
+        gain = prior / (one + prior);
+        above = (v4u)(gain > floor);
+        gain = (v4f)(((v4u)gain & above) | ((v4u)floor & ~above));
+
+        memcpy(dn->gain[c] + k, &gain, sizeof(v4f));
+        snr = gain * gain * post;
+        memcpy(dn->snr[c] + k, &snr, sizeof(v4f));
+    }
+}
+
+/**
+ * \brief Reduce the noise of the last DENOISE_SIZE frames and overlap-add the result
+ */
+static void denoiseHop(Denoiser* dn)
+{
+    int c, k, m;
+    float r0, i0, r1, i1;
+    float* re = dn->re;
+    float* im = dn->im;
+
+    // Transform both channels at once, one as the real part and one as the imaginary part
+    memcpy(re, dn->input[0], sizeof(dn->re));
+    multiplyGain(re, dn->window, DENOISE_SIZE);
+    if (dn->channels > 1)
+    {
+        memcpy(im, dn->input[1], sizeof(dn->im));
+        multiplyGain(im, dn->window, DENOISE_SIZE);
+    }
+    else
+    {
+        memset(im, 0, sizeof(dn->im));
+    }
+    fftForward(&dn->fft, re, im);
+
+    // Pull the two real spectra apart using their symmetry
+    for (k = 0; k <= DENOISE_SIZE / 2; ++k)
+    {
+        m = (DENOISE_SIZE - k) & (DENOISE_SIZE - 1);
+        dn->specRe[0][k] = 0.5f * (re[k] + re[m]);
+        dn->specIm[0][k] = 0.5f * (im[k] - im[m]);
+        dn->specRe[1][k] = 0.5f * (im[k] + im[m]);
+        dn->specIm[1][k] = 0.5f * (re[m] - re[k]);
+    }
+    for (c = 0; c < dn->channels; ++c)
+    {
+        for (k = 0; k < DENOISE_BINS; ++k)
+        {
+            dn->power[c][k] = dn->specRe[c][k] * dn->specRe[c][k]
+                + dn->specIm[c][k] * dn->specIm[c][k];
+        }
+    }
+
+    // Learn the noise while the rig calibrates, passing the input through unchanged
+    if (dn->learned < dn->learnHops)
+    {
+        for (c = 0; c < dn->channels; ++c)
+        {
+            for (k = 0; k < DENOISE_BINS; ++k)
+            {
+                dn->noise[c][k] += dn->power[c][k];
+                dn->gain[c][k] = 1;
+            }
+        }
+        if (++dn->learned == dn->learnHops)
+        {
+            for (c = 0; c < dn->channels; ++c)
+            {
+                for (k = 0; k < DENOISE_BINS; ++k)
+                {
+                    dn->noise[c][k] *= DENOISE_OVERSUBTRACT / dn->learnHops;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (c = 0; c < dn->channels; ++c)
+        {
+            findGains(dn, c);
+        }
+    }
+    if (dn->channels == 1)
+    {
+        memset(dn->gain[1], 0, sizeof(dn->gain[1]));
+    }
+
+    // Put the scaled spectra back together, including the mirrored negative frequencies
+    for (k = 0; k <= DENOISE_SIZE / 2; ++k)
+    {
+        m = (DENOISE_SIZE - k) & (DENOISE_SIZE - 1);
+        r0 = dn->gain[0][k] * dn->specRe[0][k];
+        i0 = dn->gain[0][k] * dn->specIm[0][k];
+        r1 = dn->gain[1][k] * dn->specRe[1][k];
+        i1 = dn->gain[1][k] * dn->specIm[1][k];
+        re[k] = r0 - i1;
+        im[k] = i0 + r1;
+        re[m] = r0 + i1;
+        im[m] = r1 - i0;
+    }
+    fftInverse(&dn->fft, re, im);
+
+    // Overlap-add, then the first hop of the sum is finished
+    for (c = 0; c < dn->channels; ++c)
+    {
+        overlapAdd(dn->overlap[c], c == 0 ? re : im, dn->synthesis);
+        memcpy(dn->ready[c], dn->overlap[c], DENOISE_HOP * sizeof(float));
+        memmove(dn->overlap[c], dn->overlap[c] + DENOISE_HOP,
+            (DENOISE_SIZE - DENOISE_HOP) * sizeof(float));
+        memset(dn->overlap[c] + DENOISE_SIZE - DENOISE_HOP, 0, DENOISE_HOP * sizeof(float));
+        memmove(dn->input[c], dn->input[c] + DENOISE_HOP,
+            (DENOISE_SIZE - DENOISE_HOP) * sizeof(float));
+    }
+}
+
+/**
+ * \brief Swap each frame for the finished output a transform ago, transforming every hop
+ */
+static void denoiseProcess(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Denoiser* dn = state;
+    size_t done = 0, count;
+    int c;
+
+    while (done < frames)
+    {
+        count = DENOISE_HOP - dn->fill;
+        count = count < frames - done ? count : frames - done;
+        for (c = 0; c < numChannels && c < dn->channels; ++c)
+        {
+            memcpy(dn->input[c] + DENOISE_SIZE - DENOISE_HOP + dn->fill, channels[c] + done,
+                count * sizeof(float));
+            memcpy(channels[c] + done, dn->ready[c] + dn->fill, count * sizeof(float));
+        }
+        dn->fill += count;
+        done += count;
+        if (dn->fill == DENOISE_HOP)
+        {
+            denoiseHop(dn);
+            dn->fill = 0;
+        }
+    }
+}
+
+DspProcessor denoiseProcessor(Denoiser* dn)
+{
+    DspProcessor processor = {"denoise", dn, denoiseProcess, DENOISE_SIZE};
+    return processor;
+}
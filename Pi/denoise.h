@@ -0,0 +1,80 @@
+// Date: 10/19/2026
+// Summary: Spectral noise reduction which learns the noise of the rig while it calibrates
+
+#ifndef DENOISE_H
+#define DENOISE_H
+
+#include "dsp.h"
+#include "fft.h"
+
+#define DENOISE_SIZE 256                            // points in each transform (5.3 ms)
+#define DENOISE_HOP (DENOISE_SIZE / 4)              // frames between transforms (75% overlap)
+#define DENOISE_BINS ((DENOISE_SIZE / 2 + 1 + 3) & ~3)  // bins kept per spectrum (padded for SIMD)
+#define DENOISE_LEARN_TIME 500                      // time in ms spent learning the noise
+#define DENOISE_REDUCTION 15                        // default largest reduction in dB
+#define DENOISE_OVERSUBTRACT 2.0f                   // factor on the noise to keep hiss from returning
+#define DENOISE_SMOOTHING 0.98f                     // weight of the last hop in the SNR estimate
+
+/**
+ * \brief State of the noise reducer
+ *
+ * The first DENOISE_LEARN_TIME ms of input, while the FPGA calibrates and the strings are
+ * quiet, are passed through unchanged and their average power in each bin becomes the noise
+ * profile.  Afterwards each hop of input is windowed (square root of a Hann window), and the
+ * two channels share one complex transform as its real and imaginary parts.  Each bin is
+ * scaled by a Wiener gain from a decision-directed SNR estimate, which changes smoothly
+ * enough from hop to hop to avoid the "musical" noise of plain spectral subtraction, and
+ * the gain never falls below the reduction floor so note tails fade instead of being chopped.
+ * The inverse transform is windowed again and overlap-added, which delays the input by one
+ * transform.
+ */
+typedef struct
+{
+    Fft fft;                                    // transforms of DENOISE_SIZE points
+    int channels;                               // channels processed
+    float floor;                                // smallest gain of a bin
+    size_t learnHops;                           // hops averaged into the noise profile
+    size_t learned;                             // hops averaged so far
+    int fill;                                   // frames of the current hop received
+    float window[DENOISE_SIZE];                 // analysis window
+    float synthesis[DENOISE_SIZE];              // synthesis window, scaled for the overlap
+    float input[MAX_CHANNELS][DENOISE_SIZE];    // last DENOISE_SIZE frames of input
+    float overlap[MAX_CHANNELS][DENOISE_SIZE];  // output being overlap-added
+    float ready[MAX_CHANNELS][DENOISE_HOP];     // finished output being played out
+    float noise[MAX_CHANNELS][DENOISE_BINS];    // power of the noise in each bin
+    float snr[MAX_CHANNELS][DENOISE_BINS];      // SNR of each bin after the last hop's gain
+    float specRe[MAX_CHANNELS][DENOISE_BINS];   // spectrum of each channel (real parts)
+    float specIm[MAX_CHANNELS][DENOISE_BINS];   // spectrum of each channel (imaginary parts)
+    float power[MAX_CHANNELS][DENOISE_BINS];    // power of each bin of the current hop
+    float gain[MAX_CHANNELS][DENOISE_BINS];     // gain of each bin of the current hop
+    float re[DENOISE_SIZE];                     // transform workspace (real parts)
+    float im[DENOISE_SIZE];                     // transform workspace (imaginary parts)
+} Denoiser;
+
+/**
+ * \brief Set up the noise reducer, which starts by learning the noise
+ *
+ * \param dn            state to initialize
+ * \param channels      number of channels which will be processed
+ * \param reduction     largest reduction in dB of any bin
+ *
+ * \returns 0 on success, -1 if the transform tables could not be allocated
+ */
+int denoiseInit(Denoiser* dn, int channels, float reduction);
+
+/**
+ * \brief Forget all input and learn the noise again from the next DENOISE_LEARN_TIME ms
+ */
+void denoiseReset(Denoiser* dn);
+
+/**
+ * \brief Free the transform tables
+ */
+void denoiseFree(Denoiser* dn);
+
+/**
+ * \brief Processor which reduces the noise of any number of frames at a time
+ */
+DspProcessor denoiseProcessor(Denoiser* dn);
+
+#endif
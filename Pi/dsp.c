@@ -0,0 +1,109 @@
+// Date: 10/19/2026
+// Summary: Runs a chain of block-based audio processors on the live input from a worker thread
+
+#include <unistd.h>
+#include <math.h>
+#include "dsp.h"
+
+int dspInit(DspChain* chain, int channels)
+{
+    chain->numStages = 0;
+    chain->channels = channels;
+    chain->underruns = 0;
+    chain->late = 0;
+    for (int c = 0; c < MAX_CHANNELS; ++c)
+    {
+        chain->planes[c] = chain->block[c];
+    }
+
+    if (ringInit(&chain->in, MAX_CHANNELS * sizeof(short), DSP_QUEUE)
+        || ringInit(&chain->out, MAX_CHANNELS * sizeof(short), DSP_QUEUE))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int dspAdd(DspChain* chain, DspProcessor processor)
+{
+    if (chain->numStages >= DSP_MAX_STAGES)
+    {
+        return -1;
+    }
+    chain->stages[chain->numStages++] = processor;
+    return 0;
+}
+
+size_t dspLatency(const DspChain* chain)
+{
+    size_t latency = DSP_PRIME;
+    for (int i = 0; i < chain->numStages; ++i)
+    {
+        latency += chain->stages[i].latency;
+    }
+    return latency;
+}
+
+void dspProcess(DspChain* chain, float* const* channels, size_t frames)
+{
+    for (int i = 0; i < chain->numStages; ++i)
+    {
+        chain->stages[i].process(chain->stages[i].state, channels, chain->channels, frames);
+    }
+}
+
+/**
+ * \brief Worker which processes a block whenever one is queued
+ */
+static void* dspThread(void* arg)
+{
+    DspChain* chain = arg;
+    short frame[MAX_CHANNELS];
+    float sample;
+    size_t i;
+    int c;
+
+    while (1)
+    {
+        if (ringCount(&chain->in) < DSP_BLOCK)
+        {
+            usleep(100);
+            continue;
+        }
+
+        for (i = 0; i < DSP_BLOCK; ++i)
+        {
+            ringPop(&chain->in, frame);
+            for (c = 0; c < chain->channels; ++c)
+            {
+                chain->block[c][i] = frame[c] * (1.0f / (1 << 15));
+            }
+        }
+
+        dspProcess(chain, chain->planes, DSP_BLOCK);
+
+        // Convert back with saturation; unused channels repeat the first
+        for (i = 0; i < DSP_BLOCK; ++i)
+        {
+            for (c = 0; c < MAX_CHANNELS; ++c)
+            {
+                sample = chain->block[c < chain->channels ? c : 0][i] * (1 << 15);
+                sample = sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample;
+                frame[c] = (short)lrintf(sample);
+            }
+            ringPush(&chain->out, frame);
+        }
+    }
+    return NULL;
+}
+
+int dspStart(DspChain* chain)
+{
+    short silence[MAX_CHANNELS] = {0};
+
+    for (int i = 0; i < DSP_PRIME; ++i)
+    {
+        ringPush(&chain->out, silence);
+    }
+    return pthread_create(&chain->thread, NULL, dspThread, chain) ? -1 : 0;
+}
@@ -0,0 +1,111 @@
+// Date: 10/19/2026
+// Summary: Runs a chain of block-based audio processors on the live input from a worker thread
+
+#ifndef DSP_H
+#define DSP_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "ring.h"
+#include "wav.h"
+
+#define DSP_BLOCK 32                    // frames processed at once (0.67 ms)
+#define DSP_PRIME (2 * DSP_BLOCK)       // silent frames queued ahead of the audio loop
+#define DSP_QUEUE 1024                  // frames which can wait in each direction
+#define DSP_MAX_STAGES 8                // maximum number of processors in a chain
+
+/**
+ * \brief A stage of processing applied to blocks of planar float samples (-1 to 1)
+ */
+typedef struct
+{
+    const char* name;           // name used in messages
+    void* state;                // state passed to process
+    void (*process)(void* state, float* const* channels, int numChannels, size_t frames);
+    size_t latency;             // frames by which the stage delays its input
+} DspProcessor;
+
+/**
+ * \brief Processors run in order on the input by a worker thread
+ *
+ * The audio loop queues each input frame and takes back a processed one.  The output queue
+ * starts with DSP_PRIME silent frames, which gives the worker a block's worth of time to
+ * process each block, so the chain delays the input by DSP_PRIME frames plus the latency of
+ * its stages.
+ */
+typedef struct
+{
+    Ring in;                                    // frames from the audio loop
+    Ring out;                                   // processed frames for the audio loop
+    DspProcessor stages[DSP_MAX_STAGES];        // processors in the order they are applied
+    int numStages;                              // number of processors
+    int channels;                               // channels processed
+    float block[MAX_CHANNELS][DSP_BLOCK];       // block being processed
+    float* planes[MAX_CHANNELS];                // pointers to each channel of block
+    size_t underruns;                           // frames the audio loop wanted before they were ready
+    size_t late;                                // late frames still to be skipped
+    pthread_t thread;                           // worker thread
+} DspChain;
+
+/**
+ * \brief Initialize an empty chain
+ *
+ * \returns 0 on success, -1 if the queues could not be allocated
+ */
+int dspInit(DspChain* chain, int channels);
+
+/**
+ * \brief Add a processor to the end of the chain (before dspStart)
+ *
+ * \returns 0 on success, -1 if the chain is full
+ */
+int dspAdd(DspChain* chain, DspProcessor processor);
+
+/**
+ * \brief Start the worker thread
+ *
+ * \returns 0 on success, -1 on failure
+ */
+int dspStart(DspChain* chain);
+
+/**
+ * \brief Frames by which the chain delays its input
+ */
+size_t dspLatency(const DspChain* chain);
+
+/**
+ * \brief Run every stage on a block of planar samples (used by the worker and offline)
+ *
+ * \param channels      chain->channels pointers to frames samples each
+ * \param frames        number of frames (DSP_BLOCK; pad the end of a file with silence)
+ */
+void dspProcess(DspChain* chain, float* const* channels, size_t frames);
+
+/**
+ * \brief Queue an input frame and take a processed frame (called by the audio loop)
+ *
+ * If the worker falls behind, silence is played in place of each missing frame and the
+ * frames are skipped once they arrive, so the delay through the chain never grows.
+ *
+ * \param frame         MAX_CHANNELS samples, replaced with the processed frame
+ */
+static inline void dspExchange(DspChain* chain, short* frame)
+{
+    ringPush(&chain->in, frame);
+    if (ringPop(&chain->out, frame))
+    {
+        for (int c = 0; c < MAX_CHANNELS; ++c)
+        {
+            frame[c] = 0;
+        }
+        chain->underruns++;
+        chain->late++;
+        return;
+    }
+    while (chain->late > 0 && ringPop(&chain->out, frame) == 0)
+    {
+        chain->late--;
+    }
+}
+
+#endif
@@ -0,0 +1,195 @@
+// Date: 10/19/2026
+// Summary: RMS compressor and look-ahead peak limiter for the playback mix
+
+#include <string.h>
+#include <math.h>
+#include "dynamics.h"
+#include "audio.h"
+
+/**
+ * \brief Coefficient of a one-pole smoother which settles in time ms, updated every step frames
+ */
+static float smoothing(float time, int step)
+{
+    return 1 - expf(-step / (time * SAMPLE_RATE / 1000));
+}
+
+void dynamicsInit(Dynamics* dyn, int channels, float threshold, float ratio, float makeup,
+    float ceiling)
+{
+    dyn->channels = channels;
+    dyn->threshold = threshold;
+    dyn->slope = ratio > 1 ? 1 - 1 / ratio : 0;
+    dyn->makeup = makeup;
+    dyn->ceiling = powf(10, ceiling / 20);
+    dyn->attack = smoothing(DYNAMICS_ATTACK, DSP_BLOCK);
+    dyn->release = smoothing(DYNAMICS_RELEASE, DSP_BLOCK);
+    dyn->limitRelease = smoothing(DYNAMICS_LIMIT_RELEASE, 1);
+    dynamicsReset(dyn);
+}
+
+void dynamicsReset(Dynamics* dyn)
+{
+    memset(dyn->delay, 0, sizeof(dyn->delay));
+    for (int i = 0; i < DYNAMICS_LOOKAHEAD; ++i)
+    {
+        dyn->need[i] = 1;
+        dyn->window[i] = 1;
+    }
+    dyn->windowSum = DYNAMICS_LOOKAHEAD;
+    dyn->queueHead = 0;
+    dyn->queueSize = 0;
+    dyn->count = 0;
+    dyn->envelope = 0;
+    dyn->compGain = powf(10, dyn->makeup / 20);
+    dyn->limitGain = 1;
+    atomic_store(&dyn->compReduction, 0);
+    atomic_store(&dyn->limitReduction, 0);
+}
+
+/**
+ * \brief Gain reduction in dB for a level in dB (soft knee)
+ */
+static float gainReduction(const Dynamics* dyn, float level)
+{
+    float over = level - dyn->threshold;
+
+    if (2 * over <= -DYNAMICS_KNEE)
+    {
+        return 0;
+    }
+    if (2 * over >= DYNAMICS_KNEE)
+    {
+        return dyn->slope * over;
+    }
+    over += DYNAMICS_KNEE / 2.0f;
+    return dyn->slope * over * over / (2 * DYNAMICS_KNEE);
+}
+
+/**
+ * \brief Compress one block of every channel in place
+ */
+static void compress(Dynamics* dyn, float* const* channels, int numChannels, size_t frames)
+{
+    float meanSquare = 0;
+    float reduction, target, step;
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        meanSquare += dotProduct(channels[c], channels[c], frames);
+    }
+    meanSquare /= frames * numChannels;
+    dyn->envelope += (meanSquare > dyn->envelope ? dyn->attack : dyn->release)
+        * (meanSquare - dyn->envelope);
+
+    // Ramp from the last block's gain to this one's so that the gain never steps
+    reduction = gainReduction(dyn, 10 * log10f(dyn->envelope + 1e-20f));
+    atomic_store_explicit(&dyn->compReduction, (int)(reduction * 100), memory_order_relaxed);
+    target = powf(10, (dyn->makeup - reduction) / 20);
+    step = (target - dyn->compGain) / frames;
+    for (size_t i = 0; i < frames; ++i)
+    {
+        dyn->gain[i] = dyn->compGain + step * (i + 1);
+    }
+    dyn->compGain = target;
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        multiplyGain(channels[c], dyn->gain, frames);
+    }
+}
+
+/**
+ * \brief Find the limiter's gain for each sample leaving the delay line
+ *
+ * The gain for the sample which entered DYNAMICS_LOOKAHEAD - 1 samples ago is the average,
+ * over the last DYNAMICS_LOOKAHEAD samples, of the smallest gain needed in the window ending
+ * at each.  Every term of that average covers the leaving sample, so none is above the gain
+ * it needs.
+ */
+static void limitGains(Dynamics* dyn, size_t frames)
+{
+    size_t n, back;
+    float need, smallest, gain;
+    float least = 1;
+    int reduction;
+
+    for (size_t i = 0; i < frames; ++i)
+    {
+        n = dyn->count++;
+        need = dyn->peak[i] > dyn->ceiling ? dyn->ceiling / dyn->peak[i] : 1;
+        dyn->need[n % DYNAMICS_LOOKAHEAD] = need;
+
+        // Keep the samples in the window whose need no later sample undercuts
+        if (dyn->queueSize > 0 && dyn->queue[dyn->queueHead] + DYNAMICS_LOOKAHEAD <= n)
+        {
+            dyn->queueHead = (dyn->queueHead + 1) % DYNAMICS_LOOKAHEAD;
+            dyn->queueSize--;
+        }
+        while (dyn->queueSize > 0)
+        {
+            back = dyn->queue[(dyn->queueHead + dyn->queueSize - 1) % DYNAMICS_LOOKAHEAD];
+            if (dyn->need[back % DYNAMICS_LOOKAHEAD] < need)
+            {
+                break;
+            }
+            dyn->queueSize--;
+        }
+        dyn->queue[(dyn->queueHead + dyn->queueSize++) % DYNAMICS_LOOKAHEAD] = n;
+        smallest = dyn->need[dyn->queue[dyn->queueHead] % DYNAMICS_LOOKAHEAD];
+
+        // Average the smallest needs, then let the gain rise slowly but fall at once
+        dyn->windowSum += smallest - dyn->window[n % DYNAMICS_LOOKAHEAD];
+        dyn->window[n % DYNAMICS_LOOKAHEAD] = smallest;
+        gain = dyn->windowSum / DYNAMICS_LOOKAHEAD;
+        if (gain > dyn->limitGain)
+        {
+            gain = dyn->limitGain + (gain - dyn->limitGain) * dyn->limitRelease;
+        }
+        dyn->limitGain = gain;
+        dyn->gain[i] = gain;
+        least = gain < least ? gain : least;
+    }
+
+    // Only this thread raises the peak, so a reader's exchange in between loses nothing newer
+    reduction = (int)(-2000 * log10f(least));
+    if (reduction > atomic_load_explicit(&dyn->limitReduction, memory_order_relaxed))
+    {
+        atomic_store_explicit(&dyn->limitReduction, reduction, memory_order_relaxed);
+    }
+}
+
+/**
+ * \brief Compress and limit one block of every channel in place
+ */
+static void dynamicsProcess(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Dynamics* dyn = state;
+    int count = numChannels < dyn->channels ? numChannels : dyn->channels;
+    float* delay;
+
+    compress(dyn, channels, count, frames);
+
+    memset(dyn->peak, 0, frames * sizeof(float));
+    for (int c = 0; c < count; ++c)
+    {
+        peakAbs(dyn->peak, channels[c], frames);
+    }
+    limitGains(dyn, frames);
+
+    // Play the samples leaving the delay line at the limiter's gain
+    for (int c = 0; c < count; ++c)
+    {
+        delay = dyn->delay[c];
+        memcpy(delay + DYNAMICS_LOOKAHEAD - 1, channels[c], frames * sizeof(float));
+        memcpy(channels[c], delay, frames * sizeof(float));
+        multiplyGain(channels[c], dyn->gain, frames);
+        memmove(delay, delay + frames, (DYNAMICS_LOOKAHEAD - 1) * sizeof(float));
+    }
+}
+
+DspProcessor dynamicsProcessor(Dynamics* dyn)
+{
+    DspProcessor processor = {"dynamics", dyn, dynamicsProcess, DYNAMICS_LOOKAHEAD - 1};
+    return processor;
+}
@@ -0,0 +1,82 @@
+// Date: 10/19/2026
+// Summary: RMS compressor and look-ahead peak limiter for the playback mix
+
+#ifndef DYNAMICS_H
+#define DYNAMICS_H
+
+#include <stdatomic.h>
+#include "dsp.h"
+
+#define DYNAMICS_LOOKAHEAD 48       // frames the limiter sees ahead (1 ms)
+#define DYNAMICS_THRESHOLD -24      // default compressor threshold in dB below full scale
+#define DYNAMICS_RATIO 3            // default compression ratio
+#define DYNAMICS_KNEE 6             // width in dB of the compressor's soft knee
+#define DYNAMICS_ATTACK 10          // compressor attack time in ms
+#define DYNAMICS_RELEASE 150        // compressor release time in ms
+#define DYNAMICS_LIMIT_RELEASE 50   // limiter release time in ms
+#define DYNAMICS_CEILING -1         // default limiter ceiling in dB below full scale
+
+/**
+ * \brief State of the compressor and limiter
+ *
+ * The compressor follows the mean square of each block, found with the vectorized dot
+ * product, and ramps its gain across the block.  The limiter then finds the gain each sample
+ * needs to stay under the ceiling, takes the smallest over the look-ahead window with a
+ * monotonic queue (O(1) per sample amortized), and averages that over the same window, so
+ * the gain is already down by the time a peak leaves the delay line and never steps.
+ *
+ * The gain reductions are published for reports in hundredths of a dB, so that another thread
+ * can read them while the DSP thread runs.
+ */
+typedef struct
+{
+    int channels;                           // channels processed (linked: one gain for all)
+    float threshold;                        // compressor threshold in dB
+    float slope;                            // 1 - 1 / ratio
+    float makeup;                           // gain in dB after compression
+    float ceiling;                          // largest sample the limiter lets through
+    float attack;                           // compressor envelope coefficient per block (rising)
+    float release;                          // compressor envelope coefficient per block (falling)
+    float limitRelease;                     // limiter gain coefficient per sample (rising)
+    float envelope;                         // compressor's mean square envelope
+    float compGain;                         // compressor gain at the end of the last block
+    float limitGain;                        // limiter gain of the last sample
+    float delay[MAX_CHANNELS][DYNAMICS_LOOKAHEAD - 1 + DSP_BLOCK];  // samples in the look-ahead
+    float need[DYNAMICS_LOOKAHEAD];         // gain needed by each sample in the window (ring)
+    size_t queue[DYNAMICS_LOOKAHEAD];       // samples in the window with increasing need (ring)
+    int queueHead;                          // oldest entry of queue
+    int queueSize;                          // entries in queue
+    float window[DYNAMICS_LOOKAHEAD];       // smallest needed gains being averaged (ring)
+    double windowSum;                       // sum of window
+    size_t count;                           // samples processed
+    float gain[DSP_BLOCK];                  // gain of each sample in the block
+    float peak[DSP_BLOCK];                  // largest magnitude across channels of each sample
+    atomic_int compReduction;               // compressor gain reduction of the last block
+    atomic_int limitReduction;              // largest limiter gain reduction since exchanged
+                                            // for 0 by the reader
+} Dynamics;
+
+/**
+ * \brief Set up the compressor and limiter
+ *
+ * \param dyn           state to initialize
+ * \param channels      number of channels which will be processed
+ * \param threshold     level in dB at which compression starts
+ * \param ratio         compression ratio above the threshold (1 for none)
+ * \param makeup        gain in dB applied after compression
+ * \param ceiling       level in dB which no sample will exceed
+ */
+void dynamicsInit(Dynamics* dyn, int channels, float threshold, float ratio, float makeup,
+    float ceiling);
+
+/**
+ * \brief Forget all input so the next block starts from silence
+ */
+void dynamicsReset(Dynamics* dyn);
+
+/**
+ * \brief Processor which applies the compressor and limiter to up to DSP_BLOCK frames at a time
+ */
+DspProcessor dynamicsProcessor(Dynamics* dyn);
+
+#endif
@@ -0,0 +1,137 @@
+// Date: 10/19/2026
+// Summary: Software port of the FPGA's effects with one specialized kernel per switch setting
+
+#include <string.h>
+#include "effects.h"
+#include "tables.h"
+
+#define RING_MASK (EFFECTS_RING - 1)
+
+/**
+ * \brief Value of a sign-magnitude word, keeping only the magnitude bits from low up
+ *
+ * \param low           lowest magnitude bit kept (1 halves the value, as for the chorus)
+ */
+static inline int echo(unsigned short word, int low)
+{
+    int magnitude = (word & 0x3FF) >> low;
+    return word & 0x400 ? -magnitude : magnitude;
+}
+
+/**
+ * \brief Apply one switch setting to a block of samples
+ *
+ * Every kernel is this function inlined with a constant switches, so the compiler removes
+ * the stages which are off along with the tests for them.  One sample here is one round of
+ * effects.sv: the ring address advances every other round, the delay reads the oldest data
+ * and the three chorus taps read 0x200, 0x300 and 0x400 addresses back.
+ */
+static inline __attribute__((always_inline)) void effectsRun(Effects* fx,
+    const unsigned short* in, short* out, size_t frames, const int switches)
+{
+    const int sensor = switches & EFFECTS_SENSOR;
+    const int intensity = fx->intensity;
+    const unsigned short* shape = fx->shape;
+    unsigned short* ring = fx->ring;
+    unsigned int writeAdr = fx->writeAdr;
+    unsigned int oldAdr;
+    int increaseAdr = fx->increaseAdr;
+    unsigned short repCounter = fx->repCounter;
+    int word, sample, sum, magnitude;
+
+    for (size_t i = 0; i < frames; ++i)
+    {
+        word = in[i] & 0x7FF;
+        sample = echo(word, 0);
+
+        oldAdr = writeAdr;
+        writeAdr = (writeAdr + increaseAdr) & RING_MASK;
+        increaseAdr = !increaseAdr;
+        repCounter += intensity;
+        sum = sample;
+
+        if (switches & EFFECTS_DELAY)
+        {
+            sum += echo(ring[(oldAdr + 1 + (sensor ? intensity << 9 : 0)) & RING_MASK], 0);
+        }
+        if (switches & EFFECTS_CHORUS)
+        {
+            sum += echo(ring[(writeAdr - (sensor ? (intensity + 1) << 8 : 0x200))
+                & RING_MASK], 1);
+            sum += echo(ring[(writeAdr - (sensor ? ((intensity + 1) << 8)
+                + ((intensity + 1) << 7) : 0x300)) & RING_MASK], 1);
+            sum += echo(ring[(writeAdr - (sensor ? (intensity + 1) << 9 : 0x400))
+                & RING_MASK], 1);
+        }
+        ring[writeAdr] = word;
+
+        // Overdrive and saturation are folded into one table for the setting
+        magnitude = shape[sum < 0 ? -sum : sum];
+
+        // Solo gates quiet samples and inverts the rest; with the sensor it also repeats
+        if (switches & EFFECTS_SOLO)
+        {
+            if (magnitude < 0xF || (sensor && (repCounter & 0x8000) && intensity > 1))
+            {
+                magnitude = 0;
+            }
+            else
+            {
+                magnitude = ((-magnitude) & 0x3FF) >> 1;
+            }
+        }
+
+        out[i] = decodeTable[(sum < 0 ? 0x400 : 0) | magnitude];
+    }
+
+    fx->writeAdr = writeAdr;
+    fx->increaseAdr = increaseAdr;
+    fx->repCounter = repCounter;
+}
+
+// One kernel per switch setting
+#define KERNEL(s) static void kernel##s(Effects* fx, const unsigned short* in, short* out, \
+    size_t frames) { effectsRun(fx, in, out, frames, s); }
+KERNEL(0) KERNEL(1) KERNEL(2) KERNEL(3) KERNEL(4) KERNEL(5) KERNEL(6) KERNEL(7)
+KERNEL(8) KERNEL(9) KERNEL(10) KERNEL(11) KERNEL(12) KERNEL(13) KERNEL(14) KERNEL(15)
+KERNEL(16) KERNEL(17) KERNEL(18) KERNEL(19) KERNEL(20) KERNEL(21) KERNEL(22) KERNEL(23)
+KERNEL(24) KERNEL(25) KERNEL(26) KERNEL(27) KERNEL(28) KERNEL(29) KERNEL(30) KERNEL(31)
+
+static const EffectsKernel kernels[EFFECTS_COMBINATIONS] = {
+    kernel0, kernel1, kernel2, kernel3, kernel4, kernel5, kernel6, kernel7,
+    kernel8, kernel9, kernel10, kernel11, kernel12, kernel13, kernel14, kernel15,
+    kernel16, kernel17, kernel18, kernel19, kernel20, kernel21, kernel22, kernel23,
+    kernel24, kernel25, kernel26, kernel27, kernel28, kernel29, kernel30, kernel31
+};
+
+void effectsInit(Effects* fx, int switches, int intensity)
+{
+    memset(fx->ring, 0, sizeof(fx->ring));
+    fx->writeAdr = 0;
+    fx->increaseAdr = 0;
+    fx->repCounter = 0;
+    effectsSet(fx, switches, intensity);
+}
+
+void effectsSet(Effects* fx, int switches, int intensity)
+{
+    fx->switches = switches & (EFFECTS_COMBINATIONS - 1);
+    fx->intensity = intensity & 0xF;
+    fx->kernel = kernels[fx->switches];
+
+    if (!(switches & EFFECTS_OVERDRIVE))
+    {
+        fx->shape = shapeTables[0];
+    }
+    else
+    {
+        fx->shape = shapeTables[switches & EFFECTS_SENSOR ? 2 + fx->intensity : 1];
+    }
+}
+
+void effectsGeneric(Effects* fx, const unsigned short* in, short* out, size_t frames)
+{
+    // Reading the switches through a volatile keeps the compiler from specializing the loop
+    volatile int switches = fx->switches;
+    effectsRun(fx, in, out, frames, switches);
+}
@@ -0,0 +1,74 @@
+// Date: 10/19/2026
+// Summary: Software port of the FPGA's effects with one specialized kernel per switch setting
+
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <stddef.h>
+
+#define VOLUME 16                   // volume multiplier applied to samples from the FPGA
+#define EFFECTS_OVERDRIVE 0x01      // switch[0]: amplify and clip loud samples
+#define EFFECTS_DELAY 0x02          // switch[1]: add a long echo
+#define EFFECTS_CHORUS 0x04         // switch[2]: add three short echoes at half volume
+#define EFFECTS_SOLO 0x08           // switch[3]: gate quiet samples and invert the rest
+#define EFFECTS_SENSOR 0x10         // switch[4]: the intensity controls the other effects
+#define EFFECTS_COMBINATIONS 32     // number of switch settings
+#define EFFECTS_RING 8192           // words in the echo ring buffer (as in mem.sv)
+#define EFFECTS_MAGNITUDES 4096     // largest magnitude of the sum of the echoes + 1
+#define EFFECTS_SHAPES 18           // clean, overdrive, and overdrive at each intensity
+
+typedef struct Effects Effects;
+
+/**
+ * \brief Kernel applying one switch setting to a block of samples
+ *
+ * \param fx            effect state
+ * \param in            11-bit sign-magnitude samples, as sent by the FPGA with its effects off
+ * \param out           receives 16-bit samples
+ * \param frames        number of samples
+ */
+typedef void (*EffectsKernel)(Effects* fx, const unsigned short* in, short* out, size_t frames);
+
+/**
+ * \brief State of the effects (mirrors the registers of effects.sv)
+ */
+struct Effects
+{
+    unsigned short ring[EFFECTS_RING];  // sign-magnitude input samples (two per address)
+    unsigned int writeAdr;              // address being written
+    int increaseAdr;                    // whether writeAdr advances on the next sample
+    unsigned short repCounter;          // counter gating the repeater
+    int switches;                       // switch setting (EFFECTS_* bits)
+    int intensity;                      // intensity used with EFFECTS_SENSOR (0 to 15)
+    const unsigned short* shape;        // overdrive and saturation for the setting
+    EffectsKernel kernel;               // kernel specialized for the setting
+};
+
+/**
+ * \brief Clear the effect state and choose a setting
+ */
+void effectsInit(Effects* fx, int switches, int intensity);
+
+/**
+ * \brief Choose a setting, looking up its kernel and shaping table (call only on a change)
+ *
+ * \param switches      EFFECTS_* bits
+ * \param intensity     intensity from 0 to 15 (the distance sensor's reading on the FPGA)
+ */
+void effectsSet(Effects* fx, int switches, int intensity);
+
+/**
+ * \brief Apply the effects with the kernel for the current setting
+ */
+static inline void effectsProcess(Effects* fx, const unsigned short* in, short* out,
+    size_t frames)
+{
+    fx->kernel(fx, in, out, frames);
+}
+
+/**
+ * \brief Apply the effects by testing every switch on every sample (for comparison)
+ */
+void effectsGeneric(Effects* fx, const unsigned short* in, short* out, size_t frames);
+
+#endif
@@ -0,0 +1,166 @@
+// Date: 10/19/2026
+// Summary: Radix-2 complex FFT on split real and imaginary arrays
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "fft.h"
+#include "audio.h"
+
+int fftInit(Fft* fft, int size)
+{
+    int bits = 0;
+
+    fft->cosTable = NULL;
+    fft->sinTable = NULL;
+    fft->reverse = NULL;
+    fft->stageCos = NULL;
+    fft->stageSin = NULL;
+    if (size < 2 || (size & (size - 1)))
+    {
+        return -1;
+    }
+    while ((1 << bits) < size)
+    {
+        bits++;
+    }
+
+    fft->size = size;
+    fft->cosTable = malloc(size / 2 * sizeof(float));
+    fft->sinTable = malloc(size / 2 * sizeof(float));
+    fft->reverse = malloc(size * sizeof(int));
+    fft->stageCos = malloc(size * sizeof(float));
+    fft->stageSin = malloc(size * sizeof(float));
+    if (fft->cosTable == NULL || fft->sinTable == NULL || fft->reverse == NULL
+        || fft->stageCos == NULL || fft->stageSin == NULL)
+    {
+        fftFree(fft);
+        return -1;
+    }
+
+    for (int k = 0; k < size / 2; ++k)
+    {
+        fft->cosTable[k] = cos(2 * M_PI * k / size);
+        fft->sinTable[k] = sin(2 * M_PI * k / size);
+    }
+    for (int half = 1; half < size; half <<= 1)
+    {
+        for (int j = 0; j < half; ++j)
+        {
+            fft->stageCos[half + j] = fft->cosTable[j * (size / (2 * half))];
+            fft->stageSin[half + j] = fft->sinTable[j * (size / (2 * half))];
+        }
+    }
+    for (int i = 0; i < size; ++i)
+    {
+        fft->reverse[i] = 0;
+        for (int b = 0; b < bits; ++b)
+        {
+            fft->reverse[i] |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+    }
+    return 0;
+}
+
+void fftFree(Fft* fft)
+{
+    free(fft->cosTable);
+    free(fft->sinTable);
+    free(fft->reverse);
+    free(fft->stageCos);
+    free(fft->stageSin);
+    fft->cosTable = NULL;
+    fft->sinTable = NULL;
+    fft->reverse = NULL;
+    fft->stageCos = NULL;
+    fft->stageSin = NULL;
+}
+
+/**
+ * \brief Iterative decimation-in-time transform
+ *
+ * \param sign          -1 for the forward transform, 1 for the inverse
+ */
+static void fftTransform(const Fft* fft, float* re, float* im, float sign)
+{
+    int n = fft->size;
+    int i, j, k, half, step;
+    float wr, wi, tr, ti, swap;
+    v4f vwr, vwi, xr, xi, yr, yi, vtr, vti;
+
+    // Put the points in bit-reversed order so the butterflies can work in place
+    for (i = 0; i < n; ++i)
+    {
+        j = fft->reverse[i];
+        if (i < j)
+        {
+            swap = re[i]; re[i] = re[j]; re[j] = swap;
+            swap = im[i]; im[i] = im[j]; im[j] = swap;
+        }
+    }
+
+    // Combine pairs of transforms of half the length until one remains, four butterflies at a
+    // time once the transforms are at least four points long
+    for (half = 1; half < n && half < 4; half <<= 1)
+    {
+        step = n / (2 * half);
+        for (i = 0; i < n; i += 2 * half)
+        {
+            for (j = 0; j < half; ++j)
+            {
+                wr = fft->cosTable[j * step];
+                wi = sign * fft->sinTable[j * step];
+                k = i + j + half;
+                tr = wr * re[k] - wi * im[k];
+                ti = wr * im[k] + wi * re[k];
+                re[k] = re[i + j] - tr;
+                im[k] = im[i + j] - ti;
+                re[i + j] += tr;
+                im[i + j] += ti;
+            }
+        }
+    }
+    for (; half < n; half <<= 1)
+    {
+        for (i = 0; i < n; i += 2 * half)
+        {
+            for (j = 0; j < half; j += 4)
+            {
+                memcpy(&vwr, fft->stageCos + half + j, sizeof(v4f));
+                memcpy(&vwi, fft->stageSin + half + j, sizeof(v4f));
+                vwi *= sign;
+                memcpy(&xr, re + i + j, sizeof(v4f));
+                memcpy(&xi, im + i + j, sizeof(v4f));
+                memcpy(&yr, re + i + j + half, sizeof(v4f));
+                memcpy(&yi, im + i + j + half, sizeof(v4f));
+                vtr = vwr * yr - vwi * yi;
+                vti = vwr * yi + vwi * yr;
+                yr = xr - vtr;
+                yi = xi - vti;
+                xr += vtr;
+                xi += vti;
+                memcpy(re + i + j, &xr, sizeof(v4f));
+                memcpy(im + i + j, &xi, sizeof(v4f));
+                memcpy(re + i + j + half, &yr, sizeof(v4f));
+                memcpy(im + i + j + half, &yi, sizeof(v4f));
+            }
+        }
+    }
+}
+
+void fftForward(const Fft* fft, float* re, float* im)
+{
+    fftTransform(fft, re, im, -1);
+}
+
+void fftInverse(const Fft* fft, float* re, float* im)
+{
+    float scale = 1.0f / fft->size;
+
+    fftTransform(fft, re, im, 1);
+    for (int i = 0; i < fft->size; ++i)
+    {
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
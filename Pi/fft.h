@@ -0,0 +1,51 @@
+// Date: 10/19/2026
+// Summary: Radix-2 complex FFT on split real and imaginary arrays
+
+#ifndef FFT_H
+#define FFT_H
+
+/**
+ * \brief Precomputed tables for transforms of one size
+ */
+typedef struct
+{
+    int size;           // number of points (a power of two)
+    float* cosTable;    // cos(2 pi k / size) for k < size / 2
+    float* sinTable;    // sin(2 pi k / size) for k < size / 2
+    int* reverse;       // bit-reversed index of each point
+    float* stageCos;    // cos(pi j / half) at index half + j, so each pass reads in order
+    float* stageSin;    // sin(pi j / half) at index half + j
+} Fft;
+
+/**
+ * \brief Build the tables for transforms of a given size
+ *
+ * \param fft           tables to initialize
+ * \param size          number of points (must be a power of two)
+ *
+ * \returns 0 on success, -1 if size is not a power of two or out of memory
+ */
+int fftInit(Fft* fft, int size);
+
+/**
+ * \brief Free the tables
+ */
+void fftFree(Fft* fft);
+
+/**
+ * \brief Transform a signal into its spectrum in place
+ *
+ * \param re            size real parts
+ * \param im            size imaginary parts
+ */
+void fftForward(const Fft* fft, float* re, float* im);
+
+/**
+ * \brief Transform a spectrum back into a signal in place (scaled by 1 / size)
+ *
+ * \param re            size real parts
+ * \param im            size imaginary parts
+ */
+void fftInverse(const Fft* fft, float* re, float* im);
+
+#endif
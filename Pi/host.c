@@ -0,0 +1,130 @@
+// Date: 10/19/2026
+// Summary: Loads effect plugins into a chain and bypasses any which overrun their CPU budget
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dlfcn.h>
+#include "host.h"
+
+#define MAX_SPEC 512        // longest plugin specification handled
+
+/**
+ * \brief Set the parameters listed after the path ("name=value,name=value")
+ *
+ * \returns 0 on success, -1 if a parameter is malformed or refused
+ */
+static int setParams(Plugin* plugin, char* params)
+{
+    char* name;
+    char* value;
+    int count = 0;
+
+    for (name = strtok(params, ","); name != NULL; name = strtok(NULL, ","))
+    {
+        value = strchr(name, '=');
+        if (value == NULL || ++count > HOST_MAX_PARAMS)
+        {
+            return -1;
+        }
+        *value++ = '\0';
+        if (plugin->desc->setParam(plugin->state, name, atof(value)))
+        {
+            printf("%s has no parameter %s\n", plugin->desc->name, name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int pluginLoad(Plugin* plugin, const char* spec, int channels, long long budget)
+{
+    char path[MAX_SPEC];
+    char* params;
+    const PluginDescriptor* (*entry)(void);
+
+    memset(plugin, 0, sizeof(Plugin));
+    plugin->budget = budget * 1000;
+    snprintf(path, MAX_SPEC, "%s", spec);
+    params = strchr(path, ':');
+    if (params != NULL)
+    {
+        *params++ = '\0';
+    }
+
+    plugin->library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (plugin->library == NULL)
+    {
+        printf("%s\n", dlerror());
+        return -1;
+    }
+    *(void**)&entry = dlsym(plugin->library, PLUGIN_ENTRY);
+    plugin->desc = entry != NULL ? entry() : NULL;
+    if (plugin->desc == NULL || plugin->desc->abiVersion != PLUGIN_ABI_VERSION)
+    {
+        printf("%s is not a plugin for this version of the receiver\n", path);
+        pluginUnload(plugin);
+        return -1;
+    }
+
+    plugin->state = plugin->desc->create(channels, SAMPLE_RATE, DSP_BLOCK);
+    if (plugin->state == NULL || (params != NULL && setParams(plugin, params)))
+    {
+        pluginUnload(plugin);
+        return -1;
+    }
+    return 0;
+}
+
+void pluginUnload(Plugin* plugin)
+{
+    if (plugin->state != NULL)
+    {
+        plugin->desc->destroy(plugin->state);
+        plugin->state = NULL;
+    }
+    if (plugin->library != NULL)
+    {
+        dlclose(plugin->library);
+        plugin->library = NULL;
+    }
+}
+
+/**
+ * \brief Run the plugin on one block and charge it for the CPU time
+ */
+static void pluginProcess(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Plugin* plugin = state;
+    struct timespec start, end;
+    long long used;
+
+    if (plugin->bypassed)
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    plugin->desc->process(plugin->state, channels, numChannels, frames);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+
+    used = (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+    plugin->last = used;
+    plugin->total += used;
+    plugin->worst = used > plugin->worst ? used : plugin->worst;
+    plugin->blocks++;
+
+    plugin->strikes = used > plugin->budget ? plugin->strikes + 1 : 0;
+    if (plugin->strikes >= HOST_STRIKES)
+    {
+        plugin->bypassed = 1;
+    }
+}
+
+DspProcessor pluginProcessor(Plugin* plugin)
+{
+    DspProcessor processor = {plugin->desc->name, plugin, pluginProcess,
+        plugin->desc->latency(plugin->state)};
+    return processor;
+}
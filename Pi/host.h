@@ -0,0 +1,59 @@
+// Date: 10/19/2026
+// Summary: Loads effect plugins into a chain and bypasses any which overrun their CPU budget
+
+#ifndef HOST_H
+#define HOST_H
+
+#include "plugin.h"
+#include "dsp.h"
+
+#define HOST_BUDGET 200             // default CPU time in microseconds a plugin may use per block
+#define HOST_STRIKES 8              // blocks in a row over budget before a plugin is bypassed
+#define HOST_MAX_PARAMS 8           // most parameters set from the command line per plugin
+
+/**
+ * \brief A loaded plugin instance and its CPU accounting
+ *
+ * Each block is timed with the thread's CPU clock, so time the effects thread spends
+ * preempted is not charged to the plugin.  A plugin over its budget for HOST_STRIKES blocks in
+ * a row is bypassed for good (its input passes through untouched), so one bad plugin can't
+ * make the effects thread fall behind capture.
+ */
+typedef struct
+{
+    void* library;                      // handle from dlopen
+    const PluginDescriptor* desc;       // the plugin's entry points
+    void* state;                        // the instance
+    long long budget;                   // CPU time in ns allowed per block
+    long long last;                     // CPU time in ns of the last block
+    long long worst;                    // most CPU time in ns used by a block
+    long long total;                    // CPU time in ns used by all blocks
+    size_t blocks;                      // blocks processed
+    int strikes;                        // blocks in a row over budget
+    volatile int bypassed;              // whether the plugin has been bypassed
+} Plugin;
+
+/**
+ * \brief Load a plugin and set its parameters
+ *
+ * \param plugin        plugin to load
+ * \param spec          path of the shared object, optionally followed by parameters as in
+ *                      "plugins/tone.so:cutoff=2000,q=0.7"
+ * \param channels      number of channels which will be processed
+ * \param budget        CPU time in microseconds the plugin may use per block
+ *
+ * \returns 0 on success, -1 if the plugin could not be loaded or a parameter was refused
+ */
+int pluginLoad(Plugin* plugin, const char* spec, int channels, long long budget);
+
+/**
+ * \brief Destroy the instance and unload the shared object
+ */
+void pluginUnload(Plugin* plugin);
+
+/**
+ * \brief Processor which runs the plugin with CPU accounting
+ */
+DspProcessor pluginProcessor(Plugin* plugin);
+
+#endif
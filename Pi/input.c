@@ -0,0 +1,107 @@
+// Date: 10/19/2026
+// Summary: Turns latched GPIO edge events into a queue of debounced button and switch changes
+
+#include <time.h>
+#include <unistd.h>
+#include "input.h"
+
+/**
+ * \brief Current time in microseconds
+ */
+static long long nowMicros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+/**
+ * \brief Add a change to the queue, counting it as dropped if the queue is full
+ */
+static void queueEvent(Input* in, int pin, int level, long long time)
+{
+    InputEvent event = {pin, level, time};
+    if (ringPush(&in->events, &event))
+    {
+        in->dropped++;
+    }
+}
+
+/**
+ * \brief Background thread which polls the pins forever
+ */
+static void* inputThread(void* arg)
+{
+    Input* in = arg;
+    while (1)
+    {
+        inputPoll(in, nowMicros());
+        usleep(INPUT_POLL_TIME);
+    }
+    return NULL;
+}
+
+int inputStart(Input* in, const int* pins, int numPins, int debounceTime,
+    unsigned int (*readEvents)(unsigned int), unsigned int (*readLevels)(void), int thread)
+{
+    unsigned int levels;
+
+    if (numPins > INPUT_MAX_PINS || ringInit(&in->events, sizeof(InputEvent), INPUT_QUEUE))
+    {
+        return -1;
+    }
+
+    in->numPins = numPins;
+    in->mask = 0;
+    in->debounceTime = debounceTime * 1000LL;
+    in->readEvents = readEvents;
+    in->readLevels = readLevels;
+    in->dropped = 0;
+
+    // Start from the current levels and forget any edges latched before now
+    levels = readLevels();
+    for (int i = 0; i < numPins; ++i)
+    {
+        in->pins[i] = pins[i];
+        in->mask |= 1u << pins[i];
+        in->levels[i] = (levels >> pins[i]) & 1;
+        in->lockUntil[i] = 0;
+    }
+    readEvents(in->mask);
+
+    if (thread && pthread_create(&in->thread, NULL, inputThread, in))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void inputPoll(Input* in, long long now)
+{
+    unsigned int events = in->readEvents(in->mask);
+    unsigned int levels = in->readLevels();
+    unsigned int bit;
+    int level;
+
+    for (int i = 0; i < in->numPins; ++i)
+    {
+        bit = 1u << in->pins[i];
+        level = (levels & bit) != 0;
+
+        // Ignore edges while the pin is bouncing; its level is checked again once it settles
+        if (now < in->lockUntil[i] || (level == in->levels[i] && !(events & bit)))
+        {
+            continue;
+        }
+
+        // An edge without a change in level means the pin changed and changed back between
+        // polls, so report both changes
+        if (level == in->levels[i])
+        {
+            queueEvent(in, in->pins[i], !level, now);
+        }
+        queueEvent(in, in->pins[i], level, now);
+        in->levels[i] = level;
+        in->lockUntil[i] = now + in->debounceTime;
+    }
+}
@@ -0,0 +1,79 @@
+// Date: 10/19/2026
+// Summary: Turns latched GPIO edge events into a queue of debounced button and switch changes
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <pthread.h>
+#include "ring.h"
+
+#define INPUT_MAX_PINS 8        // maximum number of pins watched by an Input
+#define INPUT_QUEUE 64          // number of events that can wait in the queue
+#define INPUT_POLL_TIME 1000    // time in microseconds between polls of the edge events
+
+/**
+ * \brief A debounced change of a pin's level
+ */
+typedef struct
+{
+    int pin;                    // GPIO pin which changed
+    int level;                  // new level of the pin
+    long long time;             // time of the change in microseconds (CLOCK_MONOTONIC)
+} InputEvent;
+
+/**
+ * \brief Watches a set of pins (all below 32) from a background thread
+ */
+typedef struct
+{
+    Ring events;                            // queue of InputEvents for the audio loop
+    int pins[INPUT_MAX_PINS];               // watched pins
+    int numPins;                            // number of watched pins
+    unsigned int mask;                      // bit mask of the watched pins
+    int levels[INPUT_MAX_PINS];             // last level reported for each pin
+    long long lockUntil[INPUT_MAX_PINS];    // time until which each pin is bouncing
+    long long debounceTime;                 // time in microseconds to ignore a pin after a change
+    unsigned int (*readEvents)(unsigned int mask);  // reads and clears latched edges
+    unsigned int (*readLevels)(void);       // reads the levels of pins 0-31
+    size_t dropped;                         // events lost because the queue was full
+    pthread_t thread;                       // thread calling inputPoll
+} Input;
+
+/**
+ * \brief Start watching pins for changes
+ *
+ * \param in            input to start
+ * \param pins          pins to watch (edge detection must already be enabled on them)
+ * \param numPins       number of pins
+ * \param debounceTime  time in miliseconds to ignore a pin after it changes
+ * \param readEvents    function which returns and clears the latched edges of the masked pins
+ * \param readLevels    function which returns the levels of pins 0-31
+ * \param thread        whether to poll from a background thread (otherwise call inputPoll)
+ *
+ * \returns 0 on success, -1 on failure
+ */
+int inputStart(Input* in, const int* pins, int numPins, int debounceTime,
+    unsigned int (*readEvents)(unsigned int), unsigned int (*readLevels)(void), int thread);
+
+/**
+ * \brief Check the pins once and queue any changes
+ *
+ * A press shorter than the poll period still latches an edge, so it is reported as a press
+ * followed immediately by a release.
+ *
+ * \param in            input to poll
+ * \param now           current time in microseconds
+ */
+void inputPoll(Input* in, long long now);
+
+/**
+ * \brief Take the oldest change from the queue (called by the audio loop)
+ *
+ * \returns 1 if event was filled, 0 if the queue is empty
+ */
+static inline int inputNext(Input* in, InputEvent* event)
+{
+    return ringPop(&in->events, event) == 0;
+}
+
+#endif
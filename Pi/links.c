@@ -0,0 +1,197 @@
+// Date: 10/19/2026
+// Summary: Decodes the SPI sample links of several FPGA boards at once from single GPIO reads
+
+#include <string.h>
+#include "links.h"
+#include "tables.h"
+
+/**
+ * \brief Lanes of the data pins set in levels
+ */
+static inline unsigned char gatherLanes(const Links* links, unsigned int levels)
+{
+    return links->gather[0][levels & 0xFF] | links->gather[1][(levels >> 8) & 0xFF]
+        | links->gather[2][(levels >> 16) & 0xFF] | links->gather[3][levels >> 24];
+}
+
+/**
+ * \brief Transpose an 8x8 matrix of bits, one row per byte (bit 8 * r + c moves to 8 * c + r)
+ */
+static inline unsigned long long transpose8(unsigned long long x)
+{
+    unsigned long long t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+int linksInit(Links* links, const LinkPins* pins, int count, int channels, unsigned int levels)
+{
+    unsigned int used = 0;
+    int g;
+
+    if (count < 1 || count > LINKS_MAX || channels < 1 || channels > 2)
+    {
+        return -1;
+    }
+    memset(links, 0, sizeof(Links));
+    links->count = count;
+    links->channels = channels;
+    links->frameBits = channels * LINKS_SAMPLE_BITS;
+    links->last = levels;
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (pins[i].mosi < 0 || pins[i].mosi > 31 || pins[i].sclk < 0 || pins[i].sclk > 31
+            || pins[i].ncs < 0 || pins[i].ncs > 31 || (used >> pins[i].mosi) & 1)
+        {
+            return -1;
+        }
+        used |= 1u << pins[i].mosi;
+
+        // Every byte value at the data pin's byte position sets the link's lane if its bit is set
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            if ((byte >> (pins[i].mosi & 7)) & 1)
+            {
+                links->gather[pins[i].mosi >> 3][byte] |= 1u << i;
+            }
+        }
+
+        // Join the group with the same clock and chip select, or start one
+        for (g = 0; g < links->numGroups; ++g)
+        {
+            if (links->groups[g].clock == 1u << pins[i].sclk
+                && links->groups[g].select == 1u << pins[i].ncs)
+            {
+                break;
+            }
+        }
+        if (g == links->numGroups)
+        {
+            links->groups[g].clock = 1u << pins[i].sclk;
+            links->groups[g].select = 1u << pins[i].ncs;
+            links->groups[g].bits = -1;
+            links->numGroups++;
+            links->watched |= links->groups[g].clock | links->groups[g].select;
+        }
+        links->groups[g].lanes |= 1u << i;
+    }
+    links->pending = links->numGroups;
+    return 0;
+}
+
+int linksEdge(Links* links, unsigned int levels)
+{
+    unsigned int rose = levels & ~links->last;
+    unsigned int fell = ~levels & links->last;
+    int lanes = -1;             // data pins gathered once for every group clocked by this read
+    int finished = 0;
+    LinkGroup* group;
+
+    links->last = levels;
+    for (int g = 0; g < links->numGroups; ++g)
+    {
+        group = &links->groups[g];
+
+        // A frame starts when the chip select falls
+        if (group->bits < 0)
+        {
+            if (fell & group->select)
+            {
+                group->bits = 0;
+                for (int b = 0; b < links->frameBits; ++b)
+                {
+                    links->slices[b] &= ~group->lanes;
+                }
+                links->failed &= ~group->lanes;
+            }
+            continue;
+        }
+
+        // Take a bit on each rising edge of the clock until the frame is full, or give up on the
+        // frame if the chip select rises first
+        if (rose & group->select)
+        {
+            links->failed |= group->lanes;
+            links->failures++;
+        }
+        else if (rose & group->clock)
+        {
+            if (lanes < 0)
+            {
+                lanes = gatherLanes(links, levels);
+            }
+            links->slices[group->bits++] |= lanes & group->lanes;
+            if (group->bits < links->frameBits)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            continue;
+        }
+        group->bits = -1;
+        if (!group->done)
+        {
+            group->done = 1;
+            finished = --links->pending == 0;
+        }
+    }
+
+    if (finished)
+    {
+        links->pending = links->numGroups;
+        for (int g = 0; g < links->numGroups; ++g)
+        {
+            links->groups[g].done = 0;
+        }
+    }
+    return finished;
+}
+
+void linksDecode(Links* links, short* frame)
+{
+    unsigned int words[LINKS_MAX] = {0};
+    unsigned long long x;
+    int blocks = (links->frameBits + 7) / 8;
+    int c, word;
+
+    // Transpose 8 slices at a time into a byte of every link, first bit highest
+    for (int k = 0; k < blocks; ++k)
+    {
+        x = 0;
+        for (int j = 0; j < 8; ++j)
+        {
+            x |= (unsigned long long)links->slices[8 * k + j] << (8 * (7 - j));
+        }
+        x = transpose8(x);
+        for (int i = 0; i < links->count; ++i)
+        {
+            words[i] = words[i] << 8 | ((x >> (8 * i)) & 0xFF);
+        }
+    }
+
+    // Convert each channel's 11-bit sign-magnitude to 16-bit 2's complement (channel 0 first),
+    // keeping the last samples of a link whose transfer failed
+    for (int i = 0; i < links->count; ++i)
+    {
+        if (!((links->failed >> i) & 1))
+        {
+            word = words[i] >> (8 * blocks - links->frameBits);
+            for (c = 0; c < links->channels; ++c)
+            {
+                links->samples[i * links->channels + c] = decodeTable[(word
+                    >> ((links->channels - 1 - c) * LINKS_SAMPLE_BITS)) & 0x7FF];
+            }
+        }
+    }
+    memcpy(frame, links->samples, links->count * links->channels * sizeof(short));
+    links->frames++;
+}
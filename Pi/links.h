@@ -0,0 +1,112 @@
+// Date: 10/19/2026
+// Summary: Decodes the SPI sample links of several FPGA boards at once from single GPIO reads
+
+#ifndef LINKS_H
+#define LINKS_H
+
+#include <stddef.h>
+
+#define LINKS_MAX 8                 // links decoded at once (one bit of a byte each)
+#define LINKS_MAX_BITS 24           // most bits in one frame of a link (rounded up to bytes)
+#define LINKS_SAMPLE_BITS 11        // bits of each sample sent by a board
+#define LINKS_SCLK 5                // default SPI clock (shared by every board)
+#define LINKS_NCS 17                // default SPI chip select (shared by every board)
+
+/**
+ * \brief GPIO pins of one board's link (all below 32, so they are in GPLEV0)
+ */
+typedef struct
+{
+    int mosi;                       // data pin (one per board)
+    int sclk;                       // clock pin (may be shared with other boards)
+    int ncs;                        // chip select pin (may be shared with other boards)
+} LinkPins;
+
+/**
+ * \brief Links sharing one clock and chip select, which are read in step
+ */
+typedef struct
+{
+    unsigned int clock;             // GPIO bit of the clock
+    unsigned int select;            // GPIO bit of the chip select
+    unsigned char lanes;            // bit i set for each link i in the group
+    int bits;                       // bits read of the current frame (-1 waiting for a frame)
+    int done;                       // whether the group has finished the current frame
+} LinkGroup;
+
+/**
+ * \brief State of the links being decoded
+ *
+ * Every poll reads all of the pins with one load of GPLEV0.  On each rising edge of a group's
+ * clock, the data pins are gathered into one byte (bit i for link i) with four table lookups
+ * and stored as the next bit slice of the frame, so the cost of a clock edge does not depend
+ * on the number of links.  Once every group has finished its frame, the slices are
+ * transposed 8 bits by 8 at a time into one word per link.
+ */
+typedef struct
+{
+    int count;                              // links
+    int channels;                           // samples in each board's frame (1 or 2)
+    int frameBits;                          // bits in each board's frame
+    unsigned char gather[4][256];           // lanes set by each byte of GPLEV0
+    LinkGroup groups[LINKS_MAX];            // links grouped by clock and chip select
+    int numGroups;                          // groups in use
+    int pending;                            // groups which have not finished the frame
+    unsigned int watched;                   // GPIO bits of every clock and chip select
+    unsigned int last;                      // levels of pins 0-31 at the last poll
+    unsigned char slices[LINKS_MAX_BITS];   // bit b of every link's frame (bit i for link i)
+    unsigned char failed;                   // lanes whose transfer ended early this frame
+    short samples[LINKS_MAX * 2];           // last good samples of every link, interleaved
+    size_t frames;                          // frames decoded
+    size_t failures;                        // transfers which ended early
+} Links;
+
+/**
+ * \brief Set up the decoding of several links
+ *
+ * \param links         links to set up
+ * \param pins          pins of each link
+ * \param count         number of links (1 to LINKS_MAX)
+ * \param channels      samples sent by each board per frame (1 or 2)
+ * \param levels        levels of pins 0-31 now
+ *
+ * \returns 0 on success, -1 if a pin is out of range or a data pin is used twice
+ */
+int linksInit(Links* links, const LinkPins* pins, int count, int channels, unsigned int levels);
+
+/**
+ * \brief Handle a change of a clock or chip select (called by linksPoll)
+ *
+ * \returns 1 if every group finished the frame, otherwise 0
+ */
+int linksEdge(Links* links, unsigned int levels);
+
+/**
+ * \brief Decode the frame which just finished
+ *
+ * \param links         links which returned 1 from linksPoll
+ * \param frame         receives count * channels interleaved samples; a link whose transfer
+ *                      ended early repeats its last good samples
+ */
+void linksDecode(Links* links, short* frame);
+
+/**
+ * \brief Take one read of pins 0-31
+ *
+ * Costs one compare unless a clock or chip select changed.
+ *
+ * \param links         links being decoded
+ * \param levels        GPLEV0
+ *
+ * \returns 1 if a frame finished and can be decoded, otherwise 0
+ */
+static inline int linksPoll(Links* links, unsigned int levels)
+{
+    if (!((levels ^ links->last) & links->watched))
+    {
+        return 0;
+    }
+    return linksEdge(links, levels);
+}
+
+#endif
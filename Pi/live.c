@@ -0,0 +1,82 @@
+// Date: 10/19/2026
+// Summary: Layout of the shared-memory segment holding the live recordings, and a reader for it
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "live.h"
+
+int liveOpen(LiveReader* reader, const char* name)
+{
+    struct stat info;
+    const LiveHeader* header;
+    void* map;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fstat(fd, &info) || (size_t)info.st_size < LIVE_HEADER)
+    {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    // Check the layout before trusting any offsets in it
+    header = map;
+    if (header->magic != LIVE_MAGIC || header->version != LIVE_VERSION
+        || header->bytes != (uint64_t)info.st_size || header->arenaOffset
+        + (uint64_t)header->arenaChunks * header->chunkSamples * sizeof(short) > header->bytes)
+    {
+        munmap(map, info.st_size);
+        return -1;
+    }
+
+    reader->header = header;
+    reader->tables = (const uint32_t*)((const char*)map + header->tableOffset);
+    reader->arena = (const short*)((const char*)map + header->arenaOffset);
+    reader->bytes = info.st_size;
+    return 0;
+}
+
+void liveClose(LiveReader* reader)
+{
+    munmap((void*)reader->header, reader->bytes);
+    reader->header = NULL;
+}
+
+void liveSnapshot(const LiveReader* reader, LiveState* state)
+{
+    LiveHeader* header = (LiveHeader*)reader->header;
+    unsigned int before, after;
+
+    do
+    {
+        before = atomic_load_explicit(&header->seq, memory_order_acquire);
+        memcpy(state, (const void*)&header->state, sizeof(*state));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&header->seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+int liveChanged(const LiveReader* reader, const LiveState* state, int recording)
+{
+    LiveState now;
+    liveSnapshot(reader, &now);
+    return now.generation[recording] != state->generation[recording];
+}
+
+float liveTempo(const LiveReader* reader, const LiveState* state)
+{
+    return state->beatFrames ? 60.0f * reader->header->sampleRate / state->beatFrames : 0;
+}
@@ -0,0 +1,165 @@
+// Date: 10/19/2026
+// Summary: Layout of the shared-memory segment holding the live recordings, and a reader for it
+
+#ifndef LIVE_H
+#define LIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define LIVE_NAME "/looper"         // default name of the segment (in /dev/shm)
+#define LIVE_MAGIC 0x4C4F4F50       // "LOOP"
+#define LIVE_VERSION 1              // changes whenever the layout changes
+#define LIVE_HEADER 4096            // bytes before the chunk tables
+#define LIVE_NO_CHUNK 0xFFFFFFFF    // table entry of a chunk which isn't in the segment
+
+// Recordings in the segment
+#define LIVE_LINEAR 0               // recording made in linear mode
+#define LIVE_LOOP 1                 // recording made in loop mode
+#define LIVE_RECORDINGS 2
+
+// Bits of LiveState.mode
+#define LIVE_LOOPING 1              // loop switch is on
+#define LIVE_RECORDING 2            // record switch is on
+#define LIVE_RUNNING 4              // start was pressed and the recording is playing or recording
+#define LIVE_COUNTING 8             // counting in before recording a loop
+#define LIVE_STRETCHING 16          // loop plays at a tempo it wasn't recorded at
+#define LIVE_TUNING 32              // in tuner mode
+
+/**
+ * \brief State of the receiver after a frame, written under the seqlock
+ */
+typedef struct
+{
+    uint64_t frame;                 // frames handled since the receiver started
+    int64_t time;                   // CLOCK_MONOTONIC time in ns at which frame was published
+    uint32_t mode;                  // LIVE_* mode bits
+    uint32_t current;               // recording of the current mode (LIVE_LINEAR or LIVE_LOOP)
+    uint64_t playIndex;             // next frame of the current recording to play
+    uint64_t loopFrames;            // frames in the loop at the current tempo (it starts at 0)
+    uint32_t beatFrames;            // frames per beat (the tempo)
+    uint32_t beatsPerMeasure;       // beats in each measure
+    uint64_t recordIndex[LIVE_RECORDINGS];  // frames stored in each recording
+    uint32_t chunks[LIVE_RECORDINGS];       // entries filled in each recording's chunk table
+    uint32_t generation[LIVE_RECORDINGS];   // changes whenever a recording's table is rewritten
+} LiveState;
+
+/**
+ * \brief Start of the segment
+ *
+ * The segment is LIVE_HEADER bytes of header, then a chunk table for each recording
+ * (arenaChunks 32-bit entries each) and then the recording arena itself, so the samples
+ * readers see are the ones the receiver records and plays.  Entry i of a recording's table is
+ * the arena chunk holding its frames i << frameShift and on, with channels interleaved samples
+ * per frame.  Chunks mapped from a saved take's file aren't in the arena and read as
+ * LIVE_NO_CHUNK.
+ *
+ * seq is odd while the receiver updates state and the tables; a reader copies state between
+ * two equal, even reads of seq.  A recording's table entries only ever change along with its
+ * generation (when it is cleared or replaced), so chunks found through a snapshot hold its
+ * frames for as long as the generation stays the same.
+ */
+typedef struct
+{
+    uint32_t magic;                 // LIVE_MAGIC
+    uint32_t version;               // LIVE_VERSION
+    uint32_t sampleRate;            // frames per second
+    uint32_t channels;              // samples in each frame
+    uint32_t frameShift;            // log2 of the number of frames per chunk
+    uint32_t chunkSamples;          // samples per chunk
+    uint32_t arenaChunks;           // chunks in the arena, and entries in each chunk table
+    uint32_t pid;                   // process ID of the receiver
+    uint64_t tableOffset;           // offset in bytes of the first chunk table
+    uint64_t arenaOffset;           // offset in bytes of the arena
+    uint64_t bytes;                 // size of the segment
+    atomic_uint seq;                // odd while state is being written
+    uint32_t reserved;              // keeps state 8-byte aligned
+    LiveState state;                // state after the latest frame
+} LiveHeader;
+
+/**
+ * \brief A read-only mapping of the segment in another process
+ */
+typedef struct
+{
+    const LiveHeader* header;       // start of the mapping
+    const uint32_t* tables;         // chunk tables, one after the other
+    const short* arena;             // first sample of the arena
+    size_t bytes;                   // length of the mapping
+} LiveReader;
+
+/**
+ * \brief Map a receiver's segment
+ *
+ * \param reader        reader to open
+ * \param name          name of the segment (such as LIVE_NAME)
+ *
+ * \returns 0 on success, -1 if there is no such segment or it has another layout version
+ */
+int liveOpen(LiveReader* reader, const char* name);
+
+/**
+ * \brief Unmap the segment
+ */
+void liveClose(LiveReader* reader);
+
+/**
+ * \brief Copy a consistent snapshot of the state, spinning while the receiver writes it
+ *
+ * Costs no system calls, so it can be polled as fast as the reader likes.
+ */
+void liveSnapshot(const LiveReader* reader, LiveState* state);
+
+/**
+ * \brief Whether a recording was cleared or replaced since a snapshot
+ *
+ * Frames read through an older snapshot may belong to something else once this returns 1, so
+ * check it after using them.
+ */
+int liveChanged(const LiveReader* reader, const LiveState* state, int recording);
+
+/**
+ * \brief Tempo in beats per minute
+ */
+float liveTempo(const LiveReader* reader, const LiveState* state);
+
+/**
+ * \brief Find frames of a recording in the segment, without copying them
+ *
+ * \param reader        mapped segment
+ * \param state         snapshot the frames are looked up in
+ * \param recording     LIVE_LINEAR or LIVE_LOOP
+ * \param frame         first frame wanted
+ * \param frames        receives the number of frames from frame on which follow it in memory
+ *                      (up to the end of its chunk or the recording), 0 if it isn't available
+ *
+ * \returns pointer to the interleaved samples of frame, or NULL if it isn't available
+ */
+static inline const short* liveFrames(const LiveReader* reader, const LiveState* state,
+    int recording, size_t frame, size_t* frames)
+{
+    const LiveHeader* header = reader->header;
+    size_t chunk = frame >> header->frameShift;
+    size_t offset = frame & (((size_t)1 << header->frameShift) - 1);
+    uint32_t index;
+
+    *frames = 0;
+    if (frame >= state->recordIndex[recording] || chunk >= state->chunks[recording])
+    {
+        return NULL;
+    }
+    index = reader->tables[recording * header->arenaChunks + chunk];
+    if (index >= header->arenaChunks)
+    {
+        return NULL;
+    }
+    *frames = ((size_t)1 << header->frameShift) - offset;
+    if (*frames > state->recordIndex[recording] - frame)
+    {
+        *frames = state->recordIndex[recording] - frame;
+    }
+    return reader->arena + (size_t)index * header->chunkSamples + offset * header->channels;
+}
+
+#endif
@@ -0,0 +1,188 @@
+// Date: 10/19/2026
+// Summary: Follows a receiver's recordings through shared memory and measures how late they arrive
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include "live.h"
+
+////////////////////////////////
+//  Constants
+////////////////////////////////
+
+#define WATCH_BUCKETS 1000      // latency histogram buckets of 1 us (later frames share the last)
+#define WATCH_REPORT 1          // time in seconds between reports
+
+////////////////////////////////
+//  Functions
+////////////////////////////////
+
+/**
+ * \brief CLOCK_MONOTONIC time in ns, the clock the receiver stamps frames with
+ */
+static long long monotonicTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * \brief Latency in us below which a fraction of the frames were seen
+ */
+static int percentile(const size_t* histogram, size_t count, float fraction)
+{
+    size_t seen = 0;
+    int i;
+
+    for (i = 0; i < WATCH_BUCKETS - 1; ++i)
+    {
+        seen += histogram[i];
+        if (seen > count * fraction)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * \brief Describe the mode bits
+ */
+static const char* modeName(uint32_t mode)
+{
+    if (mode & LIVE_TUNING)
+    {
+        return "tuner";
+    }
+    if (mode & LIVE_LOOPING)
+    {
+        return mode & LIVE_RECORDING ? "loop settings" : mode & LIVE_COUNTING ? "loop count-in"
+            : mode & LIVE_RUNNING ? "loop running" : "loop stopped";
+    }
+    return mode & LIVE_RECORDING ? (mode & LIVE_RUNNING ? "linear recording" : "linear record")
+        : mode & LIVE_RUNNING ? "linear playing" : "linear play";
+}
+
+/**
+ * \brief Print command line usage
+ */
+static void usage(const char* program)
+{
+    printf("usage: %s [options]\n", program);
+    printf("  -l, --live NAME   segment given to the receiver's --live (default %s)\n",
+        LIVE_NAME);
+    printf("  -t, --time S      stop after S seconds (default 0 to run until interrupted)\n");
+    printf("  -p, --poll US     sleep US between polls instead of spinning (default 0)\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* name = LIVE_NAME;
+    float duration = 0;
+    int poll = 0;
+    static struct option options[] = {
+        {"live", required_argument, NULL, 'l'},
+        {"time", required_argument, NULL, 't'},
+        {"poll", required_argument, NULL, 'p'},
+        {NULL, 0, NULL, 0}
+    };
+    static size_t histogram[WATCH_BUCKETS];
+    LiveReader reader;
+    LiveState state;
+    const short* samples;
+    size_t frames, updates = 0, skipped = 0, lastRecorded = 0;
+    uint64_t lastFrame = 0;
+    uint32_t lastCurrent = LIVE_LINEAR;
+    long long now, start, nextReport, latency, worst = 0;
+    int option, peak = 0, c;
+
+    while ((option = getopt_long(argc, argv, "l:t:p:", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+            case 'l': name = optarg; break;
+            case 't': duration = atof(optarg); break;
+            case 'p': poll = atoi(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (liveOpen(&reader, name))
+    {
+        printf("can't map %s (is the receiver running with --live %s?)\n", name, name);
+        return 1;
+    }
+    printf("following receiver %u: %u channel%s, %u chunks of %u samples\n",
+        reader.header->pid, reader.header->channels, reader.header->channels > 1 ? "s" : "",
+        reader.header->arenaChunks, reader.header->chunkSamples);
+
+    liveSnapshot(&reader, &state);
+    lastFrame = state.frame;
+    start = monotonicTime();
+    nextReport = start + WATCH_REPORT * 1000000000LL;
+    while (duration <= 0 || monotonicTime() - start < duration * 1e9)
+    {
+        // Time how long each new frame took to show up after the receiver published it
+        liveSnapshot(&reader, &state);
+        now = monotonicTime();
+        if (state.frame != lastFrame)
+        {
+            latency = now - state.time;
+            histogram[latency / 1000 < WATCH_BUCKETS ? latency / 1000 : WATCH_BUCKETS - 1]++;
+            worst = latency > worst ? latency : worst;
+            skipped += state.frame - lastFrame - 1;
+            lastFrame = state.frame;
+            updates++;
+
+            // Read the newest recorded frames straight out of the arena, starting over when
+            // the mode's recording changes
+            if (state.current != lastCurrent || state.recordIndex[state.current] < lastRecorded)
+            {
+                lastCurrent = state.current;
+                lastRecorded = state.recordIndex[state.current];
+            }
+            samples = liveFrames(&reader, &state, state.current, lastRecorded, &frames);
+            for (c = 0; c < (int)(frames * reader.header->channels); ++c)
+            {
+                peak = abs(samples[c]) > peak ? abs(samples[c]) : peak;
+            }
+            lastRecorded += frames;
+        }
+
+        if (now >= nextReport)
+        {
+            if (updates == 0)
+            {
+                printf("waiting for frames from the receiver\n");
+            }
+            else
+            {
+                printf("%s: linear %.1f s, loop %.1f s, %.0f BPM, peak %d; %zu frames seen, "
+                    "%zu skipped, latency %d us median, %d us 99%%, %.1f us worst\n",
+                    modeName(state.mode),
+                    (float)state.recordIndex[LIVE_LINEAR] / reader.header->sampleRate,
+                    (float)state.recordIndex[LIVE_LOOP] / reader.header->sampleRate,
+                    liveTempo(&reader, &state), peak, updates, skipped,
+                    percentile(histogram, updates, 0.5f), percentile(histogram, updates, 0.99f),
+                    worst / 1000.0f);
+            }
+            fflush(stdout);
+            memset(histogram, 0, sizeof(histogram));
+            updates = skipped = 0;
+            worst = 0;
+            peak = 0;
+            nextReport += WATCH_REPORT * 1000000000LL;
+        }
+        if (poll > 0)
+        {
+            usleep(poll);
+        }
+    }
+
+    liveClose(&reader);
+    return 0;
+}
@@ -0,0 +1,556 @@
+// Date: 10/19/2026
+// Summary: Real-time-safe logging: binary records in per-thread rings, formatted by a drain thread
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "logger.h"
+#include "ring.h"
+
+////////////////////////////////
+//  Types and State
+////////////////////////////////
+
+/**
+ * \brief Ring of one logging thread
+ */
+typedef struct
+{
+    Ring records;                   // LogRecords waiting to be printed
+    atomic_size_t dropped;          // records lost because the ring was full
+} LogRing;
+
+/**
+ * \brief Size of an integer argument, from its length modifier
+ */
+typedef enum
+{
+    LOG_INT, LOG_CHAR, LOG_SHORT, LOG_LONG, LOG_LONG_LONG, LOG_SIZE, LOG_INTMAX, LOG_PTRDIFF,
+    LOG_LONG_DOUBLE
+} LogLength;
+
+static FILE* logFile;                           // file the drain thread prints to
+static atomic_int started;                      // whether the drain thread is running
+static pthread_t drainThread;                   // thread formatting and printing records
+static LogRing* rings[LOG_THREADS];             // ring of each thread which has logged
+static atomic_int numRings;                     // entries of rings claimed
+static atomic_int readyRings;                   // entries of rings which can be read
+static atomic_size_t lostThreads;               // records lost because rings was full
+static atomic_size_t printed;                   // records printed
+static _Thread_local LogRing* threadRing;       // ring of the calling thread
+
+////////////////////////////////
+//  Formats
+////////////////////////////////
+
+/**
+ * \brief Skip the flags, width, precision and length of a conversion
+ *
+ * \param spec          first character after the '%'
+ * \param length        receives the length modifier
+ * \param stars         receives the number of '*' widths and precisions
+ *
+ * \returns pointer to the conversion character
+ */
+static const char* skipSpec(const char* spec, LogLength* length, int* stars)
+{
+    *stars = 0;
+    while (*spec == '-' || *spec == '+' || *spec == ' ' || *spec == '#' || *spec == '0')
+    {
+        ++spec;
+    }
+    if (*spec == '*')
+    {
+        ++*stars;
+        ++spec;
+    }
+    while (*spec >= '0' && *spec <= '9')
+    {
+        ++spec;
+    }
+    if (*spec == '.')
+    {
+        ++spec;
+        if (*spec == '*')
+        {
+            ++*stars;
+            ++spec;
+        }
+        while (*spec >= '0' && *spec <= '9')
+        {
+            ++spec;
+        }
+    }
+
+    *length = LOG_INT;
+    switch (*spec)
+    {
+        case 'h':
+            *length = spec[1] == 'h' ? LOG_CHAR : LOG_SHORT;
+            spec += 1 + (spec[1] == 'h');
+            break;
+        case 'l':
+            *length = spec[1] == 'l' ? LOG_LONG_LONG : LOG_LONG;
+            spec += 1 + (spec[1] == 'l');
+            break;
+        case 'z': *length = LOG_SIZE; ++spec; break;
+        case 'j': *length = LOG_INTMAX; ++spec; break;
+        case 't': *length = LOG_PTRDIFF; ++spec; break;
+        case 'L': *length = LOG_LONG_DOUBLE; ++spec; break;
+    }
+    return spec;
+}
+
+/**
+ * \brief Copy an argument into a record
+ *
+ * \returns 0 on success, -1 if it doesn't fit
+ */
+static inline int putArg(LogRecord* record, const void* arg, size_t bytes)
+{
+    if (record->used + bytes > LOG_ARGS)
+    {
+        return -1;
+    }
+    memcpy(record->args + record->used, arg, bytes);
+    record->used += bytes;
+    return 0;
+}
+
+/**
+ * \brief Copy the arguments used by a format into a record
+ */
+static void putArgs(LogRecord* record, const char* format, va_list args)
+{
+    const char* spec = format;
+    const char* string;
+    LogLength length;
+    long long integer;
+    double real;
+    void* pointer;
+    size_t bytes;
+    int stars, star;
+
+    record->used = 0;
+    record->complete = 0;
+    while ((spec = strchr(spec, '%')) != NULL)
+    {
+        spec = skipSpec(spec + 1, &length, &stars);
+        for (int i = 0; i < stars; ++i)
+        {
+            star = va_arg(args, int);
+            if (putArg(record, &star, sizeof(star)))
+            {
+                return;
+            }
+        }
+
+        // Integers are widened to 8 bytes, which the drain thread formats with "ll"
+        switch (*spec++)
+        {
+            case 'd': case 'i': case 'c':
+                switch (length)
+                {
+                    case LOG_CHAR: integer = (signed char)va_arg(args, int); break;
+                    case LOG_SHORT: integer = (short)va_arg(args, int); break;
+                    case LOG_LONG: integer = va_arg(args, long); break;
+                    case LOG_LONG_LONG: integer = va_arg(args, long long); break;
+                    case LOG_SIZE: integer = va_arg(args, ssize_t); break;
+                    case LOG_INTMAX: integer = va_arg(args, intmax_t); break;
+                    case LOG_PTRDIFF: integer = va_arg(args, ptrdiff_t); break;
+                    default: integer = va_arg(args, int); break;
+                }
+                if (putArg(record, &integer, sizeof(integer)))
+                {
+                    return;
+                }
+                break;
+
+            case 'u': case 'o': case 'x': case 'X':
+                switch (length)
+                {
+                    case LOG_CHAR: integer = (unsigned char)va_arg(args, unsigned int); break;
+                    case LOG_SHORT: integer = (unsigned short)va_arg(args, unsigned int); break;
+                    case LOG_LONG: integer = va_arg(args, unsigned long); break;
+                    case LOG_LONG_LONG: integer = va_arg(args, unsigned long long); break;
+                    case LOG_SIZE: integer = va_arg(args, size_t); break;
+                    case LOG_INTMAX: integer = va_arg(args, uintmax_t); break;
+                    case LOG_PTRDIFF: integer = va_arg(args, ptrdiff_t); break;
+                    default: integer = va_arg(args, unsigned int); break;
+                }
+                if (putArg(record, &integer, sizeof(integer)))
+                {
+                    return;
+                }
+                break;
+
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                real = length == LOG_LONG_DOUBLE ? (double)va_arg(args, long double)
+                    : va_arg(args, double);
+                if (putArg(record, &real, sizeof(real)))
+                {
+                    return;
+                }
+                break;
+
+            case 's':
+                string = va_arg(args, const char*);
+                bytes = strlen(string) + 1;
+                if (record->used + bytes > LOG_ARGS)
+                {
+                    // Keep as much of the string as fits
+                    if (record->used < LOG_ARGS)
+                    {
+                        memcpy(record->args + record->used, string, LOG_ARGS - record->used - 1);
+                        record->args[LOG_ARGS - 1] = '\0';
+                        record->used = LOG_ARGS;
+                    }
+                    return;
+                }
+                putArg(record, string, bytes);
+                break;
+
+            case 'p':
+                pointer = va_arg(args, void*);
+                if (putArg(record, &pointer, sizeof(pointer)))
+                {
+                    return;
+                }
+                break;
+
+            case '\0':
+                --spec;
+                break;
+        }
+    }
+    record->complete = 1;
+}
+
+/**
+ * \brief Take the next argument of a record
+ *
+ * \returns pointer to the argument, or NULL if the record ran out
+ */
+static const void* takeArg(const LogRecord* record, unsigned int* offset, size_t bytes)
+{
+    const void* arg = record->args + *offset;
+    if (*offset + bytes > record->used)
+    {
+        return NULL;
+    }
+    *offset += bytes;
+    return arg;
+}
+
+/**
+ * \brief Format a record into text
+ *
+ * \param record        record to format
+ * \param line          receives the text
+ * \param size          bytes available in line
+ *
+ * \returns length of the text
+ */
+static size_t formatRecord(const LogRecord* record, char* line, size_t size)
+{
+    const char* text = record->format;
+    const char* spec;
+    const char* end;
+    const void* arg;
+    char conversion[32];
+    size_t length = 0, piece;
+    unsigned int offset = 0;
+    LogLength modifier;
+    long long integer;
+    double real;
+    int stars, star, written;
+
+    while (*text != '\0' && length < size - 1)
+    {
+        // Copy text up to the next conversion
+        spec = strchr(text, '%');
+        piece = spec == NULL ? strlen(text) : (size_t)(spec - text);
+        piece = piece < size - 1 - length ? piece : size - 1 - length;
+        memcpy(line + length, text, piece);
+        length += piece;
+        if (spec == NULL)
+        {
+            break;
+        }
+        end = skipSpec(spec + 1, &modifier, &stars);
+        text = *end == '\0' ? end : end + 1;
+        if (*end == '%')
+        {
+            line[length++] = '%';
+            continue;
+        }
+
+        // Rebuild the conversion with the stored widths written out and the integer length
+        // modifier replaced by "ll"
+        written = 0;
+        for (const char* c = spec; c < end && written < (int)sizeof(conversion) - 16; ++c)
+        {
+            if (*c == '*')
+            {
+                if ((arg = takeArg(record, &offset, sizeof(int))) == NULL)
+                {
+                    break;
+                }
+                memcpy(&star, arg, sizeof(star));
+                written += snprintf(conversion + written, sizeof(conversion) - written, "%d",
+                    star);
+            }
+            else if (strchr("hlzjtL", *c) == NULL)
+            {
+                conversion[written++] = *c;
+            }
+        }
+        arg = NULL;
+        switch (*end)
+        {
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+                conversion[written++] = 'l';
+                conversion[written++] = 'l';
+                // fall through
+            case 'c':
+                conversion[written++] = *end;
+                conversion[written] = '\0';
+                if ((arg = takeArg(record, &offset, sizeof(integer))) != NULL)
+                {
+                    memcpy(&integer, arg, sizeof(integer));
+                    written = *end == 'c' ? snprintf(line + length, size - length, conversion,
+                        (int)integer) : snprintf(line + length, size - length, conversion,
+                        integer);
+                }
+                break;
+
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                conversion[written++] = *end;
+                conversion[written] = '\0';
+                if ((arg = takeArg(record, &offset, sizeof(real))) != NULL)
+                {
+                    memcpy(&real, arg, sizeof(real));
+                    written = snprintf(line + length, size - length, conversion, real);
+                }
+                break;
+
+            case 's':
+                conversion[written++] = 's';
+                conversion[written] = '\0';
+                if (offset < record->used)
+                {
+                    arg = record->args + offset;
+                    offset += strlen(arg) + 1;
+                    written = snprintf(line + length, size - length, conversion, (const char*)arg);
+                }
+                break;
+
+            case 'p':
+                if ((arg = takeArg(record, &offset, sizeof(void*))) != NULL)
+                {
+                    written = snprintf(line + length, size - length, "%p", *(void* const*)arg);
+                }
+                break;
+        }
+
+        // Stop at the first argument which didn't fit
+        if (arg == NULL)
+        {
+            break;
+        }
+        length += (size_t)written < size - length ? (size_t)written : size - 1 - length;
+    }
+
+    // Mark a record whose arguments were cut short at the end of its line
+    if (!record->complete)
+    {
+        length -= length > 0 && line[length - 1] == '\n';
+        length += snprintf(line + length, size - length, "...\n");
+        length = length < size ? length : size - 1;
+    }
+    line[length] = '\0';
+    return length;
+}
+
+////////////////////////////////
+//  Threads
+////////////////////////////////
+
+/**
+ * \brief Print records from every ring in the order they were logged
+ */
+static void* logThread(void* arg)
+{
+    static LogRecord pending[LOG_THREADS];      // oldest record of each ring
+    static int hasPending[LOG_THREADS];         // whether pending holds a record
+    static char line[LOG_LINE];
+    size_t reported = 0, dropped, lines;
+    int count, oldest;
+
+    (void)arg;
+    while (1)
+    {
+        // Repeatedly print the oldest of the records at the front of the rings
+        count = atomic_load_explicit(&readyRings, memory_order_acquire);
+        oldest = 0;
+        lines = 0;
+        while (oldest >= 0)
+        {
+            oldest = -1;
+            for (int i = 0; i < count; ++i)
+            {
+                if (!hasPending[i])
+                {
+                    hasPending[i] = !ringPop(&rings[i]->records, &pending[i]);
+                }
+                if (hasPending[i] && (oldest < 0 || pending[i].time < pending[oldest].time))
+                {
+                    oldest = i;
+                }
+            }
+            if (oldest >= 0)
+            {
+                fwrite(line, 1, formatRecord(&pending[oldest], line, sizeof(line)), logFile);
+                hasPending[oldest] = 0;
+                lines++;
+            }
+        }
+
+        dropped = logDropped();
+        if (dropped != reported)
+        {
+            fprintf(logFile, "log: %zu records dropped\n", dropped - reported);
+            reported = dropped;
+        }
+        fflush(logFile);
+        atomic_fetch_add_explicit(&printed, lines, memory_order_release);
+        usleep(LOG_DRAIN_TIME);
+    }
+    return NULL;
+}
+
+/**
+ * \brief Give the calling thread a ring
+ *
+ * \returns the ring, or NULL if too many threads log or it can't be allocated
+ */
+static LogRing* logRegister(void)
+{
+    LogRing* ring;
+    int index;
+
+    // Build the ring before claiming a slot, since every claimed slot must be published for
+    // the threads which claim later ones to get past the wait below
+    if (atomic_load(&numRings) >= LOG_THREADS || (ring = malloc(sizeof(LogRing))) == NULL)
+    {
+        return NULL;
+    }
+    if (ringInit(&ring->records, sizeof(LogRecord), LOG_RECORDS))
+    {
+        free(ring);
+        return NULL;
+    }
+    atomic_init(&ring->dropped, 0);
+    index = atomic_fetch_add(&numRings, 1);
+    if (index >= LOG_THREADS)
+    {
+        ringFree(&ring->records);
+        free(ring);
+        return NULL;
+    }
+    rings[index] = ring;
+
+    // Rings become readable in the order they were claimed, so wait for earlier ones
+    while (atomic_load(&readyRings) != index)
+    {
+        usleep(10);
+    }
+    atomic_store_explicit(&readyRings, index + 1, memory_order_release);
+    return threadRing = ring;
+}
+
+////////////////////////////////
+//  Functions
+////////////////////////////////
+
+int logInit(FILE* file)
+{
+    logFile = file;
+    if (pthread_create(&drainThread, NULL, logThread, NULL))
+    {
+        return -1;
+    }
+    atomic_store(&started, 1);
+    return 0;
+}
+
+void logPrint(const char* format, ...)
+{
+    LogRing* ring = threadRing;
+    struct timespec now;
+    LogRecord* record;
+    va_list args;
+
+    va_start(args, format);
+    if (!atomic_load_explicit(&started, memory_order_relaxed))
+    {
+        vprintf(format, args);
+    }
+    else if (ring == NULL && (ring = logRegister()) == NULL)
+    {
+        atomic_fetch_add_explicit(&lostThreads, 1, memory_order_relaxed);
+    }
+    else if ((record = ringReserve(&ring->records)) == NULL)
+    {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+    }
+    else
+    {
+        // The coarse clock is read from memory without touching the counter, and its
+        // resolution is plenty to interleave the threads' messages
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        record->time = now.tv_sec * 1000000000LL + now.tv_nsec;
+        record->format = format;
+        putArgs(record, format, args);
+        ringCommit(&ring->records);
+    }
+    va_end(args);
+}
+
+void logFlush(void)
+{
+    size_t logged;
+
+    if (!atomic_load(&started))
+    {
+        fflush(stdout);
+        return;
+    }
+
+    // Everything logged so far has been printed once printed catches up with it
+    do
+    {
+        logged = 0;
+        for (int i = 0; i < atomic_load(&readyRings); ++i)
+        {
+            logged += atomic_load(&rings[i]->records.head);
+        }
+        usleep(1000);
+    } while (atomic_load_explicit(&printed, memory_order_acquire) < logged);
+}
+
+size_t logDropped(void)
+{
+    size_t dropped = atomic_load_explicit(&lostThreads, memory_order_relaxed);
+    for (int i = 0; i < atomic_load_explicit(&readyRings, memory_order_acquire); ++i)
+    {
+        dropped += atomic_load_explicit(&rings[i]->dropped, memory_order_relaxed);
+    }
+    return dropped;
+}
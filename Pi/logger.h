@@ -0,0 +1,64 @@
+// Date: 10/19/2026
+// Summary: Real-time-safe logging: binary records in per-thread rings, formatted by a drain thread
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define LOG_RECORDS 256             // records which can wait in each thread's ring
+#define LOG_ARGS 104                // bytes of arguments held by a record
+#define LOG_THREADS 16              // most threads which can log
+#define LOG_LINE 512                // longest line printed (longer lines are cut)
+#define LOG_DRAIN_TIME 10000        // time in microseconds between checks for records to print
+
+/**
+ * \brief A call to logPrint waiting to be formatted
+ *
+ * The format is kept by pointer, so it must be a string literal (or otherwise outlive the
+ * record).  Integers are widened to 8 bytes, floating point values are stored as doubles and
+ * strings are copied with their terminator, cut short if they don't fit.
+ */
+typedef struct
+{
+    long long time;                 // time of the call in ns (CLOCK_MONOTONIC)
+    const char* format;             // printf format
+    unsigned int used;              // bytes of args filled
+    unsigned int complete;          // whether every argument fit
+    unsigned char args[LOG_ARGS];   // arguments in the order the format uses them
+} LogRecord;
+
+/**
+ * \brief Start the thread which prints logged records
+ *
+ * Until this is called, logPrint prints straight to stdout.
+ *
+ * \param file          file to print to (such as stdout)
+ *
+ * \returns 0 on success, -1 if the thread could not start
+ */
+int logInit(FILE* file);
+
+/**
+ * \brief Log a message with printf formatting without blocking
+ *
+ * Costs a timestamp, a scan of the format and a copy of the arguments into the calling
+ * thread's ring; the text is formatted and written by the drain thread.  A thread's first call
+ * allocates its ring, so threads which log from a real-time loop should log once before it
+ * starts.  When the ring is full (or LOG_THREADS threads already log) the record is dropped and
+ * counted, and the drain thread reports the drops.  The "n" conversion is not supported.
+ */
+void logPrint(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * \brief Wait until every record logged so far has been printed
+ */
+void logFlush(void);
+
+/**
+ * \brief Number of records dropped because a ring was full
+ */
+size_t logDropped(void);
+
+#endif
@@ -0,0 +1,177 @@
+// Date: 10/19/2026
+// Summary: Writes a pin trace of a loop being recorded and then played at a new tempo, which
+//          make test replays to check that the loop is stretched rather than recorded again
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "trace.h"
+
+#define NCS 17              // SPI chip select
+#define MOSI 22             // SPI master out slave in
+#define SCLK 5              // SPI clock
+#define PIN_RECORD 18       // switch to determine play or record mode
+#define PIN_LOOP 23         // switch to put in loop mode
+#define PIN_START 24        // pushbutton to start/stop play or record
+#define PIN_RESET 25        // pushbutton to reset play or record
+#define PIN_SAVE 12         // pushbutton to save recording
+
+#define FRAME_BITS 11       // bits the FPGA sends per frame (one channel)
+#define FRAME_NS 20833      // time in nanoseconds between frames (48 kHz)
+#define SCLK_NS 800         // period of SCLK in nanoseconds
+#define READ_NS 55          // shortest time in nanoseconds taken by a read of a pin
+#define READ_JITTER 40      // most extra time in nanoseconds taken by a read of a pin
+#define PROCESS_NS 4000     // time in nanoseconds the receiver spends on each frame
+#define PRESS_TIME 100      // time in miliseconds a button is held
+#define START_TIME 1000     // time in seconds the simulated clock starts at
+#define TONE 220.0          // frequency in Hz of the tone sent as the input
+
+/**
+ * \brief Change to one of the user interface pins at a time in the trace
+ */
+typedef struct
+{
+    int time;               // time in miliseconds since the start of the trace
+    int pin;                // GPIO number of the pin
+    int level;              // level after the change
+} Step;
+
+// Loop mode, then: record a loop (reset), enter settings mode, tap a new tempo 600 ms apart
+// (24000 frames per beat to 28800) and leave settings mode to play the loop at it.  Replayed
+// with --count-in 1 --beats 2, the loop is 4 s long and finished by 5 s.
+static const Step steps[] =
+{
+    {300, PIN_RESET, 1}, {300 + PRESS_TIME, PIN_RESET, 0},
+    {5500, PIN_RECORD, 1},
+    {6000, PIN_START, 1}, {6000 + PRESS_TIME, PIN_START, 0},
+    {6600, PIN_START, 1}, {6600 + PRESS_TIME, PIN_START, 0},
+    {7000, PIN_RECORD, 0},
+};
+#define STEPS (sizeof(steps) / sizeof(steps[0]))
+#define END_TIME 8000       // time in miliseconds at which the trace ends
+
+static const int pins[TRACE_PINS] = {NCS, SCLK, MOSI, PIN_RECORD, PIN_LOOP, PIN_START, PIN_RESET,
+    PIN_SAVE};
+
+static Trace trace;         // trace being written
+static long long now;       // simulated time in nanoseconds since the start of the trace
+
+/**
+ * \brief Time read by the trace, taken from the simulation instead of the clock (linked with
+ *        -Wl,--wrap=clock_gettime)
+ */
+int __wrap_clock_gettime(clockid_t clock, struct timespec* time)
+{
+    (void)clock;
+    time->tv_sec = START_TIME + now / 1000000000;
+    time->tv_nsec = now % 1000000000;
+    return 0;
+}
+
+/**
+ * \brief Level of an SPI pin sent by the FPGA at the current time
+ *
+ * \param index     index of the pin in the trace (NCS, SCLK or MOSI)
+ */
+static int level(int index)
+{
+    long long frame = now / FRAME_NS;
+    int cycle = (now % FRAME_NS) / SCLK_NS;
+    int phase = (now % FRAME_NS) % SCLK_NS;
+    double sample;
+    int word;
+
+    if (index == 0)
+    {
+        return cycle >= FRAME_BITS;
+    }
+    if (index == 1)
+    {
+        return phase < SCLK_NS / 2;
+    }
+
+    // MOSI holds each bit of the 11-bit sign-magnitude sample for one cycle of SCLK
+    sample = 0.3 * sin(2 * M_PI * TONE * frame / 48000);
+    word = (sample < 0 ? 0x400 : 0) | (int)(fabs(sample) * 1023);
+    return cycle < FRAME_BITS ? (word >> (FRAME_BITS - 1 - cycle)) & 1 : 0;
+}
+
+/**
+ * \brief Read an SPI pin as the receiver does, noting it in the trace
+ */
+static int readPin(int index)
+{
+    int value;
+
+    now += READ_NS + rand() % READ_JITTER;
+    value = level(index);
+    traceRead(&trace, index, value);
+    return value;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: %s TRACE\n", argv[0]);
+        return 1;
+    }
+
+    unsigned int levels = (1u << NCS) | (1u << PIN_LOOP);
+    if (traceStart(&trace, argv[1], pins, levels))
+    {
+        printf("can't write the trace to %s\n", argv[1]);
+        return 1;
+    }
+
+    // Poll the SPI pins as the receiver's audio loop does, changing the UI pins between frames
+    size_t step = 0;
+    int lastNCS = readPin(0);
+    int curNCS;
+    int lastSCLK = 0;
+    int curSCLK;
+    int reading = 0;
+    int bitsIn = 0;
+    srand(1);
+    while (now < END_TIME * 1000000LL)
+    {
+        curNCS = readPin(0);
+        if (reading)
+        {
+            curSCLK = readPin(1);
+            if (!lastSCLK && curSCLK)
+            {
+                readPin(2);
+                if (curNCS || ++bitsIn >= FRAME_BITS)
+                {
+                    reading = 0;
+                    bitsIn = 0;
+                    now += PROCESS_NS;
+                }
+            }
+            lastSCLK = curSCLK;
+        }
+        else if (lastNCS && !curNCS)
+        {
+            traceFrame(&trace);
+            for (; step < STEPS && now >= steps[step].time * 1000000LL; ++step)
+            {
+                levels &= ~(1u << steps[step].pin);
+                levels |= (unsigned int)steps[step].level << steps[step].pin;
+                traceInput(&trace, 1u << steps[step].pin, levels);
+            }
+            reading = 1;
+            lastSCLK = readPin(1);
+        }
+        lastNCS = curNCS;
+    }
+
+    traceStop(&trace);
+    if (trace.dropped)
+    {
+        printf("can't write the trace to %s: %zu chunks dropped\n", argv[1], trace.dropped);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Date: 10/19/2026
+// Summary: Metronome which plays pre-rendered click wavetables on the sample clock
+
+#include <math.h>
+#include "metronome.h"
+#include "audio.h"
+#include "wav.h"
+
+// Click wavetables: a decaying sine, with a silent sample after the end of each click
+#define ACCENT_LENGTH (SAMPLE_RATE * 40 / 1000)
+#define BEAT_LENGTH (SAMPLE_RATE * 30 / 1000)
+#define SUBDIVISION_LENGTH (SAMPLE_RATE * 15 / 1000)
+
+static short accent[ACCENT_LENGTH + 1];
+static short beat[BEAT_LENGTH + 1];
+static short subdivision[SUBDIVISION_LENGTH + 1];
+static const short silence[1] = {0};
+
+/**
+ * \brief Render a click into a wavetable
+ *
+ * \param table         wavetable with room for length + 1 samples
+ * \param length        number of samples in the click
+ * \param frequency     pitch of the click in Hz
+ * \param volume        peak volume (as a fraction of max volume)
+ */
+static void renderClick(short* table, size_t length, float frequency, float volume)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        // Decay to about 1% by the end of the click
+        table[i] = (short)(32767 * volume * sinf(2 * M_PI * frequency * i / SAMPLE_RATE)
+            * expf(-4.6f * i / length));
+    }
+    table[length] = 0;
+}
+
+/**
+ * \brief Start the click for the current tick
+ */
+static void playTick(Metronome* m)
+{
+    if (m->tick > 0)
+    {
+        m->voice = subdivision;
+        m->voiceLength = SUBDIVISION_LENGTH;
+    }
+    else if (m->beat > 0)
+    {
+        m->voice = beat;
+        m->voiceLength = BEAT_LENGTH;
+    }
+    else
+    {
+        m->voice = accent;
+        m->voiceLength = ACCENT_LENGTH;
+    }
+    m->voiceIndex = 0;
+}
+
+void metronomeInit(Metronome* m, size_t beatTime, int beatsPerMeasure, int subdivisions)
+{
+    renderClick(accent, ACCENT_LENGTH, 1760, 0.5f);
+    renderClick(beat, BEAT_LENGTH, 880, 0.4f);
+    renderClick(subdivision, SUBDIVISION_LENGTH, 880, 0.2f);
+
+    m->beatsPerMeasure = beatsPerMeasure > 0 ? beatsPerMeasure : 1;
+    m->subdivisions = subdivisions > 0 ? subdivisions : 1;
+    m->counter = 0;
+    m->tick = 0;
+    m->beat = 0;
+    metronomeSetTempo(m, beatTime);
+    metronomeStop(m);
+}
+
+/**
+ * \brief Set the length of the current tick
+ *
+ * Tick k of a beat starts k * beatTime / subdivisions frames into it, so when the beat doesn't
+ * divide evenly the ticks take turns being a frame longer and the beats never drift.
+ */
+static void tickLength(Metronome* m)
+{
+    m->tickTime = (m->tick + 1) * m->beatTime / m->subdivisions
+        - m->tick * m->beatTime / m->subdivisions;
+    if (m->tickTime == 0)
+    {
+        m->tickTime = 1;
+    }
+}
+
+void metronomeSetTempo(Metronome* m, size_t beatTime)
+{
+    m->beatTime = beatTime;
+    tickLength(m);
+}
+
+void metronomeStart(Metronome* m)
+{
+    m->counter = 0;
+    m->tick = 0;
+    m->beat = 0;
+    tickLength(m);
+    playTick(m);
+}
+
+void metronomeStop(Metronome* m)
+{
+    m->voice = silence;
+    m->voiceLength = 0;
+    m->voiceIndex = 0;
+}
+
+void metronomeTick(Metronome* m)
+{
+    m->counter = 0;
+    if (++m->tick >= m->subdivisions)
+    {
+        m->tick = 0;
+        m->beat = (m->beat + 1) % m->beatsPerMeasure;
+    }
+    tickLength(m);
+
+    // Keep ticking silently after metronomeStop
+    if (m->voice != silence)
+    {
+        playTick(m);
+    }
+}
+
+void metronomeMix(Metronome* m, short* block, size_t frames)
+{
+    size_t span;
+    size_t clicks;
+
+    while (frames > 0)
+    {
+        if (m->counter >= m->tickTime)
+        {
+            metronomeTick(m);
+        }
+
+        // Frames until the next tick, of which the first few may still hold part of a click
+        span = m->tickTime - m->counter;
+        span = span < frames ? span : frames;
+        clicks = m->voiceLength - m->voiceIndex;
+        clicks = clicks < span ? clicks : span;
+
+        mixSaturate(block, m->voice + m->voiceIndex, clicks);
+        m->voiceIndex += clicks;
+        m->counter += span;
+        block += span;
+        frames -= span;
+
+        if (m->counter >= m->tickTime)
+        {
+            metronomeTick(m);
+        }
+    }
+}
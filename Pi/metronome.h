@@ -0,0 +1,96 @@
+// Date: 10/19/2026
+// Summary: Metronome which plays pre-rendered click wavetables on the sample clock
+
+#ifndef METRONOME_H
+#define METRONOME_H
+
+#include <stddef.h>
+
+/**
+ * \brief State of a metronome
+ *
+ * Each beat is split into subdivisions ("ticks").  The first tick of a measure plays the
+ * accent click, the first tick of every other beat plays the beat click, and the remaining
+ * ticks play a quieter subdivision click.
+ */
+typedef struct
+{
+    const short* voice;     // wavetable being played (ends with a silent sample)
+    size_t voiceLength;     // index of the silent sample at the end of voice
+    size_t voiceIndex;      // next sample of voice to play
+    size_t beatTime;        // frames per beat
+    size_t tickTime;        // frames in the current subdivision (they differ by at most one)
+    size_t counter;         // frames since the start of the current tick
+    int tick;               // subdivision within the current beat
+    int beat;               // beat within the current measure
+    int beatsPerMeasure;    // time signature numerator
+    int subdivisions;       // ticks per beat
+} Metronome;
+
+/**
+ * \brief Render the click wavetables and initialize a silent metronome
+ *
+ * \param m                 metronome to initialize
+ * \param beatTime          frames per beat
+ * \param beatsPerMeasure   beats in each measure (the first is accented)
+ * \param subdivisions      ticks per beat (1 for no subdivisions)
+ */
+void metronomeInit(Metronome* m, size_t beatTime, int beatsPerMeasure, int subdivisions);
+
+/**
+ * \brief Change the tempo, taking effect from the next tick
+ */
+void metronomeSetTempo(Metronome* m, size_t beatTime);
+
+/**
+ * \brief Start the metronome on the downbeat of a measure
+ */
+void metronomeStart(Metronome* m);
+
+/**
+ * \brief Silence the metronome
+ */
+void metronomeStop(Metronome* m);
+
+/**
+ * \brief Advance to the next tick and start its click (called by metronomeNext)
+ */
+void metronomeTick(Metronome* m);
+
+/**
+ * \brief Advance the metronome by one frame
+ *
+ * \returns the click sample to add to the frame
+ */
+static inline short metronomeNext(Metronome* m)
+{
+    // Once the click finishes, voiceIndex parks on the silent sample at the end of the table
+    short sample = m->voice[m->voiceIndex];
+    m->voiceIndex += m->voiceIndex < m->voiceLength;
+
+    if (++m->counter >= m->tickTime)
+    {
+        metronomeTick(m);
+    }
+    return sample;
+}
+
+/**
+ * \brief Whether the frame after the last one played by metronomeNext or metronomeMix starts a
+ *        beat
+ */
+static inline int metronomeOnBeat(const Metronome* m)
+{
+    return m->counter == 0 && m->tick == 0;
+}
+
+/**
+ * \brief Advance the metronome by a block of frames, mixing its clicks into the block
+ *
+ * \param m             metronome
+ * \param block         mono samples to mix clicks into (saturating)
+ * \param frames        number of frames in block
+ */
+void metronomeMix(Metronome* m, short* block, size_t frames);
+
+#endif
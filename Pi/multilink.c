@@ -0,0 +1,149 @@
+// Date: 10/19/2026
+// Summary: Records the sample links of several FPGA boards at once into one multi-channel WAV
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <getopt.h>
+#include "EasyPIO.h"
+#include "links.h"
+#include "wav.h"
+
+////////////////////////////////
+//  Constants
+////////////////////////////////
+
+#define MULTI_TIME 10           // default length of the recording in seconds
+#define MULTI_MOSI 22           // data pin of the first board when no links are given
+
+////////////////////////////////
+//  Functions
+////////////////////////////////
+
+/**
+ * \brief Print command line usage
+ */
+static void usage(const char* program)
+{
+    printf("usage: %s [options] OUT.wav\n", program);
+    printf("  -l, --link MOSI[:SCLK:NCS]  add a board sending on MOSI, clocked by SCLK\n");
+    printf("                              (default %d) and selected by NCS (default %d); up to\n",
+        LINKS_SCLK, LINKS_NCS);
+    printf("                              %d boards, and boards may share SCLK and NCS\n",
+        LINKS_MAX);
+    printf("  -s, --stereo                the boards are built with STEREO = 1\n");
+    printf("  -t, --time S                seconds to record (default %d)\n", MULTI_TIME);
+    printf("  -v, --verbose               report the GPIO reads per frame and their cost\n");
+}
+
+int main(int argc, char** argv)
+{
+    static struct option options[] = {
+        {"link", required_argument, NULL, 'l'},
+        {"stereo", no_argument, NULL, 's'},
+        {"time", required_argument, NULL, 't'},
+        {"verbose", no_argument, NULL, 'v'},
+        {NULL, 0, NULL, 0}
+    };
+    LinkPins pins[LINKS_MAX];
+    Links links;
+    int count = 0, channels = 1, verbose = 0, option, width;
+    float seconds = MULTI_TIME;
+    size_t frames, done = 0, polls = 0;
+    short* buffer;
+    FILE* file;
+    struct timespec start, end;
+    double elapsed;
+
+    while ((option = getopt_long(argc, argv, "l:st:v", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+            case 'l':
+                if (count == LINKS_MAX)
+                {
+                    printf("can't decode more than %d links\n", LINKS_MAX);
+                    return 1;
+                }
+                pins[count].sclk = LINKS_SCLK;
+                pins[count].ncs = LINKS_NCS;
+                if (sscanf(optarg, "%d:%d:%d", &pins[count].mosi, &pins[count].sclk,
+                    &pins[count].ncs) < 1)
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                count++;
+                break;
+            case 's': channels = 2; break;
+            case 't': seconds = atof(optarg); break;
+            case 'v': verbose = 1; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (optind != argc - 1 || seconds <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (count == 0)
+    {
+        pins[0].mosi = MULTI_MOSI;
+        pins[0].sclk = LINKS_SCLK;
+        pins[0].ncs = LINKS_NCS;
+        count = 1;
+    }
+
+    // All of the frames are kept in memory so nothing but GPIO reads happens while recording
+    width = count * channels;
+    frames = seconds * SAMPLE_RATE;
+    buffer = malloc(frames * width * sizeof(short));
+    file = fopen(argv[optind], "wb");
+    if (buffer == NULL || file == NULL)
+    {
+        printf("can't record %.1f s to %s\n", seconds, argv[optind]);
+        return 1;
+    }
+
+    pioInit();
+    for (int i = 0; i < count; ++i)
+    {
+        pinMode(pins[i].mosi, INPUT);
+        pinMode(pins[i].sclk, INPUT);
+        pinMode(pins[i].ncs, INPUT);
+    }
+    if (linksInit(&links, pins, count, channels, digitalReadAll()))
+    {
+        printf("can't decode those links (pins must be below 32 and data pins unique)\n");
+        return 1;
+    }
+
+    printf("recording %d link%s of %d channel%s...\n", count, count > 1 ? "s" : "", channels,
+        channels > 1 ? "s" : "");
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (done < frames)
+    {
+        polls++;
+        if (linksPoll(&links, digitalReadAll()))
+        {
+            linksDecode(&links, buffer + done++ * width);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    wavWriteHeader(file, width, frames);
+    fwrite(buffer, sizeof(short), frames * width, file);
+    fclose(file);
+    free(buffer);
+
+    printf("recorded %zu frames of %d channels in %.2f s (%zu transfers ended early)\n",
+        frames, width, elapsed, links.failures);
+    if (verbose)
+    {
+        // Every half period of SCLK needs at least one read, so this shows the headroom left
+        printf("%.1f GPIO reads per frame, %.1f ns per read\n", (double)polls / frames,
+            elapsed * 1e9 / polls);
+    }
+    return 0;
+}
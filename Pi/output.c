@@ -0,0 +1,91 @@
+// Date: 10/19/2026
+// Summary: Turns samples into noise-shaped, dithered PWM words for both sides of the audio jack
+
+#include <math.h>
+#include "output.h"
+
+// Zeros of the noise transfer function as fractions of the band (roots of the 4th Legendre
+// polynomial, which minimize the noise left in the band)
+static const double zeros[OUTPUT_ORDER / 2] = {0.3399810, 0.8611363};
+
+/**
+ * \brief Uniform random number from 0 to 1 (xorshift)
+ */
+static inline float uniform(unsigned int* seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return (*seed >> 8) * (1.0f / (1 << 24));
+}
+
+int outputInit(Output* out, int rate, unsigned int clock)
+{
+    double ntf[OUTPUT_ORDER + 1] = {1};
+    double band = 2 * M_PI * OUTPUT_BAND / ((double)SAMPLE_RATE * rate);
+    double c, gain = 0;
+    int order = 0;
+
+    if (rate < 1 || rate > OUTPUT_MAX_RATE)
+    {
+        return -1;
+    }
+    out->rate = rate;
+    out->range = clock / (SAMPLE_RATE * rate);
+    out->seed = 0x12345678;
+
+    // Multiply out (1 - 2 cos(w) z^-1 + z^-2) for each pair of zeros; at one period per sample
+    // the band reaches almost to the Nyquist frequency, so the noise is only dithered
+    for (int k = 0; rate > 1 && k < OUTPUT_ORDER / 2; ++k)
+    {
+        c = -2 * cos(zeros[k] * band);
+        for (int i = order + 2; i >= 1; --i)
+        {
+            ntf[i] += c * ntf[i - 1] + (i >= 2 ? ntf[i - 2] : 0);
+        }
+        order += 2;
+    }
+    for (int i = 0; i < OUTPUT_ORDER; ++i)
+    {
+        out->feedback[i] = ntf[i + 1];
+        out->error[0][i] = 0;
+        out->error[1][i] = 0;
+    }
+
+    // The shaped error is at most 1.5 LSB (rounding plus dither) times the filter's largest gain
+    for (int i = 0; i <= OUTPUT_ORDER; ++i)
+    {
+        gain += fabs(ntf[i]);
+    }
+    out->offset = ceil(1.5 * gain);
+    out->scale = out->range - 2 * out->offset;
+    return 0;
+}
+
+void outputFrame(Output* out, const float* duty, unsigned int* words)
+{
+    float target, shaped, word;
+    float* error;
+
+    for (int c = 0; c < 2; ++c)
+    {
+        target = out->offset + duty[c] * out->scale;
+        error = out->error[c];
+
+        for (int p = 0; p < out->rate; ++p)
+        {
+            shaped = target + out->feedback[0] * error[0] + out->feedback[1] * error[1]
+                + out->feedback[2] * error[2] + out->feedback[3] * error[3];
+            word = floorf(shaped + uniform(&out->seed) + uniform(&out->seed) - 0.5f);
+
+            error[3] = error[2];
+            error[2] = error[1];
+            error[1] = error[0];
+            error[0] = word - shaped;
+
+            // Clipping is left out of the feedback, which would otherwise grow without limit
+            word = word < 0 ? 0 : word > out->range ? out->range : word;
+            words[2 * p + c] = (unsigned int)word;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+// Date: 10/19/2026
+// Summary: Turns samples into noise-shaped, dithered PWM words for both sides of the audio jack
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "wav.h"
+
+#define OUTPUT_MAX_RATE 4       // most PWM periods per sample (both channels must fit the FIFO)
+#define OUTPUT_RATE 4           // default PWM periods per sample
+#define OUTPUT_FIFO 8           // words in the PWM FIFO, shared by both channels
+#define OUTPUT_ORDER 4          // order of the noise shaping
+#define OUTPUT_BAND 20000       // top of the band kept clear of shaped noise in Hz
+
+/**
+ * \brief State of the output engine
+ *
+ * The PWM runs rate times per sample, at 96 kHz or more where its carrier can't be heard, and
+ * every period gets its own word from the PWM's FIFO.  Each word is quantized with TPDF
+ * dither, and the error of each quantization is fed back through a 4th-order filter so that
+ * the noise it leaves lands above OUTPUT_BAND.  The filter's zeros are spread across the band,
+ * which keeps more noise out of it than four zeros at DC would.  Error feedback is stable for
+ * any input as long as the words are not clipped, so the samples are scaled to leave room for
+ * the shaped noise.  With one period per sample there is no room above the band, so the words
+ * are only dithered.
+ */
+typedef struct
+{
+    int rate;                               // PWM periods per sample
+    unsigned int range;                     // PWM clock cycles per period
+    float scale;                            // word per unit of duty cycle
+    float offset;                           // word for a duty cycle of 0
+    float feedback[OUTPUT_ORDER];           // error feedback filter (newest error first)
+    float error[2][OUTPUT_ORDER];           // recent quantization errors of each channel
+    unsigned int seed;                      // state of the dither's random number generator
+} Output;
+
+/**
+ * \brief Set up the engine
+ *
+ * \param out           engine to initialize
+ * \param rate          PWM periods per sample (1 to OUTPUT_MAX_RATE)
+ * \param clock         frequency of the PWM clock in Hz
+ *
+ * \returns 0 on success, -1 if the rate is not supported
+ */
+int outputInit(Output* out, int rate, unsigned int clock);
+
+/**
+ * \brief Quantize one sample for both sides of the jack
+ *
+ * The sample is held for all rate periods, as a single PWM period per sample holds it, so
+ * the frequency response is unchanged.
+ *
+ * \param duty          duty cycle of each side (0 to 1)
+ * \param words         receives 2 * rate words, alternating between the two sides as the
+ *                      PWM reads them from its FIFO
+ */
+void outputFrame(Output* out, const float* duty, unsigned int* words);
+
+#endif
@@ -0,0 +1,212 @@
+// Date: 10/19/2026
+// Summary: Hardware performance counters read around each stage of the audio loop
+
+#include "perf.h"
+
+#ifdef PERF_COUNTERS
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "logger.h"
+#include "wav.h"
+
+// Names of the stages in reports
+static const char* stageNames[PERF_STAGES] = {"control", "mix", "wait", "output", "capture",
+    "record"};
+
+/**
+ * \brief Open one event in the calling thread's group
+ *
+ * \returns file descriptor of the event, or -1 if it couldn't be opened
+ */
+static int openEvent(unsigned int type, unsigned long long config, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/**
+ * \brief Read every event in the group at once
+ *
+ * \param counts        receives the count of each event (unsupported events read 0)
+ */
+static void readCounts(Perf* perf, unsigned long long* counts)
+{
+    unsigned long long values[PERF_EVENTS + 1];     // number of events, then their counts
+    int e;
+
+    if (read(perf->group, values, sizeof(values)) < (ssize_t)sizeof(values[0]))
+    {
+        values[0] = 0;
+    }
+    for (e = 0; e < PERF_EVENTS; ++e)
+    {
+        counts[e] = perf->slot[e] >= 0 && perf->slot[e] < (int)values[0] ?
+            values[perf->slot[e] + 1] : 0;
+    }
+}
+
+/**
+ * \brief Log the average counts per frame of each stage and start over
+ */
+static void report(Perf* perf)
+{
+    unsigned long long all[PERF_EVENTS] = {0};      // counts across every stage
+    size_t frames = perf->measured[PERF_CONTROL];   // frames measured since the last report
+    const unsigned long long* t;
+    int s, e;
+
+    if (frames == 0)
+    {
+        return;
+    }
+    for (s = 0; s < PERF_STAGES; ++s)
+    {
+        t = perf->total[s];
+        for (e = 0; e < PERF_EVENTS; ++e)
+        {
+            all[e] += t[e];
+        }
+        if (perf->measured[s] == 0)
+        {
+            continue;
+        }
+        logPrint("perf %-7s: %7.0f cycles, %.2f IPC, %6.2f cache, %5.2f TLB, %5.2f branch misses "
+            "(%zu frames)\n", stageNames[s], (double)t[PERF_CYCLES] / perf->measured[s],
+            t[PERF_CYCLES] ? (double)t[PERF_INSTRUCTIONS] / t[PERF_CYCLES] : 0,
+            (double)t[PERF_CACHE_MISSES] / perf->measured[s],
+            (double)t[PERF_TLB_MISSES] / perf->measured[s],
+            (double)t[PERF_BRANCH_MISSES] / perf->measured[s], perf->measured[s]);
+    }
+    logPrint("perf frame  : %7.0f cycles, %.2f IPC, %6.2f cache, %5.2f TLB, %5.2f branch misses\n",
+        (double)all[PERF_CYCLES] / frames,
+        all[PERF_CYCLES] ? (double)all[PERF_INSTRUCTIONS] / all[PERF_CYCLES] : 0,
+        (double)all[PERF_CACHE_MISSES] / frames, (double)all[PERF_TLB_MISSES] / frames,
+        (double)all[PERF_BRANCH_MISSES] / frames);
+
+    memset(perf->total, 0, sizeof(perf->total));
+    memset(perf->measured, 0, sizeof(perf->measured));
+}
+
+int perfOpen(Perf* perf, unsigned int period)
+{
+    static const unsigned int types[PERF_EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    static const unsigned long long configs[PERF_EVENTS] = {PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | PERF_COUNT_HW_CACHE_OP_READ << 8
+            | PERF_COUNT_HW_CACHE_RESULT_MISS << 16,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    int e;
+
+    // Nothing is open until it is, so perfClose never closes a descriptor it doesn't own
+    memset(perf, 0, sizeof(*perf));
+    for (e = 0; e < PERF_EVENTS; ++e)
+    {
+        perf->fds[e] = -1;
+        perf->slot[e] = -1;
+    }
+    perf->period = period > 0 ? period : 1;
+    perf->countdown = 1;
+
+    // The cycle counter leads the group, so every event counts over exactly the same time
+    perf->group = openEvent(types[PERF_CYCLES], configs[PERF_CYCLES], -1);
+    if (perf->group < 0)
+    {
+        return -1;
+    }
+    for (e = 0; e < PERF_EVENTS; ++e)
+    {
+        perf->fds[e] = e == PERF_CYCLES ? perf->group : openEvent(types[e], configs[e],
+            perf->group);
+        perf->slot[e] = perf->fds[e] >= 0 ? perf->events++ : -1;
+    }
+    return 0;
+}
+
+void perfClose(Perf* perf)
+{
+    int e;
+
+    for (e = 0; e < PERF_EVENTS; ++e)
+    {
+        if (perf->fds[e] >= 0 && e != PERF_CYCLES)
+        {
+            close(perf->fds[e]);
+        }
+        perf->fds[e] = -1;
+    }
+    if (perf->group >= 0)
+    {
+        close(perf->group);
+    }
+    perf->group = -1;
+    perf->measuring = 0;
+}
+
+void perfFrame(Perf* perf)
+{
+    if (++perf->frames >= (size_t)SAMPLE_RATE * PERF_REPORT)
+    {
+        report(perf);
+        perf->frames = 0;
+    }
+
+    perf->measuring = --perf->countdown == 0;
+    if (perf->measuring)
+    {
+        perf->countdown = perf->period;
+        readCounts(perf, perf->last);
+    }
+}
+
+void perfMark(Perf* perf, PerfStage stage)
+{
+    unsigned long long now[PERF_EVENTS];
+    int e;
+
+    readCounts(perf, now);
+    for (e = 0; e < PERF_EVENTS; ++e)
+    {
+        perf->total[stage][e] += now[e] - perf->last[e];
+        perf->last[e] = now[e];
+    }
+    perf->measured[stage]++;
+}
+
+#else
+
+int perfOpen(Perf* perf, unsigned int period)
+{
+    (void)period;
+    perf->group = -1;
+    perf->measuring = 0;
+    return -1;
+}
+
+void perfClose(Perf* perf)
+{
+    (void)perf;
+}
+
+void perfFrame(Perf* perf)
+{
+    (void)perf;
+}
+
+void perfMark(Perf* perf, PerfStage stage)
+{
+    (void)perf;
+    (void)stage;
+}
+
+#endif
@@ -0,0 +1,101 @@
+// Date: 10/19/2026
+// Summary: Hardware performance counters read around each stage of the audio loop
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stddef.h>
+
+#define PERF_PERIOD 64              // suggested frames between measured frames
+#define PERF_REPORT 10              // time in seconds between reports
+
+/**
+ * \brief Counted events, in the order they are reported
+ */
+typedef enum
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_TLB_MISSES,                // data TLB read misses
+    PERF_BRANCH_MISSES,
+    PERF_EVENTS
+} PerfEvent;
+
+/**
+ * \brief Stages of one frame of the audio loop, in the order they run
+ */
+typedef enum
+{
+    PERF_CONTROL,                   // buttons, switches and mode changes
+    PERF_MIX,                       // mixing the input with the recording
+    PERF_WAIT,                      // feeding the PWM while waiting for NCS
+    PERF_OUTPUT,                    // queueing the mix for the PWM or ALSA
+    PERF_CAPTURE,                   // reading and decoding the frame, effects and tuner
+    PERF_RECORD,                    // appending the frame to the take or pre-roll
+    PERF_STAGES
+} PerfStage;
+
+/**
+ * \brief A group of counters sampled by the audio thread
+ *
+ * Every period-th frame is measured: the whole group is read once at the start of the frame
+ * and once at the end of each stage, and the differences are added to the stage's totals.
+ * The totals belong to the audio thread, which hands averages to logPrint every PERF_REPORT
+ * seconds, so nothing is shared and nothing locks.  Only user-mode counts are kept.
+ */
+typedef struct
+{
+    int group;                                      // fd of the group leader (-1 if closed)
+    int fds[PERF_EVENTS];                           // fd of each event (-1 if unsupported)
+    int slot[PERF_EVENTS];                          // index of each event in a group read
+    int events;                                     // events opened in the group
+    unsigned int period;                            // frames between measured frames
+    unsigned int countdown;                         // frames until the next measured frame
+    int measuring;                                  // whether this frame is measured
+    size_t frames;                                  // frames since the last report
+    unsigned long long last[PERF_EVENTS];           // counts at the end of the last stage
+    unsigned long long total[PERF_STAGES][PERF_EVENTS];    // counts in each stage
+    size_t measured[PERF_STAGES];                   // measured passes through each stage
+} Perf;
+
+/**
+ * \brief Open the counters for the calling thread
+ *
+ * Events the CPU doesn't count are left out (and reported as 0).
+ *
+ * \param perf          counters to open
+ * \param period        frames between measured frames (each measured frame costs a read
+ *                      system call per stage)
+ *
+ * \returns 0 on success, -1 if the cycle counter couldn't be opened (or the receiver was
+ *          built without PERF=1)
+ */
+int perfOpen(Perf* perf, unsigned int period);
+
+/**
+ * \brief Close the counters
+ */
+void perfClose(Perf* perf);
+
+/**
+ * \brief Start a frame, reading the counters if it is measured and reporting when one is due
+ */
+void perfFrame(Perf* perf);
+
+/**
+ * \brief Charge the counts since the last stage (or the start of the frame) to a stage
+ */
+void perfMark(Perf* perf, PerfStage stage);
+
+// The audio loop calls these, so that a receiver built without PERF=1 doesn't pay for a
+// branch on every stage
+#ifdef PERF_COUNTERS
+#define PERF_FRAME(perf) do { if ((perf)->group >= 0) perfFrame(perf); } while (0)
+#define PERF_MARK(perf, stage) do { if ((perf)->measuring) perfMark(perf, stage); } while (0)
+#else
+#define PERF_FRAME(perf) ((void)0)
+#define PERF_MARK(perf, stage) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+// Date: 10/19/2026
+// Summary: Stable C interface for effect plugins loaded from shared objects at startup
+
+#ifndef PLUGIN_H
+#define PLUGIN_H
+
+#include <stddef.h>
+
+#define PLUGIN_ABI_VERSION 1                // changes whenever PluginDescriptor changes
+#define PLUGIN_ENTRY "pluginDescriptor"     // symbol every plugin exports
+
+/**
+ * \brief Everything the host needs from a plugin
+ *
+ * A plugin is a shared object exporting a function named PLUGIN_ENTRY which returns a pointer
+ * to a static PluginDescriptor:
+ *
+ *     const PluginDescriptor* pluginDescriptor(void);
+ *
+ * Samples are planar floats from -1 to 1.  process is called from the effects thread with
+ * blocks of at most maxFrames frames and must not block, allocate or print.  Only plain C
+ * types cross this interface, so a plugin built against an older receiver keeps working as
+ * long as abiVersion matches.
+ */
+typedef struct
+{
+    unsigned int abiVersion;    // PLUGIN_ABI_VERSION the plugin was built against
+    const char* name;           // name used in messages
+
+    /**
+     * \brief Allocate and initialize an instance
+     *
+     * \returns the instance's state, or NULL on failure
+     */
+    void* (*create)(int channels, int sampleRate, size_t maxFrames);
+
+    /**
+     * \brief Free an instance
+     */
+    void (*destroy)(void* state);
+
+    /**
+     * \brief Process one block of every channel in place
+     */
+    void (*process)(void* state, float* const* channels, int numChannels, size_t frames);
+
+    /**
+     * \brief Set a named parameter (called before processing starts)
+     *
+     * \returns 0 on success, -1 if the plugin has no such parameter
+     */
+    int (*setParam)(void* state, const char* name, float value);
+
+    /**
+     * \brief Frames by which the instance delays its input
+     */
+    size_t (*latency)(void* state);
+} PluginDescriptor;
+
+#endif
@@ -0,0 +1,140 @@
+// Date: 10/19/2026
+// Summary: Measures the CPU time effect plugins and the plugin host use per block
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <getopt.h>
+#include "host.h"
+
+////////////////////////////////
+//  Constants
+////////////////////////////////
+
+#define BENCH_BLOCKS 100000     // default number of blocks run through the chain
+#define BENCH_CHANNELS 2        // default number of channels processed
+
+////////////////////////////////
+//  Functions
+////////////////////////////////
+
+/**
+ * \brief Thread CPU time in ns
+ */
+static long long cpuTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * \brief Print command line usage
+ */
+static void usage(const char* program)
+{
+    printf("usage: %s [options] PLUGIN...\n", program);
+    printf("  -n, --blocks N    blocks of %d frames to process (default %d)\n", DSP_BLOCK,
+        BENCH_BLOCKS);
+    printf("  -c, --channels N  channels to process (default %d)\n", BENCH_CHANNELS);
+    printf("  -B, --budget US   CPU time each plugin may use per block (default %d)\n",
+        HOST_BUDGET);
+    printf("each PLUGIN is a shared object optionally followed by parameters, such as\n");
+    printf("plugins/tone.so:cutoff=2000,q=0.7\n");
+}
+
+int main(int argc, char** argv)
+{
+    size_t numBlocks = BENCH_BLOCKS;
+    int channels = BENCH_CHANNELS;
+    long long budget = HOST_BUDGET;
+    static struct option options[] = {
+        {"blocks", required_argument, NULL, 'n'},
+        {"channels", required_argument, NULL, 'c'},
+        {"budget", required_argument, NULL, 'B'},
+        {NULL, 0, NULL, 0}
+    };
+    Plugin plugins[DSP_MAX_STAGES];
+    DspProcessor stages[DSP_MAX_STAGES];
+    float samples[MAX_CHANNELS][DSP_BLOCK];
+    float* block[MAX_CHANNELS];
+    int numPlugins, option;
+    long long start, total = 0, charged = 0, empty = 0;
+
+    while ((option = getopt_long(argc, argv, "n:c:B:", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+            case 'n': numBlocks = strtoul(optarg, NULL, 10); break;
+            case 'c': channels = atoi(optarg); break;
+            case 'B': budget = strtoll(optarg, NULL, 10); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    numPlugins = argc - optind;
+    if (numPlugins < 1 || numPlugins > DSP_MAX_STAGES || numBlocks < 1 || channels < 1
+        || channels > MAX_CHANNELS)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < numPlugins; ++i)
+    {
+        if (pluginLoad(&plugins[i], argv[optind + i], channels, budget))
+        {
+            printf("can't load the plugin %s\n", argv[optind + i]);
+            return 1;
+        }
+        stages[i] = pluginProcessor(&plugins[i]);
+    }
+    for (int c = 0; c < channels; ++c)
+    {
+        block[c] = samples[c];
+    }
+
+    // Find what the timing below costs on its own so it isn't charged to the host
+    for (size_t n = 0; n < numBlocks; ++n)
+    {
+        start = cpuTime();
+        empty += cpuTime() - start;
+    }
+
+    // Run white noise through the chain in the effects thread's block size
+    srand(1);
+    for (size_t n = 0; n < numBlocks; ++n)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            for (int i = 0; i < DSP_BLOCK; ++i)
+            {
+                samples[c][i] = (float)rand() / RAND_MAX - 0.5f;
+            }
+        }
+        start = cpuTime();
+        for (int i = 0; i < numPlugins; ++i)
+        {
+            stages[i].process(stages[i].state, block, channels, DSP_BLOCK);
+        }
+        total += cpuTime() - start;
+    }
+
+    printf("%zu blocks of %d frames, %d channel%s, %lld us budget\n", numBlocks, DSP_BLOCK,
+        channels, channels > 1 ? "s" : "", budget);
+    for (int i = 0; i < numPlugins; ++i)
+    {
+        charged += plugins[i].total;
+        printf("%-12s %8.0f ns average %8lld ns worst %6.2f ns per frame%s\n",
+            plugins[i].desc->name,
+            plugins[i].blocks ? (double)plugins[i].total / plugins[i].blocks : 0,
+            plugins[i].worst,
+            plugins[i].blocks ? (double)plugins[i].total / plugins[i].blocks / DSP_BLOCK : 0,
+            plugins[i].bypassed ? " (bypassed)" : "");
+        pluginUnload(&plugins[i]);
+    }
+
+    // Whatever the plugins weren't charged for went to the host's accounting
+    printf("%-12s %8.0f ns per block of accounting\n", "host",
+        (double)(total - charged - empty) / numBlocks);
+    return 0;
+}
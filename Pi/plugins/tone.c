@@ -0,0 +1,120 @@
+// Date: 10/19/2026
+// Summary: Reference plugin with a resonant low-pass tone control (one biquad per channel)
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "plugin.h"
+
+#define MAX_CHANNELS 8      // most channels an instance handles
+
+/**
+ * \brief State of a tone control
+ */
+typedef struct
+{
+    int channels;               // channels filtered
+    float sampleRate;           // samples per second
+    float cutoff;               // cutoff frequency in Hz
+    float q;                    // resonance
+    float b0, b1, b2, a1, a2;   // filter coefficients (a0 normalized to 1)
+    float z1[MAX_CHANNELS];     // first state variable of each channel
+    float z2[MAX_CHANNELS];     // second state variable of each channel
+} Tone;
+
+/**
+ * \brief Compute the coefficients of the low-pass filter (RBJ cookbook)
+ */
+static void design(Tone* t)
+{
+    float w = 2 * (float)M_PI * t->cutoff / t->sampleRate;
+    float alpha = sinf(w) / (2 * t->q);
+    float a0 = 1 + alpha;
+
+    t->b0 = (1 - cosf(w)) / 2 / a0;
+    t->b1 = (1 - cosf(w)) / a0;
+    t->b2 = t->b0;
+    t->a1 = -2 * cosf(w) / a0;
+    t->a2 = (1 - alpha) / a0;
+}
+
+static void* create(int channels, int sampleRate, size_t maxFrames)
+{
+    Tone* t;
+
+    (void)maxFrames;
+    if (channels > MAX_CHANNELS || (t = calloc(1, sizeof(Tone))) == NULL)
+    {
+        return NULL;
+    }
+    t->channels = channels;
+    t->sampleRate = sampleRate;
+    t->cutoff = 4000;
+    t->q = 0.707f;
+    design(t);
+    return t;
+}
+
+static void destroy(void* state)
+{
+    free(state);
+}
+
+static void process(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Tone* t = state;
+    float* x;
+    float y, z1, z2;
+
+    // Transposed direct form II
+    for (int c = 0; c < numChannels && c < t->channels; ++c)
+    {
+        x = channels[c];
+        z1 = t->z1[c];
+        z2 = t->z2[c];
+        for (size_t i = 0; i < frames; ++i)
+        {
+            y = t->b0 * x[i] + z1;
+            z1 = t->b1 * x[i] - t->a1 * y + z2;
+            z2 = t->b2 * x[i] - t->a2 * y;
+            x[i] = y;
+        }
+        t->z1[c] = z1;
+        t->z2[c] = z2;
+    }
+}
+
+static int setParam(void* state, const char* name, float value)
+{
+    Tone* t = state;
+
+    if (!strcmp(name, "cutoff") && value > 10 && value < t->sampleRate / 2)
+    {
+        t->cutoff = value;
+    }
+    else if (!strcmp(name, "q") && value > 0.1f && value <= 20)
+    {
+        t->q = value;
+    }
+    else
+    {
+        return -1;
+    }
+    design(t);
+    return 0;
+}
+
+static size_t latency(void* state)
+{
+    (void)state;
+    return 0;
+}
+
+static const PluginDescriptor descriptor = {
+    PLUGIN_ABI_VERSION, "tone", create, destroy, process, setParam, latency
+};
+
+const PluginDescriptor* pluginDescriptor(void)
+{
+    return &descriptor;
+}
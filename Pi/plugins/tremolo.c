@@ -0,0 +1,91 @@
+// Date: 10/19/2026
+// Summary: Reference plugin which modulates the volume with a low-frequency sine
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "plugin.h"
+
+/**
+ * \brief State of a tremolo
+ */
+typedef struct
+{
+    float sampleRate;           // samples per second
+    float rate;                 // modulation frequency in Hz
+    float depth;                // fraction of the volume removed at the trough (0 to 1)
+    double phase;               // phase of the modulation in cycles
+} Tremolo;
+
+static void* create(int channels, int sampleRate, size_t maxFrames)
+{
+    Tremolo* t = malloc(sizeof(Tremolo));
+
+    (void)channels;
+    (void)maxFrames;
+    if (t != NULL)
+    {
+        t->sampleRate = sampleRate;
+        t->rate = 5;
+        t->depth = 0.5f;
+        t->phase = 0;
+    }
+    return t;
+}
+
+static void destroy(void* state)
+{
+    free(state);
+}
+
+static void process(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Tremolo* t = state;
+    double step = t->rate / t->sampleRate;
+    float gain;
+
+    for (size_t i = 0; i < frames; ++i)
+    {
+        gain = 1 - t->depth * 0.5f * (1 - cosf(2 * (float)M_PI * (float)t->phase));
+        for (int c = 0; c < numChannels; ++c)
+        {
+            channels[c][i] *= gain;
+        }
+        t->phase += step;
+        t->phase -= t->phase >= 1 ? 1 : 0;
+    }
+}
+
+static int setParam(void* state, const char* name, float value)
+{
+    Tremolo* t = state;
+
+    if (!strcmp(name, "rate") && value > 0)
+    {
+        t->rate = value;
+    }
+    else if (!strcmp(name, "depth") && value >= 0 && value <= 1)
+    {
+        t->depth = value;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static size_t latency(void* state)
+{
+    (void)state;
+    return 0;
+}
+
+static const PluginDescriptor descriptor = {
+    PLUGIN_ABI_VERSION, "tremolo", create, destroy, process, setParam, latency
+};
+
+const PluginDescriptor* pluginDescriptor(void)
+{
+    return &descriptor;
+}
@@ -5,29 +5,67 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <string.h>
 #include <ifaddrs.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include <time.h>
+#include <getopt.h>
 #include <math.h>
+#ifdef REPLAY
+#include "replay.h"         // read the pins from a trace instead of the GPIO
+#define INPUT_THREAD 0      // the replay polls the buttons and switches itself
+#else
 #include "EasyPIO.h"
+#define INPUT_THREAD 1
+#endif
+#include "wav.h"
+#include "audio.h"
+#include "store.h"
+#include "metronome.h"
+#include "input.h"
+#include "tuner.h"
+#include "take.h"
+#include "split.h"
+#include "stretch.h"
+#include "dsp.h"
+#include "conv.h"
+#include "shaper.h"
+#include "output.h"
+#include "alsa.h"
+#include "dynamics.h"
+#include "delay.h"
+#include "denoise.h"
+#include "trace.h"
+#include "logger.h"
+#include "perf.h"
+#include "share.h"
+#include "effects.h"
+#include "host.h"
+#include "tables.h"
 
 ////////////////////////////////
 //  Constants and Globals
 ////////////////////////////////
 
 // Program constants
-#define VOLUME 16           // volume multiplier
-#define CLICK_VOLUME 0.5f   // click volume (as a fraction of max volume)
-#define BUF_SIZE (1 << 24)  // size of recording buffer (allows for 5 mins 49 secs of recording)
+#define STORE_SIZE 256     // default size in MB of the recording arena (46 mins of mono recording)
 #define INPUT_BITS 11       // bit depth of FPGA signal
 #define FLASH_TIME 200      // LED flash time in miliseconds
-#define DEBOUNCE_TIME 5     // time in miliseconds to wait for inputs to debounce
+#define DEBOUNCE_TIME 5     // time in miliseconds to ignore an input after it changes
 #define MAX_MEASURES 16     // maximum measures to use when looping
-#define LOOP_COUNTDOWN 4    // number of beats to countdown before recording in loop mode
+#define LOOP_COUNTDOWN 4    // default number of beats to countdown before recording in loop mode
+#define BEATS_PER_MEASURE 4 // default number of beats in each measure
 #define LOOP_DELAY 1000     // time in miliseconds to wait before begining loop coutdown
+#define STATS_TIME 10       // time in seconds between frame budget reports in verbose mode
+#define TUNER_HOLD 1000     // time in miliseconds to hold reset to enter or leave tuner mode
+#define TAP_TIMEOUT 2000    // longest time in miliseconds between two taps of the tempo
+#define IN_TUNE 5           // largest offset in cents from a note which is in tune
+#define MIX_HEADROOM 6.02f  // dB below full scale at which the mix passes through the limiter
+#define RECORDING_PATH "/var/www/html/recording.wav"    // link to the latest take on the website
 
 // Pins
 #define PIN_RECORD 18       // switch to determine play or record mode
@@ -39,60 +77,51 @@
 #define NCS 17              // SPI chip select
 #define MOSI 22             // SPI master out slave in
 #define SCLK 5              // SPI clock
-
-// WAV constants
-#define CHANNELS 1          // number of channels (mono or stereo)
-#define SAMPLE_RATE 48000   // samples per second
-#define BIT_DEPTH 16        // bits per sample
-#define BIT_RATE (SAMPLE_RATE * BIT_DEPTH * CHANNELS / 8)   // bits per second
-#define BYTES_PER_SAMPLE (BIT_DEPTH * CHANNELS / 8)         // bytes per sample
+#define UI_PINS 5           // number of user interface inputs
 
 // Global Variables
-short buffer[BUF_SIZE];     // stores samples of the recording
-                            // (must be a global variable to prevent segfault due to size)
+int uiPins[UI_PINS] = {PIN_RECORD, PIN_LOOP, PIN_START, PIN_RESET, PIN_SAVE};
+int tracePins[TRACE_PINS] = {NCS, SCLK, MOSI, PIN_RECORD, PIN_LOOP, PIN_START, PIN_RESET,
+    PIN_SAVE};
+Trace trace;                // pin trace being captured (if active)
 
 ////////////////////////////////
-//  Structs
+//  Functions
 ////////////////////////////////
 
 /**
- * \brief Struct storing the 44-bit file header of a .wav file
+ * \brief Give the GPIO interrupts back to the kernel, then stop as the signal asks
  */
-typedef struct
+void stop(int sig)
 {
-    char fileFormat[4];
-    int fileLength;
-    char fileType[4];
-    char formatHeader[4];
-    int formatLength;
-    short formatType;
-    short channels;
-    int sampleRate;
-    int bitRate;
-    short bytesPerSample;
-    short bitDepth;
-    char dataHeader[4];
-    int dataLength;
-} WavHeader;
-
-////////////////////////////////
-//  Functions
-////////////////////////////////
+    pinEdgeRelease();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
 
 /**
  * \brief Initialize peripherals
+ *
+ * \param pwm           whether to play through the PWM (otherwise it is left to the kernel)
  */
-void init()
+void init(int pwm)
 {
     // Initialize peripherals
     pioInit();
-    pwmInit();
+    if (pwm)
+    {
+        pwmInit();
+    }
 
-    // Initialize user interface pins
-    pinMode(PIN_RECORD, INPUT);
-    pinMode(PIN_START, INPUT);
-    pinMode(PIN_RESET, INPUT);
-    pinMode(PIN_SAVE, INPUT);
+    // Initialize user interface pins, latching both edges so short presses are not missed,
+    // and hand the GPIO interrupts masked for them back to the kernel when stopped
+    for (int i = 0; i < UI_PINS; ++i)
+    {
+        pinMode(uiPins[i], INPUT);
+        pinEdgeDetect(uiPins[i], 1, 1);
+    }
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
     pinMode(PIN_LED, OUTPUT);
 
     // Initialize SPI pins
@@ -102,72 +131,161 @@ void init()
 }
 
 /**
- * \brief Save recorded audio to a .wav file on the website
+ * \brief Read an SPI pin, adding it to the trace when capturing
  *
- * \param buffer        recorded audio samples
- * \param bufferSize    number of audio samples in buffer
+ * \param index         index of the pin in tracePins (NCS, SCLK or MOSI)
+ */
+static inline int readSpi(int index)
+{
+    int level = digitalRead(tracePins[index]);
+    if (trace.active)
+    {
+        traceRead(&trace, index, level);
+    }
+    return level;
+}
+
+/**
+ * \brief Latched edges of the UI pins, noted for the trace (called by the input thread)
+ */
+unsigned int tracedEdgeEvents(unsigned int mask)
+{
+    trace.uiEvents = readEdgeEvents(mask);
+    return trace.uiEvents;
+}
+
+/**
+ * \brief Levels of pins 0-31, added to the trace with the last edges (called by the input thread)
  */
-void saveRecording(short* buffer, size_t bufferSize)
+unsigned int tracedReadAll(void)
 {
-    // Fill header with correct data
-    WavHeader header;
-    header.fileFormat[0] = 'R';
-    header.fileFormat[1] = 'I';
-    header.fileFormat[2] = 'F';
-    header.fileFormat[3] = 'F';
-    header.fileLength = bufferSize * sizeof(short) + sizeof(WavHeader);
-    header.fileType[0] = 'W';
-    header.fileType[1] = 'A';
-    header.fileType[2] = 'V';
-    header.fileType[3] = 'E';
-    header.formatHeader[0] = 'f';
-    header.formatHeader[1] = 'm';
-    header.formatHeader[2] = 't';
-    header.formatHeader[3] = ' ';
-    header.formatLength = 16;
-    header.formatType = 1;
-    header.channels = CHANNELS;
-    header.sampleRate = SAMPLE_RATE;
-    header.bitRate = BIT_RATE;
-    header.bytesPerSample = BYTES_PER_SAMPLE;
-    header.bitDepth = BIT_DEPTH;
-    header.dataHeader[0] = 'd';
-    header.dataHeader[1] = 'a';
-    header.dataHeader[2] = 't';
-    header.dataHeader[3] = 'a';
-    header.dataLength = bufferSize * sizeof(short);
-
-    // Write header and buffer to recording.wav on the website
-    FILE* file = fopen("/var/www/html/recording.wav", "w");
-    fwrite(&header, sizeof(WavHeader), 1, file);
-    fwrite(buffer, sizeof(short), bufferSize, file);
-    fclose(file);
+    unsigned int levels = digitalReadAll();
+    traceInput(&trace, trace.uiEvents, levels);
+    trace.uiEvents = 0;
+    return levels;
 }
 
 /**
- * \brief Load .wav from website into buffer
+ * \brief Save recorded audio as a new take on the website
+ *
+ * RECORDING_PATH is pointed at the new take so that the old link keeps working.
  *
- * \param buffer        array into which audio samples are loaded
+ * \param takes         store to add the take to
+ * \param rec           recording to save
+ * \param beatTime      samples per beat for a loop (0 for a linear recording)
+ * \param beatsPerMeasure   beats in each measure of a loop
+ * \param measures      measures in a loop (0 for a linear recording)
  *
- * \returns number of samples loaded into buffer
+ * \returns the new take, or NULL if it could not be saved
  */
-size_t loadRecording(short* buffer)
+const TakeEntry* saveRecording(TakeStore* takes, Recording* rec, size_t beatTime,
+    int beatsPerMeasure, int measures)
 {
-    size_t samples = 0;
-    FILE* file = fopen("/var/www/html/recording.wav", "r");
+    char path[TAKE_PATH];
+    const TakeEntry* saved = takeSave(takes, rec, beatTime, beatsPerMeasure, measures);
 
-    // If the file on the website exists, read it into buffer
-    if (file != NULL)
+    if (saved != NULL)
+    {
+        takePath(takes, saved, path);
+        unlink(RECORDING_PATH);
+        symlink(path, RECORDING_PATH);
+    }
+    return saved;
+}
+
+/**
+ * \brief Read a .wav file into a recording
+ *
+ * Used for files which can't be mapped directly, such as takes with a different number of
+ * channels or a recording.wav saved before there were takes.
+ *
+ * \param rec           empty recording into which audio samples are loaded
+ * \param path          path of the .wav file
+ */
+void loadRecording(Recording* rec, const char* path)
+{
+    size_t chunkFrames = rec->frameMask + 1;
+    size_t frames;
+    short* chunk = malloc(chunkFrames * MAX_CHANNELS * sizeof(short));
+    WavInfo info;
+    FILE* file = fopen(path, "r");
+
+    // If the file exists, read it one chunk at a time, converting it to the recording's number
+    // of channels
+    if (file != NULL && chunk != NULL && !wavReadHeader(file, &info) 
+        && info.channels <= MAX_CHANNELS)
     {
-        // Read in the header (not useful for us)
-        fread(buffer, 1, 44, file);
+        while (rec->frames < info.frames)
+        {
+            frames = info.frames - rec->frames < chunkFrames ? info.frames - rec->frames
+                : chunkFrames;
+            frames = fread(chunk, sizeof(short) * info.channels, frames, file);
+            if (frames == 0 || remixChannels(chunk, frames, info.channels, rec->channels)
+                || recordingAppend(rec) == NULL)
+            {
+                break;
+            }
 
-        // Read in the data so that it overwrites the header
-        samples = fread(buffer, sizeof(short), BUF_SIZE, file);
+            // recordingAppend claimed the chunk, so copy the rest of the frames in after it
+            memcpy(recordingFrame(rec, rec->frames - 1), chunk, 
+                frames * rec->channels * sizeof(short));
+            rec->frames += frames - 1;
+        }
+    }
+
+    if (file != NULL)
+    {
         fclose(file);
     }
+    free(chunk);
+}
+
+/**
+ * \brief Play a loop recorded at one tempo at another without recording it again
+ *
+ * \param stretcher     stretcher to stream the loop through (stopped first)
+ * \param loop          loop to play
+ * \param loopFrames    frames in the loop when complete at the tempo it was recorded at
+ * \param outFrames     frames in the loop at the current tempo
+ *
+ * \returns 1 if the loop is being stretched, 0 if it can be played as it is, or -1 if it is
+ *          not complete or the tempo changed too much, so it must be recorded again
+ */
+int stretchLoop(Stretcher* stretcher, Recording* loop, size_t loopFrames, size_t outFrames)
+{
+    float ratio = (float)outFrames / loopFrames;
 
-    return samples;
+    stretchStop(stretcher);
+    if (loop->frames != loopFrames || ratio < STRETCH_MIN || ratio > STRETCH_MAX)
+    {
+        return -1;
+    }
+    if (outFrames == loopFrames)
+    {
+        return 0;
+    }
+    stretchStart(stretcher, loop, outFrames);
+    return 1;
+}
+
+/**
+ * \brief Convert a sample from the FPGA to a 16-bit sample
+ *
+ * \param bits          11-bit sign-magnitude sample in the lowest bits (higher bits ignored)
+ *
+ * \returns sample in 16-bit 2's complement
+ */
+short decodeSample(int bits)
+{
+    return decodeTable[bits & 0x7FF];
+}
+
+/**
+ * \brief Microseconds elapsed between two times
+ */
+float microsBetween(struct timespec* start, struct timespec* end)
+{
+    return (end->tv_sec - start->tv_sec) * 1e6f + (end->tv_nsec - start->tv_nsec) / 1e3f;
 }
 
 /**
@@ -223,13 +341,450 @@ void getIPAddress(char* retIP)
     strcpy(retIP, "<yourIPAddress>");
 }
 
+/**
+ * \brief Print command line usage
+ */
+void usage(const char* program)
+{
+    printf("usage: %s [options]\n", program);
+    printf("  -s, --stereo      receive two channels from an FPGA built with STEREO = 1\n");
+    printf("  -v, --verbose     report the time spent on each frame every %d seconds\n",
+        STATS_TIME);
+    printf("  -m, --memory MB   size of the recording arena (default %d)\n", STORE_SIZE);
+    printf("  -H, --huge-pages  back the recording arena with huge pages\n");
+    printf("  -l, --live NAME   share the recordings and looper state with other processes in\n");
+    printf("                    the shared memory segment NAME (such as %s)\n", LIVE_NAME);
+    printf("  -c, --count-in N  beats to count before recording a loop (default %d)\n",
+        LOOP_COUNTDOWN);
+    printf("  -b, --beats N     beats per measure; the first is accented (default %d)\n",
+        BEATS_PER_MEASURE);
+    printf("  -d, --subdivide N clicks per beat (default 1)\n");
+    printf("  -k, --click       keep clicking while a loop records and plays\n");
+    printf("  -t, --take N      load take N instead of the latest linear take\n");
+    printf("  -p, --position S  start playing the take from the seek point before S seconds\n");
+    printf("  -r, --pre-roll S  keep the last S seconds of input in linear mode, so a new take\n");
+    printf("                    starts up to S seconds before start is pressed\n");
+    printf("  -S, --split DB    also save a linear take's songs as separate takes, splitting it\n");
+    printf("                    where it stays %d dB below DB (such as %d) for %.1f s\n",
+        SPLIT_HYSTERESIS, SPLIT_LEVEL, SPLIT_GAP / 1000.0f);
+    printf("  -n, --denoise DB  reduce noise by up to DB (such as %d), learning the noise from\n",
+        DENOISE_REDUCTION);
+    printf("                    the first %.1f s of input\n", DENOISE_LEARN_TIME / 1000.0f);
+    printf("  -C, --cabinet WAV convolve the input with an impulse response (such as a cabinet)\n");
+    printf("  -D, --distort C   distort the input with curve C (hard, soft or cubic)\n");
+    printf("  -G, --drive DB    gain before the distortion curve (default %d)\n", SHAPER_DRIVE);
+    printf("  -O, --oversample N oversample the distortion 1, 2, 4 or 8 times (default 4)\n");
+    printf("  -P, --pwm N       PWM periods per sample, from 1 to %d (default %d)\n",
+        OUTPUT_MAX_RATE, OUTPUT_RATE);
+    printf("  -L, --limit       compress and limit the playback mix\n");
+    printf("  -X, --threshold DB  level at which compression starts (default %d)\n",
+        DYNAMICS_THRESHOLD);
+    printf("  -R, --ratio R     compression ratio, 1 to only limit (default %d)\n", DYNAMICS_RATIO);
+    printf("  -M, --makeup DB   gain after compression (default 0)\n");
+    printf("  -A, --alsa DEVICE play through an ALSA device (such as default or hw:1) instead\n");
+    printf("  -T, --period N    frames per ALSA period (default %d)\n", ALSA_PERIOD);
+    printf("  -N, --periods N   periods in the ALSA buffer (default %d)\n", ALSA_PERIODS);
+    printf("  -e, --effects N   apply the FPGA's effects in software: N is the switch bits\n");
+    printf("                    (1 overdrive, 2 delay, 4 chorus, 8 solo, 16 intensity)\n");
+    printf("  -i, --intensity N intensity from 0 to 15 used with --effects 16 (default 0)\n");
+    printf("  -y, --delay MS[:DEPTH:RATE]  add a delay tap, optionally moved DEPTH ms either way\n");
+    printf("                    at RATE Hz (for chorus); may be given up to %d times\n",
+        DELAY_MAX_TAPS);
+    printf("  -F, --feedback F  fraction of the first delay tap fed back (default %.1f)\n",
+        DELAY_FEEDBACK);
+    printf("  -W, --wet DB      level of each delay tap (default %d)\n", DELAY_WET);
+    printf("  -Z, --trace FILE  record the SPI and button pins to FILE for replaying\n");
+    printf("                    (a receiver built with make replay reads FILE instead)\n");
+    printf("  -x, --plugin SPEC load an effect plugin (such as plugins/tone.so:cutoff=2000);\n");
+    printf("                    may be given up to %d times\n", DSP_MAX_STAGES - 4);
+    printf("  -B, --budget US   CPU time each plugin may use per block (default %d)\n",
+        HOST_BUDGET);
+    printf("  -E, --perf N      count cycles, cache and TLB misses in each stage of every Nth\n");
+    printf("                    frame (such as %d), reported every %d s (needs make PERF=1)\n",
+        PERF_PERIOD, PERF_REPORT);
+}
+
 /**
  * \brief Entry point for program
  */
-int main()
+int main(int argc, char** argv)
 {
+    // Command line options
+    int channels = 1;                           // number of channels sent by the FPGA
+    int verbose = 0;                            // whether to report the frame budget
+    size_t storeSize = STORE_SIZE;              // size of the recording arena in MB
+    int hugePages = 0;                          // whether to use huge pages for the arena
+    const char* liveName = NULL;                // shared memory segment holding the arena
+    size_t countIn = LOOP_COUNTDOWN;            // beats to count before recording a loop
+    int beatsPerMeasure = BEATS_PER_MEASURE;    // beats in each measure
+    int subdivisions = 1;                       // clicks per beat
+    int clickAlways = 0;                        // whether to click after the countdown
+    unsigned int takeID = 0;                    // take to load (0 for the latest linear take)
+    float position = 0;                         // seconds into the take at which to start
+    float preRoll = 0;                          // seconds of input kept before a take starts
+    float splitLevel = 0;                       // level in dBFS at which songs start (0 for off)
+    const char* cabinet = NULL;                 // impulse response to convolve the input with
+    const char* distort = NULL;                 // curve to distort the input with
+    float drive = SHAPER_DRIVE;                 // gain in dB before the distortion curve
+    int oversample = 4;                         // oversampling factor of the distortion
+    int pwmRate = OUTPUT_RATE;                  // PWM periods per sample
+    int limit = 0;                              // whether to compress and limit the mix
+    float threshold = DYNAMICS_THRESHOLD;       // level in dB at which compression starts
+    float ratio = DYNAMICS_RATIO;               // compression ratio
+    float makeup = 0;                           // gain in dB after compression
+    const char* alsaDevice = NULL;              // ALSA device to play through (NULL for the PWM)
+    size_t alsaPeriod = ALSA_PERIOD;            // frames per ALSA period
+    size_t alsaPeriods = ALSA_PERIODS;          // periods in the ALSA buffer
+    int switches = -1;                          // software effects (-1 to leave them to the FPGA)
+    int intensity = 0;                          // intensity of the software effects
+    const char* delaySpecs[DELAY_MAX_TAPS];     // delay taps as "ms[:depth:rate]"
+    int numDelays = 0;                          // number of delay taps
+    float feedback = DELAY_FEEDBACK;            // fraction of the first delay tap fed back
+    float wet = DELAY_WET;                      // level in dB of each delay tap
+    float denoise = 0;                          // largest noise reduction in dB (0 for none)
+    const char* pluginSpecs[DSP_MAX_STAGES];    // plugins to load in the order given
+    int numPlugins = 0;                         // number of plugins to load
+    long long budget = HOST_BUDGET;             // CPU time in us each plugin may use per block
+    const char* tracePath = NULL;               // file to record (or replay) the pins to
+    unsigned int perfPeriod = 0;                // frames between counted frames (0 for none)
+    static struct option options[] = {
+        {"stereo", no_argument, NULL, 's'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"memory", required_argument, NULL, 'm'},
+        {"huge-pages", no_argument, NULL, 'H'},
+        {"live", required_argument, NULL, 'l'},
+        {"count-in", required_argument, NULL, 'c'},
+        {"beats", required_argument, NULL, 'b'},
+        {"subdivide", required_argument, NULL, 'd'},
+        {"click", no_argument, NULL, 'k'},
+        {"take", required_argument, NULL, 't'},
+        {"position", required_argument, NULL, 'p'},
+        {"pre-roll", required_argument, NULL, 'r'},
+        {"split", required_argument, NULL, 'S'},
+        {"cabinet", required_argument, NULL, 'C'},
+        {"distort", required_argument, NULL, 'D'},
+        {"drive", required_argument, NULL, 'G'},
+        {"oversample", required_argument, NULL, 'O'},
+        {"pwm", required_argument, NULL, 'P'},
+        {"limit", no_argument, NULL, 'L'},
+        {"threshold", required_argument, NULL, 'X'},
+        {"ratio", required_argument, NULL, 'R'},
+        {"makeup", required_argument, NULL, 'M'},
+        {"alsa", required_argument, NULL, 'A'},
+        {"period", required_argument, NULL, 'T'},
+        {"periods", required_argument, NULL, 'N'},
+        {"effects", required_argument, NULL, 'e'},
+        {"intensity", required_argument, NULL, 'i'},
+        {"delay", required_argument, NULL, 'y'},
+        {"feedback", required_argument, NULL, 'F'},
+        {"wet", required_argument, NULL, 'W'},
+        {"denoise", required_argument, NULL, 'n'},
+        {"trace", required_argument, NULL, 'Z'},
+        {"plugin", required_argument, NULL, 'x'},
+        {"budget", required_argument, NULL, 'B'},
+        {"perf", required_argument, NULL, 'E'},
+        {NULL, 0, NULL, 0}
+    };
+    int option;
+    char* end;                                  // end of a number parsed from an option
+    while ((option = getopt_long(argc, argv, "svm:Hl:c:b:d:kt:p:r:S:C:D:G:O:P:LX:R:M:A:T:N:e:i:y:F:W:n:Z:x:B:E:", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+            case 's': channels = 2; break;
+            case 'v': verbose = 1; break;
+            case 'm': storeSize = strtoul(optarg, NULL, 10); break;
+            case 'H': hugePages = 1; break;
+            case 'l': liveName = optarg; break;
+            case 'c': countIn = strtoul(optarg, NULL, 10); break;
+            case 'b': beatsPerMeasure = atoi(optarg); break;
+            case 'd': subdivisions = atoi(optarg); break;
+            case 'k': clickAlways = 1; break;
+            case 't': takeID = strtoul(optarg, NULL, 10); break;
+            case 'p': position = atof(optarg); break;
+            case 'r': preRoll = atof(optarg); break;
+            case 'S':
+                splitLevel = -fabsf(strtof(optarg, &end));
+                if (end == optarg || *end != '\0' || splitLevel == 0)
+                {
+                    printf("--split needs a nonzero level in dB, such as %d\n", SPLIT_LEVEL);
+                    return 1;
+                }
+                break;
+            case 'C': cabinet = optarg; break;
+            case 'D': distort = optarg; break;
+            case 'G': drive = atof(optarg); break;
+            case 'O': oversample = atoi(optarg); break;
+            case 'P': pwmRate = atoi(optarg); break;
+            case 'L': limit = 1; break;
+            case 'X': threshold = atof(optarg); break;
+            case 'R': ratio = atof(optarg); break;
+            case 'M': makeup = atof(optarg); break;
+            case 'A': alsaDevice = optarg; break;
+            case 'T': alsaPeriod = strtoul(optarg, NULL, 10); break;
+            case 'N': alsaPeriods = strtoul(optarg, NULL, 10); break;
+            case 'e': switches = strtol(optarg, NULL, 0); break;
+            case 'i': intensity = atoi(optarg); break;
+            case 'y':
+                if (numDelays == DELAY_MAX_TAPS)
+                {
+                    printf("at most %d delay taps can be used\n", DELAY_MAX_TAPS);
+                    return 1;
+                }
+                delaySpecs[numDelays++] = optarg;
+                break;
+            case 'F': feedback = atof(optarg); break;
+            case 'W': wet = atof(optarg); break;
+            case 'n': denoise = atof(optarg); break;
+            case 'Z': tracePath = optarg; break;
+            case 'x':
+                if (numPlugins == DSP_MAX_STAGES - 4)
+                {
+                    printf("at most %d plugins can be loaded\n", DSP_MAX_STAGES - 4);
+                    return 1;
+                }
+                pluginSpecs[numPlugins++] = optarg;
+                break;
+            case 'B': budget = strtoll(optarg, NULL, 10); break;
+            case 'E': perfPeriod = strtoul(optarg, NULL, 10); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    // Messages from the audio loop are printed by a thread of their own so it never blocks
+    if (logInit(stdout))
+    {
+        printf("can't start the log thread\n");
+        return 1;
+    }
+
+    // Put the recording arena in shared memory if other processes are to follow it
+    Share share;                                // segment other processes read the recordings from
+    share.header = NULL;
+    if (liveName != NULL)
+    {
+        if (shareCreate(&share, liveName, storeSize << 20))
+        {
+            printf("can't share %zu MB of recordings as %s\n", storeSize, liveName);
+            return 1;
+        }
+        if (hugePages)
+        {
+            printf("huge pages can't be shared, so the arena uses normal pages\n");
+        }
+    }
+
+    // Reserve memory for recordings before touching any hardware
+    Recording linearTake;                       // recording made in linear mode
+    Recording loopTake;                         // recording made in loop mode
+    Recording history;                          // recent input kept for --pre-roll
+    if ((share.header != NULL ? storeInitShared(share.arena, share.arenaBytes)
+        : storeInit(storeSize << 20, hugePages)) || recordingInit(&linearTake, channels)
+        || recordingInit(&loopTake, channels) || recordingInit(&history, channels))
+    {
+        printf("can't reserve %zu MB for recordings\n", storeSize);
+        return 1;
+    }
+    if (share.header != NULL)
+    {
+        shareWatch(&share, &linearTake, &loopTake);
+    }
+
+    // The history keeps whole chunks, so it holds up to a chunk more than the pre-roll
+    size_t historyChunks = ceilf(preRoll * SAMPLE_RATE / (history.frameMask + 1));
+
+    // Load the index of saved takes
+    TakeStore takes;                            // every recording saved to the website
+    const TakeEntry* saved;                     // take being loaded or saved
+    if (takeStoreOpen(&takes, TAKE_DIR))
+    {
+        printf("can't read the takes in %s, so saving is off\n", TAKE_DIR);
+    }
+    saved = takeID ? takeFind(&takes, takeID) : takeLatest(&takes, 0);
+    Splitter splitter;                          // splits saved linear takes at silences
+    splitInit(&splitter, &takes, splitLevel);
+    if (takeID && saved == NULL)
+    {
+        printf("there is no take %u\n", takeID);
+        return 1;
+    }
+
+    // Quantize the output for the PWM with noise shaping
+    Output output;                              // turns the output into PWM words
+    if (outputInit(&output, pwmRate, CM_FREQUENCY))
+    {
+        printf("can't run the PWM %d times per sample\n", pwmRate);
+        return 1;
+    }
+
+    // Open the ALSA device if one was chosen
+    AlsaOutput alsa;                            // output when playing through ALSA
+    if (alsaDevice != NULL)
+    {
+        if (alsaOpen(&alsa, alsaDevice, channels, alsaPeriod, alsaPeriods))
+        {
+            printf("can't play through %s with %zu-frame periods\n", alsaDevice, alsaPeriod);
+            return 1;
+        }
+        printf("playing through %s: %zu-frame periods, %zu-frame buffer (%.2f ms)\n",
+            alsaDevice, alsa.period, alsa.buffer, alsa.buffer * 1000.0f / SAMPLE_RATE);
+    }
+
     // Initialize peripherals
-    init();
+    init(alsaDevice == NULL);
+    if (alsaDevice == NULL)
+    {
+        pwmFifoInit(output.range);
+    }
+
+    // Record the pins to a trace, or in a replay build, play them from one
+    if (tracePath != NULL)
+    {
+#ifdef REPLAY
+        if (replayOpen(tracePath))
+#else
+        if (traceStart(&trace, tracePath, tracePins, digitalReadAll()))
+#endif
+        {
+            printf("can't trace the pins to %s\n", tracePath);
+            return 1;
+        }
+    }
+
+    // Watch the user interface from a background thread
+    Input ui;                                   // queue of debounced button and switch changes
+    InputEvent event;                           // change taken from the queue
+    if (inputStart(&ui, uiPins, UI_PINS, DEBOUNCE_TIME,
+        trace.active ? tracedEdgeEvents : readEdgeEvents,
+        trace.active ? tracedReadAll : digitalReadAll, INPUT_THREAD))
+    {
+        printf("can't start the input thread\n");
+        return 1;
+    }
+#ifdef REPLAY
+    replayWatch(&ui);
+#endif
+
+    // Estimate pitch from a background thread while in tuner mode
+    Tuner tuner;                                // pitch detector fed with the input in tuner mode
+    if (tunerStart(&tuner, 1))
+    {
+        printf("can't start the tuner thread\n");
+        return 1;
+    }
+
+    // Stretch loops to new tempos from a background thread
+    Stretcher stretcher;                        // plays the loop at a tempo it wasn't recorded at
+    if (stretchInit(&stretcher))
+    {
+        printf("can't start the time-stretch thread\n");
+        return 1;
+    }
+
+    // Process the input with the requested effects from a background thread
+    DspChain effects;                           // block-based effects applied to the input
+    Denoiser denoiser;                          // noise reduction
+    Shaper shaper;                              // distortion
+    Convolver convolver;                        // cabinet simulation
+    Plugin plugins[DSP_MAX_STAGES];             // effects loaded from shared objects
+    Delay delay;                                // echo and chorus
+    float delayTime, depth, rate;               // settings of a delay tap
+    if (dspInit(&effects, channels))
+    {
+        printf("can't allocate the effects queues\n");
+        return 1;
+    }
+    if (denoise > 0)
+    {
+        if (denoiseInit(&denoiser, channels, denoise))
+        {
+            printf("can't reduce noise by %.1f dB\n", denoise);
+            return 1;
+        }
+        dspAdd(&effects, denoiseProcessor(&denoiser));
+        printf("learning the noise for %.1f s (keep the strings quiet)\n",
+            DENOISE_LEARN_TIME / 1000.0f);
+    }
+    if (distort != NULL)
+    {
+        if (shaperInit(&shaper, shaperCurve(distort), oversample, drive, channels))
+        {
+            printf("can't distort with %s oversampled %d times\n", distort, oversample);
+            return 1;
+        }
+        dspAdd(&effects, shaperProcessor(&shaper));
+    }
+    for (int i = 0; i < numPlugins; ++i)
+    {
+        if (pluginLoad(&plugins[i], pluginSpecs[i], channels, budget))
+        {
+            printf("can't load the plugin %s\n", pluginSpecs[i]);
+            return 1;
+        }
+        dspAdd(&effects, pluginProcessor(&plugins[i]));
+        printf("loaded %s (%lld us per block)\n", plugins[i].desc->name, budget);
+    }
+    if (cabinet != NULL)
+    {
+        if (convInit(&convolver, cabinet, channels))
+        {
+            printf("can't load the impulse response %s\n", cabinet);
+            return 1;
+        }
+        dspAdd(&effects, convProcessor(&convolver));
+        printf("convolving with %zu ms of %s\n",
+            convolver.partitions * CONV_BLOCK * 1000 / SAMPLE_RATE, cabinet);
+    }
+    if (numDelays > 0)
+    {
+        if (delayInit(&delay, channels, feedback))
+        {
+            printf("can't delay with %.2f feedback\n", feedback);
+            return 1;
+        }
+        for (int i = 0; i < numDelays; ++i)
+        {
+            depth = rate = 0;
+            if (sscanf(delaySpecs[i], "%f:%f:%f", &delayTime, &depth, &rate) < 1
+                || delayAddTap(&delay, delayTime, depth, rate, wet))
+            {
+                printf("can't add the delay tap %s (from %.1f to %d ms)\n", delaySpecs[i],
+                    DELAY_MIN * 1000.0f / SAMPLE_RATE, DELAY_MAX_TIME);
+                return 1;
+            }
+        }
+        dspAdd(&effects, delayProcessor(&delay));
+    }
+    if (effects.numStages > 0)
+    {
+        if (dspStart(&effects))
+        {
+            printf("can't start the effects thread\n");
+            return 1;
+        }
+        printf("effects add %.2f ms of latency\n", dspLatency(&effects) * 1000.0f / SAMPLE_RATE);
+    }
+
+    // Compress and limit the playback mix from another background thread
+    DspChain master;                            // dynamics applied to the mix
+    Dynamics dynamics;                          // compressor and limiter
+    short mixFrame[MAX_CHANNELS];               // frame of the mix passing through master
+    if (limit)
+    {
+        dynamicsInit(&dynamics, channels, threshold - MIX_HEADROOM, ratio, makeup,
+            DYNAMICS_CEILING - MIX_HEADROOM);
+        if (dspInit(&master, channels) || dspAdd(&master, dynamicsProcessor(&dynamics))
+            || dspStart(&master))
+        {
+            printf("can't start the dynamics thread\n");
+            return 1;
+        }
+        printf("dynamics add %.2f ms of latency\n", dspLatency(&master) * 1000.0f / SAMPLE_RATE);
+    }
+
+    // Apply the FPGA's effects to the first channel in software when asked to
+    Effects fx;                                 // state of the software effects
+    effectsInit(&fx, switches, intensity);
 
     // GPIO variables
     int recording = digitalRead(PIN_RECORD);    // value of the recording switch
@@ -242,70 +797,260 @@ int main()
     int lastReset = 0;                          // previous value of the reset button
     int save = 0;                               // value of the save button
     int lastSave = 0;                           // previous value of the save button
+    size_t resetFrames = 0;                     // frames for which reset has been held
 
     // SPI variables
-    int curNCS = digitalRead(NCS);              // value of NCS
+    int curNCS = readSpi(0);                    // value of NCS
     int lastNCS = curNCS;                       // previous value of NCS
     int curSCLK;                                // value of SCLK
     int lastSCLK;                               // previous value of SCLK
     int reading;                                // true when in the middle of an SPI read
-    short input;                                // sample received over SPI
-    short lastInput;                            // previous sample received over SPI
+    int word;                                   // bits received in the current SPI read
+    unsigned short bits;                        // first channel's sample for the software effects
+    short input[MAX_CHANNELS] = {0};            // samples received over SPI (one per channel)
     int bitsIn;                                 // number of bits received in current SPI read
+    int frameBits = channels * INPUT_BITS;      // number of bits the FPGA sends per frame
 
     // Recording variables
-    size_t recordIndex = loadRecording(buffer); // next index in buffer for recording
-    size_t playIndex = 0;                       // next index in buffer for playback
+    Recording* take;                            // recording for the current mode
+    size_t playIndex = 0;                       // next frame in take for playback
+    short* frame;                               // frame of take being recorded or played
+    char path[TAKE_PATH];                       // path of the take being loaded
+    Recording swap;                             // take being swapped with the history
 
     // Looping variables
     size_t measures = 4;                        // length of loop in measures
     size_t beatTime = SAMPLE_RATE / 2;          // number of samples per beat
-    size_t beatTimeCounter = 0;                 // counter to keep track of beats
-    size_t loopMaxIndex = measures * beatTime * 4;  // maximum index in buffer for the current loop
+    size_t loopMaxIndex = measures * beatTime * beatsPerMeasure;    // frames in the current loop
+    size_t loopBeatTime = beatTime;             // samples per beat when the loop was recorded
+    size_t loopFrames;                          // frames in the loop at the tempo it was recorded
+    int stretching = 0;                         // whether the loop is played through stretcher
+    short stretchFrame[MAX_CHANNELS];           // frame of the stretched loop being played
     size_t loopCountdownCounts = 0;             // counts remaining in countdown before recording
-    struct timeval curTime;                     // current time (used for calculating tempo)
-    struct timeval lastTime;                    // last time that the tempo button was pressed
+    long long startTime = 0;                    // time in us the start button was last pressed
+    long long lastTap = 0;                      // time in us the tempo was last tapped
+    Metronome metronome;                        // keeps track of beats and plays clicks
+    short click = 0;                            // click sample to add to the output
+
+    // Restore a take by mapping it rather than reading it; loop takes also restore the tempo
+    // and length of the loop
+    if (saved != NULL)
+    {
+        take = saved->measures ? &loopTake : &linearTake;
+        if (saved->measures)
+        {
+            beatTime = saved->beatTime;
+            beatsPerMeasure = saved->beatsPerMeasure;
+            measures = saved->measures;
+            loopMaxIndex = measures * beatTime * beatsPerMeasure;
+            loopBeatTime = beatTime;
+        }
+        if (takeLoad(&takes, saved, take))
+        {
+            takePath(&takes, saved, path);
+            loadRecording(take, path);
+        }
+        playIndex = takeSeek(saved, position);
+    }
+    else
+    {
+        loadRecording(&linearTake, RECORDING_PATH);
+    }
+    metronomeInit(&metronome, beatTime, beatsPerMeasure, subdivisions);
+
+    // Tuner variables
+    int tuning = 0;                             // whether in tuner mode
+    size_t tunerFrames = 0;                     // frames since entering tuner mode (for blinking)
+    int note;                                   // MIDI note detected by the tuner (-1 if none)
+    int cents;                                  // offset of the detected pitch from note
 
     // Other variables
-    size_t inputSamples = 0;                    // counter used to debounce input
     int running = 0;                            // whether the current function should run or pause
-    float dut;                                  // PMW duty cycle (between 0 and 1)
+    float dut[MAX_CHANNELS] = {0};              // PMW duty cycle of each channel (between 0 and 1)
+    float jack[2];                              // duty cycle of each side of the audio jack
+    unsigned int pwmWords[2 * OUTPUT_MAX_RATE]; // PWM words for the current frame
+    int pwmSent = 0;                            // words of pwmWords written to the PWM FIFO
+    int pwmPending = 0;                         // words of pwmWords still to be written
+    size_t pwmDropped = 0;                      // words dropped because the FIFO fell behind
+    short alsaFrame[MAX_CHANNELS];              // frame played through ALSA
+    float sample;                               // sample being converted to 16 bits
+    int c;                                      // channel index
+
+    // Frame budget variables (only used in verbose mode)
+    struct timespec processStart;               // time at which we started processing a frame
+    struct timespec waitStart;                  // time at which we started waiting for the FPGA
+    struct timespec captureStart;               // time at which NCS was lowered
+    float processTime = 0;                      // total microseconds spent processing frames
+    float waitTime = 0;                         // total microseconds spent waiting for NCS
+    float captureTime = 0;                      // total microseconds spent reading bits
+    size_t statsFrames = 0;                     // number of frames since the last report
+    size_t reserved, committed, inUse;          // memory used by the recording arena
 
     // Get device's IP address
     char IPAddress[16];
     getIPAddress(IPAddress);
 
-    printf("starting...\n");
+    // Count this thread's events in each stage of the loop (the other threads aren't counted)
+    Perf perf;                                  // hardware counters read around each stage
+    perf.group = -1;
+    perf.measuring = 0;
+    if (perfPeriod > 0 && perfOpen(&perf, perfPeriod))
+    {
+        printf("can't open the performance counters (the receiver needs make PERF=1, and\n"
+            "/proc/sys/kernel/perf_event_paranoid must be 2 or less)\n");
+        return 1;
+    }
 
-    // One iteration of this loop corresponds to one sample from the FPGA
+    logPrint("starting with %d channel%s...\n", channels, channels > 1 ? "s" : "");
+
+    // One iteration of this loop corresponds to one frame (one sample per channel) from the FPGA
     while (1)
     {
+        // Account for the time spent on the previous frame
+        if (verbose)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &processStart);
+            if (statsFrames)
+            {
+                captureTime += microsBetween(&captureStart, &processStart);
+            }
+            if (++statsFrames > SAMPLE_RATE * STATS_TIME)
+            {
+                statsFrames--;
+                logPrint("per frame: %.2f us processing, %.2f us capture (%.2f us per channel), "
+                    "%.2f us idle\n", processTime / statsFrames, captureTime / statsFrames,
+                    captureTime / statsFrames / channels, waitTime / statsFrames);
+                storeUsage(&reserved, &committed, &inUse);
+                logPrint("recordings: %zu MB in use, %zu MB committed, %zu MB reserved\n",
+                    inUse >> 20, committed >> 20, reserved >> 20);
+                if (historyChunks > 0)
+                {
+                    logPrint("pre-roll: %.1f s held in %zu KB\n",
+                        (float)history.frames / SAMPLE_RATE,
+                        history.usedChunks * CHUNK_SAMPLES * sizeof(short) >> 10);
+                }
+                if (stretching)
+                {
+                    logPrint("time-stretch: %zu frames late\n", stretcher.underruns);
+                }
+                if (effects.numStages > 0)
+                {
+                    logPrint("effects: %zu frames late\n", effects.underruns);
+                }
+                for (int i = 0; i < numPlugins; ++i)
+                {
+                    logPrint("%s: %.1f us average, %.1f us worst per block%s\n",
+                        plugins[i].desc->name,
+                        plugins[i].blocks ? plugins[i].total / 1000.0 / plugins[i].blocks : 0,
+                        plugins[i].worst / 1000.0, plugins[i].bypassed ? " (bypassed)" : "");
+                }
+                if (limit)
+                {
+                    logPrint("dynamics: %.1f dB compression, up to %.1f dB limiting, %zu frames "
+                        "late\n", atomic_load(&dynamics.compReduction) / 100.0f,
+                        atomic_exchange(&dynamics.limitReduction, 0) / 100.0f,
+                        master.underruns);
+                }
+                if (tracePath != NULL)
+                {
+                    logPrint("trace: %.1f MB written, %zu chunks dropped\n",
+                        trace.written / 1e6, trace.dropped);
+                }
+                if (alsaDevice != NULL)
+                {
+                    logPrint("alsa: %.2f ms latency, %zu underruns, %zu periods dropped\n",
+                        alsaLatency(&alsa) * 1000.0f / SAMPLE_RATE, alsa.xruns, alsa.dropped);
+                }
+                else
+                {
+                    logPrint("pwm: %zu words dropped\n", pwmDropped);
+                }
+                processTime = waitTime = captureTime = 0;
+                statsFrames = 1;
+            }
+        }
+        PERF_FRAME(&perf);
+
         ////////////////////////////////
         //  Handle GPIO
         ////////////////////////////////
 
-        // Allow inputs to debounce before reading
-        inputSamples++;
-        if (inputSamples / (SAMPLE_RATE / 1000) > DEBOUNCE_TIME)
+        // Apply at most one change per frame, so a press and its release queued together are
+        // still seen as a rising edge on one frame and a falling edge on the next
+        if (inputNext(&ui, &event))
         {
-            recording = digitalRead(PIN_RECORD);
-            looping = digitalRead(PIN_LOOP);
-            start = digitalRead(PIN_START);
-            reset = digitalRead(PIN_RESET);
-            save = digitalRead(PIN_SAVE);
-            inputSamples = 0;
+            switch (event.pin)
+            {
+                case PIN_RECORD: recording = event.level; break;
+                case PIN_LOOP: looping = event.level; break;
+                case PIN_START: start = event.level; startTime = event.time; break;
+                case PIN_RESET: reset = event.level; break;
+                case PIN_SAVE: save = event.level; break;
+            }
         }
 
-        // Reset state when changing to and from looping mode
+        // Linear and loop mode keep separate recordings
+        take = looping ? &loopTake : &linearTake;
+
+        // Reset state when changing to and from looping mode; an unfinished loop is discarded
+        // so that it is recorded again from the start, and a finished one follows the tempo
+        loopFrames = measures * loopBeatTime * beatsPerMeasure;
         if (looping != lastLooping)
         {
             running = 0;
             playIndex = 0;
-            recordIndex = 0;
+            recordingClear(&history);
+            stretchStop(&stretcher);
+            stretching = 0;
+            if (looping && (stretching = stretchLoop(&stretcher, &loopTake, loopFrames,
+                loopMaxIndex)) < 0)
+            {
+                recordingClear(&loopTake);
+                stretching = 0;
+            }
+        }
+
+        // Clicks are only played in loop mode
+        click = 0;
+
+        // Holding reset in linear play mode enters and leaves tuner mode; changing either switch
+        // also leaves tuner mode
+        resetFrames = reset ? resetFrames + 1 : 0;
+        if ((!looping && !recording && resetFrames == (size_t)TUNER_HOLD * SAMPLE_RATE / 1000)
+            || (tuning && (looping != lastLooping || recording != lastRecording)))
+        {
+            tuning = !tuning;
+            tunerFrames = 0;
+            running = 0;
+            if (tuning)
+            {
+                tunerRequestReset(&tuner);
+            }
+            logPrint(tuning ? "tuner on\n" : "tuner off\n");
+        }
+
+        // Tuner mode: light the LED when in tune, blink slowly when flat and quickly when sharp
+        if (tuning)
+        {
+            note = atomic_load(&tuner.note);
+            cents = atomic_load(&tuner.cents);
+            tunerFrames++;
+            if (note < 0)
+            {
+                digitalWrite(PIN_LED, 0);
+            }
+            else if (abs(cents) <= IN_TUNE)
+            {
+                digitalWrite(PIN_LED, 1);
+            }
+            else
+            {
+                digitalWrite(PIN_LED, (tunerFrames / (SAMPLE_RATE / (cents < 0 ? 4 : 16))) & 1);
+            }
         }
 
         // Linear recording mode (not looping)
-        if (!looping)
+        else if (!looping)
         {
             // If user switches between play and recording mode, stop playing/recording
             if (recording != lastRecording)
@@ -313,10 +1058,22 @@ int main()
                 running = 0;
             }
 
-            // Handle "start" button
+            // Handle "start" button; a new take in recording mode starts with the history,
+            // whose chunks become the take's without copying a sample
             if (start && !lastStart)
             {
                 running = !running;
+                if (running && recording && historyChunks > 0)
+                {
+                    if (take->frames == 0)
+                    {
+                        swap = *take;
+                        *take = history;
+                        history = swap;
+                        logPrint("kept %.1f s of pre-roll\n", (float)take->frames / SAMPLE_RATE);
+                    }
+                    recordingClear(&history);
+                }
             }
 
             // Handle "reset" button
@@ -324,7 +1081,7 @@ int main()
             {
                 if (recording)
                 {
-                    recordIndex = 0;
+                    recordingClear(take);
                 }
                 playIndex = 0;
                 running = 0;
@@ -341,14 +1098,18 @@ int main()
             // The "recording" switch place the device in settings mode
             if (recording)
             {
-                // Use the start button to set the tempo
+                // Use the start button to set the tempo from the time between two taps; the
+                // first tap after a pause only starts the count
                 if (start && !lastStart)
                 {
-                    gettimeofday(&curTime, NULL);
-                    beatTime = ((curTime.tv_sec - lastTime.tv_sec) * 1000000
-                        + curTime.tv_usec - lastTime.tv_usec) * 48 / 1000;
-                    lastTime = curTime;
-                    loopMaxIndex = measures * beatTime * 4;
+                    if (lastTap && startTime > lastTap
+                        && startTime - lastTap <= TAP_TIMEOUT * 1000)
+                    {
+                        beatTime = (startTime - lastTap) * 48 / 1000;
+                        loopMaxIndex = measures * beatTime * beatsPerMeasure;
+                        metronomeSetTempo(&metronome, beatTime);
+                    }
+                    lastTap = startTime;
                 }
 
                 // Use the reset button to increase the number of measures
@@ -356,7 +1117,7 @@ int main()
                 {
                     measures = (measures >= MAX_MEASURES) ? 1 : measures * 2;
                     flashLED((int)(log2(measures)) + 1);
-                    loopMaxIndex = measures * beatTime * 4;
+                    loopMaxIndex = measures * beatTime * beatsPerMeasure;
                 }
 
                 running = 0;
@@ -369,16 +1130,41 @@ int main()
                     running = !running;
                 }
 
+                // Switching out of settings mode keeps a finished loop if only the tempo
+                // changed, stretching it to the new tempo
+                if (lastRecording)
+                {
+                    stretching = stretchLoop(&stretcher, &loopTake, loopFrames, loopMaxIndex);
+                    if (stretching > 0)
+                    {
+                        logPrint("stretching the loop to %.2f s\n",
+                            (float)loopMaxIndex / SAMPLE_RATE);
+                    }
+                }
+                if (lastRecording && stretching >= 0)
+                {
+                    playIndex = 0;
+                    metronomeStart(&metronome);
+                    loopCountdownCounts = 0;
+                    running = 1;
+                }
+
                 // Use the reset button to record a new loop
                 // also reset when switching out of settings mode
-                if ((reset && !lastReset) || lastRecording)
+                else if ((reset && !lastReset) || lastRecording)
                 {
-                    recordIndex = 0;
+                    stretchStop(&stretcher);
+                    stretching = 0;
+                    recordingClear(take);
+                    loopBeatTime = beatTime;
                     playIndex = 0;
-                    beatTimeCounter = 0;
-                    loopCountdownCounts = LOOP_COUNTDOWN;
+                    metronomeStart(&metronome);
+                    loopCountdownCounts = countIn;
                     running = 1;
-                    dut = 0;
+                    for (c = 0; c < channels; ++c)
+                    {
+                        dut[c] = 0;
+                    }
                     usleep(LOOP_DELAY * 1000);
                 }
             }
@@ -386,24 +1172,53 @@ int main()
             // Count beats if running or in settings mode
             if (running || recording)
             {
-                ++beatTimeCounter;
-                if (beatTimeCounter >= beatTime)
+                click = metronomeNext(&metronome);
+                if (metronomeOnBeat(&metronome))
                 {
-                    beatTimeCounter = 0;
                     loopCountdownCounts = loopCountdownCounts > 0 ? loopCountdownCounts - 1 : 0;
                 }
             }
 
+            // Only click during the countdown unless asked to click throughout the loop
+            if (recording || (!loopCountdownCounts && !clickAlways))
+            {
+                click = 0;
+            }
+
             // Flash LED to indicate beats when running or in settings mode
-            digitalWrite(PIN_LED, (running || recording) && beatTimeCounter < beatTime / 4);
+            digitalWrite(PIN_LED, (running || recording) && metronome.tick == 0
+                && metronome.counter < metronome.beatTime / 4);
         }
 
-        // Handle "save" button
-        if (save && !lastSave)
+        // Handle "save" button; the takes can't be touched while the last one is being split
+        if (save && !lastSave && splitBusy(&splitter))
         {
-            printf("saving...\n");
-            saveRecording(buffer, recordIndex);
-            printf("your recording is available at http://%s/recording.wav\n", IPAddress);
+            logPrint("still splitting take %04u\n", splitter.take.id);
+        }
+        else if (save && !lastSave && takes.readOnly)
+        {
+            logPrint("can't save: the index of takes in %s can't be written\n", TAKE_DIR);
+        }
+        else if (save && !lastSave)
+        {
+            logPrint("saving...\n");
+            saved = saveRecording(&takes, take, loopBeatTime, beatsPerMeasure,
+                looping ? measures : 0);
+            if (saved != NULL)
+            {
+                logPrint("your recording is available at http://%s/takes/take-%04u.wav\n",
+                    IPAddress, saved->id);
+
+                // Split linear takes into songs in the background
+                if (splitLevel < 0 && !looping && splitStart(&splitter, saved))
+                {
+                    logPrint("can't split take %04u\n", saved->id);
+                }
+            }
+            else
+            {
+                logPrint("can't save the recording\n");
+            }
             flashLED(3);
             running = 0;
         }
@@ -420,21 +1235,33 @@ int main()
         ////////////////////////////////
         //  Calculate next dut
         ////////////////////////////////
-
-        // Play clicks for the loop countdown
-        if (looping && loopCountdownCounts > 0)
-        {
-            dut = ((float)(beatTime - beatTimeCounter)) / beatTime * CLICK_VOLUME;
-        }
+        PERF_MARK(&perf, PERF_CONTROL);
 
         // If in play mode, combine the input with the recording
-        else if (running && ((!looping && !recording) || (looping && recordIndex == loopMaxIndex)))
+        if (running && ((!looping && !recording)
+            || (looping && (take->frames == loopMaxIndex || stretching))))
         {
-            dut = ((float)input + buffer[playIndex]) / (1 << 15);
+            if (stretching)
+            {
+                stretchNext(&stretcher, stretchFrame);
+                frame = stretchFrame;
+            }
+            else
+            {
+                frame = recordingFrame(take, playIndex);
+                if ((playIndex & take->frameMask) == 0)
+                {
+                    recordingPrefetch(take, playIndex);
+                }
+            }
+            for (c = 0; c < channels; ++c)
+            {
+                dut[c] = ((float)input[c] + frame[c]) / (1 << 15);
+            }
             playIndex++;
 
             // Upon reaching the end of the recording, return to the start
-            if (playIndex >= recordIndex)
+            if (playIndex >= (stretching ? loopMaxIndex : take->frames))
             {
                 playIndex = 0;
                 running = looping;  // stop running if not looping
@@ -442,70 +1269,144 @@ int main()
         }
         else
         {
-            dut = ((float)input) / (1 << 15);
+            for (c = 0; c < channels; ++c)
+            {
+                dut[c] = ((float)input[c]) / (1 << 15);
+            }
         }
 
-        // Bias dut so that it is alaways positive
-        dut = (dut / 2) + 0.5;
+        // Compress and limit the mix, which is carried at half scale so that it can't clip first
+        if (limit)
+        {
+            for (c = 0; c < channels; ++c)
+            {
+                sample = dut[c] * (1 << 14);
+                mixFrame[c] = sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample;
+            }
+            dspExchange(&master, mixFrame);
+            for (c = 0; c < channels; ++c)
+            {
+                dut[c] = (float)mixFrame[c] / (1 << 14);
+            }
+        }
+
+        // Add clicks for the loop countdown and bias dut so that it is alaways positive
+        for (c = 0; c < channels; ++c)
+        {
+            dut[c] = ((dut[c] + (float)click / (1 << 15)) / 2) + 0.5;
+        }
 
 
 
         ////////////////////////////////
         //  Handle SPI
         ////////////////////////////////
+        PERF_MARK(&perf, PERF_MIX);
 
         // Reset SPI variables
         bitsIn = 0;
-        lastInput = input;
-        input = 0;
+        word = 0;
         reading = 0;
 
+        if (verbose)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &waitStart);
+            processTime += microsBetween(&processStart, &waitStart);
+        }
+
         // Read from SPI
         while (1)
         {
-            curNCS = digitalRead(NCS);
+            curNCS = readSpi(0);
 
             // NCS is low and we are reading
             if (reading)    
             {
-                curSCLK = digitalRead(SCLK);
+                curSCLK = readSpi(1);
 
                 // Read one bit on the positive edge of SCLK
                 if (!lastSCLK && curSCLK)
                 {
-                    input = (input << 1) + digitalRead(MOSI);
+                    word = (word << 1) + readSpi(2);
                     bitsIn++;
 
                     // Stop reading once NCS is raised or we read all bits
-                    if (curNCS || bitsIn >= INPUT_BITS)
+                    if (curNCS || bitsIn >= frameBits)
                     {
-                        // Convert 11-bit sign-magnitude to 16-bit 2's complement
-                        if ((input >> 10) & 0x1)
+                        // Convert each channel's 11-bit sign-magnitude to 16-bit 2's complement
+                        // (the FPGA sends channel 0 first); don't use the samples if the SPI
+                        // transfer failed
+                        if (!curNCS)
+                        {
+                            for (c = 0; c < channels; ++c)
+                            {
+                                input[c] = decodeSample(word >> ((channels - 1 - c) * INPUT_BITS));
+                            }
+                            if (switches >= 0)
+                            {
+                                bits = (word >> ((channels - 1) * INPUT_BITS)) & 0x7FF;
+                                effectsProcess(&fx, &bits, &input[0], 1);
+                            }
+                        }
+
+                        // Replace the input with the output of the effects
+                        if (effects.numStages > 0)
                         {
-                            input = -(input & 0x3FF);
+                            dspExchange(&effects, input);
                         }
-                        input *= VOLUME;
 
-                        // Don't use the sample if the SPI transfer failed
-                        if (curNCS)
+                        // Pass the first channel to the tuner thread
+                        if (tuning)
                         {
-                            input = lastInput;
+                            tunerPush(&tuner, input[0]);
                         }
 
-                        // If recording, add the sample to the recording buffer
-                        if (running && (!looping && recording) || (looping
-                            && !loopCountdownCounts && recordIndex < loopMaxIndex))
+                        PERF_MARK(&perf, PERF_CAPTURE);
+
+                        // If recording, add the frame to the recording
+                        // (in loop mode, only once counted in, and never in settings mode)
+                        if (running && ((!looping && recording) || (looping && !recording
+                            && !loopCountdownCounts && !stretching && take->frames < loopMaxIndex)))
                         {
-                            buffer[recordIndex] = input;
-                            recordIndex++;
+                            frame = recordingAppend(take);
+                            for (c = 0; frame != NULL && c < channels; ++c)
+                            {
+                                frame[c] = input[c];
+                            }
 
-                            // Stop recording if we fill up the recording buffer
-                            if (recordIndex >= BUF_SIZE)
+                            // Stop recording if we fill up the recording arena
+                            if (frame == NULL)
                             {
                                 running = 0;
-                                recordIndex = 0;
                             }
                         }
+
+                        // Otherwise keep the input in the history in linear mode, dropping
+                        // its oldest chunk whenever it starts a new one
+                        else if (historyChunks > 0 && !looping)
+                        {
+                            frame = recordingAppendRecent(&history, historyChunks);
+                            for (c = 0; frame != NULL && c < channels; ++c)
+                            {
+                                frame[c] = input[c];
+                            }
+                        }
+
+                        // Let other processes follow the recordings and the mode
+                        if (share.header != NULL)
+                        {
+                            share.state.mode = (looping ? LIVE_LOOPING : 0)
+                                | (recording ? LIVE_RECORDING : 0) | (running ? LIVE_RUNNING : 0)
+                                | (loopCountdownCounts ? LIVE_COUNTING : 0)
+                                | (stretching ? LIVE_STRETCHING : 0) | (tuning ? LIVE_TUNING : 0);
+                            share.state.current = looping ? LIVE_LOOP : LIVE_LINEAR;
+                            share.state.playIndex = playIndex;
+                            share.state.loopFrames = loopMaxIndex;
+                            share.state.beatFrames = beatTime;
+                            share.state.beatsPerMeasure = beatsPerMeasure;
+                            shareFrame(&share);
+                        }
+                        PERF_MARK(&perf, PERF_RECORD);
                         break;
                     }
                 }
@@ -515,11 +1416,59 @@ int main()
             // We are waiting for NCS to go low
             else if (lastNCS && !curNCS)
             {
-                setPWM(SAMPLE_RATE / 2, dut);   // set output volume with PWM
+                if (verbose)
+                {
+                    clock_gettime(CLOCK_MONOTONIC, &captureStart);
+                    waitTime += microsBetween(&waitStart, &captureStart);
+                }
+                PERF_MARK(&perf, PERF_WAIT);
+
+                // Play the output through ALSA, undoing the PWM's offset and halving
+                if (alsaDevice != NULL)
+                {
+                    for (c = 0; c < channels; ++c)
+                    {
+                        sample = (dut[c] - 0.5f) * (1 << 16);
+                        alsaFrame[c] = sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample;
+                    }
+                    alsaWrite(&alsa, alsaFrame);
+                }
+
+                // Queue the output for the PWM (mono plays on both sides of the audio jack);
+                // words of the last frame still waiting go first if the FIFO has room and are
+                // dropped otherwise, so the output never falls behind the input
+                else
+                {
+                    while (pwmPending && !pwmFifoFull())
+                    {
+                        pwmFifoWrite(pwmWords[pwmSent++]);
+                        pwmPending--;
+                    }
+                    pwmDropped += pwmPending;
+                    jack[0] = dut[0];
+                    jack[1] = dut[channels - 1];
+                    outputFrame(&output, jack, pwmWords);
+                    pwmSent = 0;
+                    pwmPending = 2 * output.rate;
+                }
+                if (trace.active)
+                {
+                    traceFrame(&trace);
+                }
+                PERF_MARK(&perf, PERF_OUTPUT);
                 reading = 1;
-                curSCLK = digitalRead(SCLK);
+                curSCLK = readSpi(1);
                 lastSCLK = curSCLK;
             }
+
+            // While waiting for the next frame, feed the PWM a word whenever one is waiting and
+            // its FIFO has room (never while reading bits, where the extra read of its status
+            // could miss an edge of SCLK)
+            else if (pwmPending && !pwmFifoFull())
+            {
+                pwmFifoWrite(pwmWords[pwmSent++]);
+                pwmPending--;
+            }
             lastNCS = curNCS;
         }
     }
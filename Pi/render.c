@@ -0,0 +1,437 @@
+// Date: 10/19/2026
+// Summary: Re-renders a directory of recordings through the effects chain on every core
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include "wav.h"
+#include "dsp.h"
+#include "conv.h"
+#include "shaper.h"
+#include "dynamics.h"
+#include "denoise.h"
+
+////////////////////////////////
+//  Constants and Types
+////////////////////////////////
+
+#define READ_FRAMES (128 * DSP_BLOCK)   // frames read from a file at once
+#define MAX_PATH 512                    // longest path handled
+
+/**
+ * \brief Settings shared by every worker
+ */
+typedef struct
+{
+    const char* inDir;          // directory of recordings to render
+    const char* outDir;         // directory to write the rendered recordings to
+    char** names;               // names of the .wav files in inDir
+    size_t numNames;            // number of names
+    atomic_size_t next;         // next name to be claimed by a worker
+    atomic_size_t frames;       // frames rendered by all workers
+    atomic_int failures;        // files which could not be rendered
+    float denoise;              // largest noise reduction in dB (0 for none)
+    const char* cabinet;        // impulse response to convolve with (NULL for none)
+    ShaperCurve curve;          // distortion curve (SHAPER_CURVES for none)
+    float drive;                // gain in dB before the distortion curve
+    int oversample;             // oversampling factor of the distortion
+    int limit;                  // whether to compress and limit after the gain
+    float threshold;            // level in dB at which compression starts
+    float ratio;                // compression ratio
+    float makeup;               // gain in dB after compression
+    float gain;                 // linear gain applied after the effects
+} Job;
+
+/**
+ * \brief State of one worker (each has its own copy of every stateful effect)
+ */
+typedef struct
+{
+    Job* job;                   // work shared by all workers
+    DspChain chain;             // effects applied to each file
+    Shaper shaper;              // distortion
+    Dynamics dynamics;          // compressor and limiter
+    Denoiser denoiser;          // noise reduction
+    Convolver convolver;        // cabinet simulation
+    short samples[READ_FRAMES * MAX_CHANNELS];      // interleaved frames read from the file
+    float planes[MAX_CHANNELS][READ_FRAMES];        // samples of each channel
+    pthread_t thread;           // thread running the worker
+} Worker;
+
+////////////////////////////////
+//  Functions
+////////////////////////////////
+
+/**
+ * \brief Multiply a block by a constant gain
+ */
+static void gainProcess(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    float gain = *(float*)state;
+    for (int c = 0; c < numChannels; ++c)
+    {
+        for (size_t i = 0; i < frames; ++i)
+        {
+            channels[c][i] *= gain;
+        }
+    }
+}
+
+/**
+ * \brief Render one file, reading, processing and writing a few thousand frames at a time
+ *
+ * \returns frames rendered, or -1 if the file could not be rendered
+ */
+static long renderFile(Worker* w, const char* name)
+{
+    char inPath[MAX_PATH];
+    char outPath[MAX_PATH];
+    float* block[MAX_CHANNELS];
+    WavInfo info;
+    FILE* in;
+    FILE* out;
+    size_t done = 0;
+    size_t frames, padded, i;
+    float sample;
+    int c;
+
+    snprintf(inPath, MAX_PATH, "%s/%s", w->job->inDir, name);
+    snprintf(outPath, MAX_PATH, "%s/%s", w->job->outDir, name);
+    in = fopen(inPath, "rb");
+    if (in == NULL || wavReadHeader(in, &info) || info.channels > MAX_CHANNELS
+        || info.sampleRate != SAMPLE_RATE)
+    {
+        if (in != NULL)
+        {
+            fclose(in);
+        }
+        return -1;
+    }
+    out = fopen(outPath, "wb");
+    if (out == NULL)
+    {
+        fclose(in);
+        return -1;
+    }
+    wavWriteHeader(out, info.channels, info.frames);
+
+    // Every file starts from silence (and its noise is learned from its first moments)
+    w->chain.channels = info.channels;
+    if (w->job->denoise > 0)
+    {
+        denoiseReset(&w->denoiser);
+    }
+    if (w->job->curve != SHAPER_CURVES)
+    {
+        shaperReset(&w->shaper);
+    }
+    if (w->job->cabinet != NULL)
+    {
+        convReset(&w->convolver);
+    }
+    if (w->job->limit)
+    {
+        dynamicsReset(&w->dynamics);
+    }
+
+    while (done < info.frames)
+    {
+        frames = info.frames - done < READ_FRAMES ? info.frames - done : READ_FRAMES;
+        frames = fread(w->samples, info.channels * sizeof(short), frames, in);
+        if (frames == 0)
+        {
+            break;
+        }
+
+        // Pad the last block with silence, since the effects work on whole blocks
+        padded = (frames + DSP_BLOCK - 1) / DSP_BLOCK * DSP_BLOCK;
+        for (c = 0; c < info.channels; ++c)
+        {
+            for (i = 0; i < padded; ++i)
+            {
+                w->planes[c][i] = i < frames ? w->samples[i * info.channels + c]
+                    * (1.0f / (1 << 15)) : 0;
+            }
+        }
+        for (i = 0; i < padded; i += DSP_BLOCK)
+        {
+            for (c = 0; c < info.channels; ++c)
+            {
+                block[c] = w->planes[c] + i;
+            }
+            dspProcess(&w->chain, block, DSP_BLOCK);
+        }
+
+        for (i = 0; i < frames; ++i)
+        {
+            for (c = 0; c < info.channels; ++c)
+            {
+                sample = w->planes[c][i] * (1 << 15);
+                sample = sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample;
+                w->samples[i * info.channels + c] = (short)lrintf(sample);
+            }
+        }
+        fwrite(w->samples, info.channels * sizeof(short), frames, out);
+        done += frames;
+    }
+
+    fclose(in);
+    return fclose(out) == 0 && done == info.frames ? (long)done : -1;
+}
+
+/**
+ * \brief Render files until none are left
+ */
+static void* workerThread(void* arg)
+{
+    Worker* w = arg;
+    Job* job = w->job;
+    size_t index;
+    long frames;
+
+    while ((index = atomic_fetch_add(&job->next, 1)) < job->numNames)
+    {
+        frames = renderFile(w, job->names[index]);
+        if (frames < 0)
+        {
+            printf("can't render %s\n", job->names[index]);
+            atomic_fetch_add(&job->failures, 1);
+        }
+        else
+        {
+            atomic_fetch_add(&job->frames, frames);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief Set up a worker's effects
+ *
+ * \returns 0 on success, -1 on failure
+ */
+static int workerInit(Worker* w, Job* job)
+{
+    DspProcessor gain = {"gain", &job->gain, gainProcess, 0};
+
+    w->job = job;
+    if (dspInit(&w->chain, MAX_CHANNELS))
+    {
+        return -1;
+    }
+    if (job->denoise > 0)
+    {
+        if (denoiseInit(&w->denoiser, MAX_CHANNELS, job->denoise))
+        {
+            return -1;
+        }
+        dspAdd(&w->chain, denoiseProcessor(&w->denoiser));
+    }
+    if (job->curve != SHAPER_CURVES)
+    {
+        if (shaperInit(&w->shaper, job->curve, job->oversample, job->drive, MAX_CHANNELS))
+        {
+            return -1;
+        }
+        dspAdd(&w->chain, shaperProcessor(&w->shaper));
+    }
+    if (job->cabinet != NULL)
+    {
+        if (convInit(&w->convolver, job->cabinet, MAX_CHANNELS))
+        {
+            return -1;
+        }
+        dspAdd(&w->chain, convProcessor(&w->convolver));
+    }
+    if (job->gain != 1)
+    {
+        dspAdd(&w->chain, gain);
+    }
+    if (job->limit)
+    {
+        dynamicsInit(&w->dynamics, MAX_CHANNELS, job->threshold, job->ratio, job->makeup,
+            DYNAMICS_CEILING);
+        dspAdd(&w->chain, dynamicsProcessor(&w->dynamics));
+    }
+    return 0;
+}
+
+/**
+ * \brief Collect the names of the .wav files in a directory
+ *
+ * \returns 0 on success, -1 if the directory could not be read
+ */
+static int findRecordings(Job* job)
+{
+    DIR* dir = opendir(job->inDir);
+    struct dirent* entry;
+    size_t length;
+    size_t capacity = 0;
+    char** names;
+
+    if (dir == NULL)
+    {
+        return -1;
+    }
+    job->names = NULL;
+    job->numNames = 0;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        length = strlen(entry->d_name);
+        if (length < 4 || strcasecmp(entry->d_name + length - 4, ".wav"))
+        {
+            continue;
+        }
+        if (job->numNames == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            names = realloc(job->names, capacity * sizeof(char*));
+            if (names == NULL)
+            {
+                closedir(dir);
+                return -1;
+            }
+            job->names = names;
+        }
+        job->names[job->numNames++] = strdup(entry->d_name);
+    }
+    closedir(dir);
+    return 0;
+}
+
+/**
+ * \brief Print command line usage
+ */
+static void usage(const char* program)
+{
+    printf("usage: %s [options] INPUT_DIR OUTPUT_DIR\n", program);
+    printf("  -n, --denoise DB  reduce noise by up to DB, learning it from the first %.1f s of\n",
+        DENOISE_LEARN_TIME / 1000.0f);
+    printf("                    each file\n");
+    printf("  -C, --cabinet WAV convolve with an impulse response (such as a cabinet)\n");
+    printf("  -D, --distort C   distort with curve C (hard, soft or cubic)\n");
+    printf("  -G, --drive DB    gain before the distortion curve (default %d)\n", SHAPER_DRIVE);
+    printf("  -O, --oversample N oversample the distortion 1, 2, 4 or 8 times (default 8)\n");
+    printf("  -g, --gain DB     gain applied after the effects (default 0)\n");
+    printf("  -L, --limit       compress and limit after the gain\n");
+    printf("  -X, --threshold DB  level at which compression starts (default %d)\n",
+        DYNAMICS_THRESHOLD);
+    printf("  -R, --ratio R     compression ratio, 1 to only limit (default %d)\n", DYNAMICS_RATIO);
+    printf("  -M, --makeup DB   gain after compression (default 0)\n");
+    printf("  -j, --jobs N      number of files rendered at once (default: one per core)\n");
+}
+
+int main(int argc, char** argv)
+{
+    Job job = {0};
+    Worker* workers;
+    int numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+    struct timespec start, end;
+    double seconds;
+    static struct option options[] = {
+        {"denoise", required_argument, NULL, 'n'},
+        {"cabinet", required_argument, NULL, 'C'},
+        {"distort", required_argument, NULL, 'D'},
+        {"drive", required_argument, NULL, 'G'},
+        {"oversample", required_argument, NULL, 'O'},
+        {"gain", required_argument, NULL, 'g'},
+        {"limit", no_argument, NULL, 'L'},
+        {"threshold", required_argument, NULL, 'X'},
+        {"ratio", required_argument, NULL, 'R'},
+        {"makeup", required_argument, NULL, 'M'},
+        {"jobs", required_argument, NULL, 'j'},
+        {NULL, 0, NULL, 0}
+    };
+    const char* distort = NULL;
+    int option;
+
+    job.gain = 1;
+    job.curve = SHAPER_CURVES;
+    job.drive = SHAPER_DRIVE;
+    job.oversample = SHAPER_MAX_FACTOR;
+    job.threshold = DYNAMICS_THRESHOLD;
+    job.ratio = DYNAMICS_RATIO;
+    while ((option = getopt_long(argc, argv, "n:C:D:G:O:g:LX:R:M:j:", options, NULL)) != -1)
+    {
+        switch (option)
+        {
+            case 'n': job.denoise = atof(optarg); break;
+            case 'C': job.cabinet = optarg; break;
+            case 'D': distort = optarg; break;
+            case 'G': job.drive = atof(optarg); break;
+            case 'O': job.oversample = atoi(optarg); break;
+            case 'g': job.gain = powf(10, atof(optarg) / 20); break;
+            case 'L': job.limit = 1; break;
+            case 'X': job.threshold = atof(optarg); break;
+            case 'R': job.ratio = atof(optarg); break;
+            case 'M': job.makeup = atof(optarg); break;
+            case 'j': numWorkers = atoi(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind != 2 || numWorkers < 1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (distort != NULL && (job.curve = shaperCurve(distort)) == SHAPER_CURVES)
+    {
+        printf("there is no curve called %s\n", distort);
+        return 1;
+    }
+    job.inDir = argv[optind];
+    job.outDir = argv[optind + 1];
+
+    if (findRecordings(&job))
+    {
+        printf("can't read %s\n", job.inDir);
+        return 1;
+    }
+    if (mkdir(job.outDir, 0755) && access(job.outDir, W_OK))
+    {
+        printf("can't write to %s\n", job.outDir);
+        return 1;
+    }
+    if ((size_t)numWorkers > job.numNames)
+    {
+        numWorkers = job.numNames > 0 ? job.numNames : 1;
+    }
+
+    workers = malloc(numWorkers * sizeof(Worker));
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        if (workers == NULL || workerInit(&workers[i], &job))
+        {
+            printf("can't set up the effects\n");
+            return 1;
+        }
+    }
+
+    printf("rendering %zu files on %d threads...\n", job.numNames, numWorkers);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        pthread_create(&workers[i].thread, NULL, workerThread, &workers[i]);
+    }
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("rendered %.1f s of audio in %.2f s (%.1fx real time), %d failed\n",
+        (double)job.frames / SAMPLE_RATE, seconds,
+        seconds > 0 ? job.frames / (seconds * SAMPLE_RATE) : 0, atomic_load(&job.failures));
+
+    return job.failures ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+// Date: 10/19/2026
+// Summary: Stands in for EasyPIO in replay builds, playing a pin trace into the receiver
+
+#include <time.h>
+#include "replay.h"
+#include "trace.h"
+#include "wav.h"
+#include "logger.h"
+
+/**
+ * \brief State of the replay
+ */
+static struct
+{
+    TraceReader reader;         // trace being replayed
+    TraceRecord next;           // next record to apply
+    int pending;                // whether next holds a record
+    unsigned int reads[TRACE_SPI_PINS]; // reads of each SPI pin since its last edge
+    unsigned int levels;        // level of each traced pin (bit i for pins[i])
+    unsigned int latched;       // UI edges not yet taken by readEdgeEvents (bit i for pins[i])
+    int mosi;                   // whether the next read of MOSI changes (from an SCLK record)
+    Input* ui;                  // input to poll
+    long long time;             // time in the trace in microseconds
+    long long nextPoll;         // time at which the input should be polled again
+    size_t frames;              // frames replayed (falls of NCS)
+    unsigned int checksum;      // FNV-1a hash of the words written to the PWM
+    struct timespec start;      // time at which the replay started
+} replay;
+
+/**
+ * \brief Print what was replayed and exit
+ */
+static void finish(void)
+{
+    struct timespec end;
+    double seconds, traced, audio;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - replay.start.tv_sec) + (end.tv_nsec - replay.start.tv_nsec) / 1e9;
+    traced = (replay.time - replay.reader.header.start) / 1e6;
+    audio = (double)replay.frames / SAMPLE_RATE;
+    logFlush();
+    printf("replayed %zu frames (%.2f s of audio, %.2f s traced) in %.2f s (%.1fx real time)\n",
+        replay.frames, audio, traced, seconds, seconds > 0 ? audio / seconds : 0);
+    printf("PWM output checksum %08x\n", replay.checksum);
+    traceClose(&replay.reader);
+    exit(0);
+}
+
+/**
+ * \brief Apply every record due by now, stopping at an edge which needs more reads
+ */
+static void advance(void)
+{
+    while (replay.pending)
+    {
+        if (replay.next.type < TRACE_PINS)
+        {
+            if (replay.next.type < TRACE_SPI_PINS
+                && replay.next.reads != replay.reads[replay.next.type])
+            {
+                return;
+            }
+            replay.levels ^= 1u << replay.next.type;
+            if (replay.next.type >= TRACE_SPI_PINS)
+            {
+                replay.latched |= 1u << replay.next.type;
+            }
+            else
+            {
+                replay.frames += replay.next.type == 0 && !(replay.levels & 1);
+                replay.reads[replay.next.type] = 0;
+                replay.mosi |= replay.next.mosi;
+            }
+        }
+        else
+        {
+            // Poll as the input thread did: when it saw a change and at least every poll period
+            replay.time = replay.next.time;
+            if (replay.ui != NULL && (replay.next.type == TRACE_RECORD_META(TRACE_POLL)
+                || replay.time >= replay.nextPoll))
+            {
+                inputPoll(replay.ui, replay.time);
+                replay.nextPoll = replay.time + INPUT_POLL_TIME;
+            }
+        }
+        replay.pending = !traceNext(&replay.reader, &replay.next);
+    }
+    finish();
+}
+
+/**
+ * \brief Index of a pin in the trace, or -1 if it was not traced
+ */
+static int pinIndex(int pin)
+{
+    for (int i = 0; i < TRACE_PINS; ++i)
+    {
+        if (replay.reader.header.pins[i] == pin)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * \brief Spread bits of the traced pins out to their GPIO numbers
+ */
+static unsigned int gpioBits(unsigned int bits)
+{
+    unsigned int gpio = 0;
+
+    for (int i = 0; i < TRACE_PINS; ++i)
+    {
+        gpio |= ((bits >> i) & 1) << replay.reader.header.pins[i];
+    }
+    return gpio;
+}
+
+int replayOpen(const char* path)
+{
+    if (traceOpen(&replay.reader, path))
+    {
+        return -1;
+    }
+    replay.levels = replay.reader.header.levels;
+    replay.time = replay.reader.header.start;
+    replay.checksum = 2166136261u;
+    replay.pending = !traceNext(&replay.reader, &replay.next);
+    clock_gettime(CLOCK_MONOTONIC, &replay.start);
+    return 0;
+}
+
+void replayWatch(Input* ui)
+{
+    replay.ui = ui;
+    replay.nextPoll = replay.time + INPUT_POLL_TIME;
+}
+
+int digitalRead(int pin)
+{
+    int index = pinIndex(pin);
+
+    if (index < 0)
+    {
+        return 0;
+    }
+    if (index < TRACE_SPI_PINS)
+    {
+        replay.reads[index]++;
+        if (index == 2 && replay.mosi)
+        {
+            replay.levels ^= 1u << index;
+            replay.reads[index] = 0;
+            replay.mosi = 0;
+        }
+        advance();
+    }
+    return (replay.levels >> index) & 1;
+}
+
+unsigned int digitalReadAll(void)
+{
+    return gpioBits(replay.levels);
+}
+
+unsigned int readEdgeEvents(unsigned int mask)
+{
+    unsigned int events = gpioBits(replay.latched) & mask;
+
+    for (int i = 0; i < TRACE_PINS; ++i)
+    {
+        if ((events >> replay.reader.header.pins[i]) & 1)
+        {
+            replay.latched &= ~(1u << i);
+        }
+    }
+    return events;
+}
+
+void pwmFifoWrite(unsigned int data)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        replay.checksum = (replay.checksum ^ ((data >> (8 * i)) & 0xFF)) * 16777619u;
+    }
+}
+
+int pwmFifoFull(void)
+{
+    return 0;
+}
+
+int replaySleep(unsigned int micros)
+{
+    return 0;
+}
+
+void pioInit(void) {}
+void pwmInit(void) {}
+void pinMode(int pin, int function) {}
+void pinEdgeDetect(int pin, int rising, int falling) {}
+void pinEdgeRelease(void) {}
+void digitalWrite(int pin, int val) {}
+void pwmFifoInit(unsigned int range) {}
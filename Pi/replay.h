@@ -0,0 +1,66 @@
+// Date: 10/19/2026
+// Summary: Stands in for EasyPIO in replay builds, playing a pin trace into the receiver
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "input.h"
+
+// The subset of EasyPIO used by the receiver
+#define INPUT  0
+#define OUTPUT 1
+#define CM_FREQUENCY 100000000
+
+// Nothing happens on the SPI pins while the receiver sleeps, so there is no need to wait
+#define usleep(micros) replaySleep(micros)
+
+void pioInit(void);
+void pwmInit(void);
+void pinMode(int pin, int function);
+void pinEdgeDetect(int pin, int rising, int falling);
+void pinEdgeRelease(void);
+void digitalWrite(int pin, int val);
+void pwmFifoInit(unsigned int range);
+int pwmFifoFull(void);
+void pwmFifoWrite(unsigned int data);
+
+/**
+ * \brief Level of a traced pin, taking the next read of an SPI pin from the trace
+ *
+ * Once the trace runs out, prints the frames replayed and the throughput and exits.
+ */
+int digitalRead(int pin);
+
+/**
+ * \brief Levels of the traced pins 0-31
+ */
+unsigned int digitalReadAll(void);
+
+/**
+ * \brief Edges of the masked UI pins since the last call, as the input thread saw them
+ */
+unsigned int readEdgeEvents(unsigned int mask);
+
+/**
+ * \brief Does nothing
+ */
+int replaySleep(unsigned int micros);
+
+/**
+ * \brief Open the trace to replay (before anything reads a pin)
+ *
+ * \returns 0 on success, -1 if the file is not a trace
+ */
+int replayOpen(const char* path);
+
+/**
+ * \brief Poll an input without a thread whenever the input thread did when the trace was made
+ *
+ * \param ui            input started without its own thread
+ */
+void replayWatch(Input* ui);
+
+#endif
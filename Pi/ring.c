@@ -0,0 +1,28 @@
+// Date: 10/19/2026
+// Summary: Lock-free single-producer single-consumer ring buffer for passing data between threads
+
+#include <stdlib.h>
+#include "ring.h"
+
+int ringInit(Ring* ring, size_t itemSize, size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    ring->data = malloc(size * itemSize);
+    ring->itemSize = itemSize;
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    return ring->data == NULL ? -1 : 0;
+}
+
+void ringFree(Ring* ring)
+{
+    free(ring->data);
+    ring->data = NULL;
+}
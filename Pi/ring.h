@@ -0,0 +1,109 @@
+// Date: 10/19/2026
+// Summary: Lock-free single-producer single-consumer ring buffer for passing data between threads
+
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/**
+ * \brief Ring of fixed-size items written by one thread and read by another
+ *
+ * head and tail count items forever (wrapping at SIZE_MAX), so the ring can use every slot.
+ * They live on separate cache lines so the two threads do not fight over one line.
+ */
+typedef struct
+{
+    unsigned char* data;            // capacity * itemSize bytes of storage
+    size_t itemSize;                // bytes per item
+    size_t mask;                    // capacity - 1 (capacity is a power of two)
+    _Alignas(64) atomic_size_t head;    // items written (only changed by the producer)
+    _Alignas(64) atomic_size_t tail;    // items read (only changed by the consumer)
+} Ring;
+
+/**
+ * \brief Allocate an empty ring
+ *
+ * \param ring          ring to initialize
+ * \param itemSize      bytes per item
+ * \param capacity      number of items (rounded up to a power of two)
+ *
+ * \returns 0 on success, -1 if the storage could not be allocated
+ */
+int ringInit(Ring* ring, size_t itemSize, size_t capacity);
+
+/**
+ * \brief Free the storage of a ring
+ */
+void ringFree(Ring* ring);
+
+/**
+ * \brief Number of items waiting to be read
+ */
+static inline size_t ringCount(Ring* ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire)
+        - atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+/**
+ * \brief Add an item to the ring (producer only)
+ *
+ * \returns 0 on success, -1 if the ring is full
+ */
+static inline int ringPush(Ring* ring, const void* item)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) > ring->mask)
+    {
+        return -1;
+    }
+    memcpy(ring->data + (head & ring->mask) * ring->itemSize, item, ring->itemSize);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 0;
+}
+
+/**
+ * \brief Get the slot the next item will be written to, to fill it in place (producer only)
+ *
+ * \returns pointer to itemSize bytes, or NULL if the ring is full
+ */
+static inline void* ringReserve(Ring* ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) > ring->mask)
+    {
+        return NULL;
+    }
+    return ring->data + (head & ring->mask) * ring->itemSize;
+}
+
+/**
+ * \brief Add the item filled in the slot from ringReserve to the ring (producer only)
+ */
+static inline void ringCommit(Ring* ring)
+{
+    atomic_store_explicit(&ring->head, atomic_load_explicit(&ring->head, memory_order_relaxed)
+        + 1, memory_order_release);
+}
+
+/**
+ * \brief Remove the oldest item from the ring (consumer only)
+ *
+ * \returns 0 on success, -1 if the ring is empty
+ */
+static inline int ringPop(Ring* ring, void* item)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (atomic_load_explicit(&ring->head, memory_order_acquire) == tail)
+    {
+        return -1;
+    }
+    memcpy(item, ring->data + (tail & ring->mask) * ring->itemSize, ring->itemSize);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,195 @@
+// Date: 10/19/2026
+// Summary: Oversampled waveshaper for overdrive and distortion without aliasing
+
+#include <string.h>
+#include <math.h>
+#include "shaper.h"
+#include "audio.h"
+
+#define KAISER_BETA 7.86    // Kaiser window parameter for about 80 dB of stopband rejection
+
+static const char* const curveNames[SHAPER_CURVES] = {"hard", "soft", "cubic"};
+
+/**
+ * \brief Modified Bessel function of the first kind and order zero (for the Kaiser window)
+ */
+static double besselI0(double x)
+{
+    double sum = 1;
+    double term = 1;
+
+    for (int k = 1; term > sum * 1e-12; ++k)
+    {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * \brief Value of a curve before scaling to SHAPER_LEVEL
+ */
+static double curveValue(ShaperCurve curve, double x)
+{
+    switch (curve)
+    {
+        case SHAPER_HARD:
+            return x > 1 ? 1 : x < -1 ? -1 : x;
+        case SHAPER_SOFT:
+            return tanh(x);
+        default:
+            x = x > 1 ? 1 : x < -1 ? -1 : x;
+            return 1.5 * (x - x * x * x / 3);
+    }
+}
+
+int shaperInit(Shaper* shaper, ShaperCurve curve, int factor, float drive, int channels)
+{
+    int length = factor * SHAPER_TAPS;
+    double h[SHAPER_MAX_FACTOR * SHAPER_TAPS];
+    double sum = 0;
+    double t, w;
+
+    if (curve < 0 || curve >= SHAPER_CURVES || (factor != 1 && factor != 2 && factor != 4
+        && factor != SHAPER_MAX_FACTOR))
+    {
+        return -1;
+    }
+    shaper->factor = factor;
+    shaper->channels = channels;
+    shaper->drive = powf(10, drive / 20);
+
+    for (int i = 0; i <= SHAPER_TABLE; ++i)
+    {
+        shaper->table[i] = SHAPER_LEVEL * curveValue(curve,
+            SHAPER_RANGE * (2.0 * i / SHAPER_TABLE - 1));
+    }
+
+    // Windowed sinc with its cutoff at 24 kHz, halfway between the passband and stopband
+    for (int i = 0; i < length; ++i)
+    {
+        t = i - (length - 1) / 2.0;
+        w = 2.0 * i / (length - 1) - 1;
+        h[i] = (t == 0 ? 1 : sin(M_PI * t / factor) / (M_PI * t / factor))
+            * besselI0(KAISER_BETA * sqrt(1 - w * w)) / besselI0(KAISER_BETA);
+        sum += h[i];
+    }
+
+    // Each phase of the interpolator holds every factor'th tap, reversed so that it lines up
+    // with the input in time order, and restores the level lost to the inserted zeros
+    for (int p = 0; p < factor; ++p)
+    {
+        for (int j = 0; j < SHAPER_TAPS; ++j)
+        {
+            shaper->up[p][j] = factor * h[(SHAPER_TAPS - 1 - j) * factor + p] / sum;
+        }
+    }
+    for (int i = 0; i < length; ++i)
+    {
+        shaper->down[i] = h[length - 1 - i] / sum;
+    }
+
+    shaperReset(shaper);
+    return 0;
+}
+
+ShaperCurve shaperCurve(const char* name)
+{
+    int curve = 0;
+
+    while (curve < SHAPER_CURVES && strcmp(name, curveNames[curve]))
+    {
+        curve++;
+    }
+    return curve;
+}
+
+void shaperReset(Shaper* shaper)
+{
+    memset(shaper->input, 0, sizeof(shaper->input));
+    memset(shaper->over, 0, sizeof(shaper->over));
+}
+
+/**
+ * \brief Pass a sample through the curve, interpolating between entries of the table
+ */
+static inline float shape(const Shaper* shaper, float sample)
+{
+    float position = (sample * shaper->drive + SHAPER_RANGE)
+        * (SHAPER_TABLE / (2 * SHAPER_RANGE));
+    int index;
+
+    if (position <= 0)
+    {
+        return shaper->table[0];
+    }
+    if (position >= SHAPER_TABLE)
+    {
+        return shaper->table[SHAPER_TABLE];
+    }
+    index = (int)position;
+    position -= index;
+    return shaper->table[index] + position * (shaper->table[index + 1] - shaper->table[index]);
+}
+
+/**
+ * \brief Shape one block of every channel in place
+ *
+ * Output frame n is decimated from the last shaped sample of input frame n, so the two
+ * filters together delay the input by exactly SHAPER_TAPS - 1 frames.
+ */
+static void shaperProcess(void* state, float* const* channels, int numChannels, size_t frames)
+{
+    Shaper* shaper = state;
+    int factor = shaper->factor;
+    int length = factor * SHAPER_TAPS;
+    float* input;
+    float* over;
+    float* shaped;
+
+    for (int c = 0; c < numChannels && c < shaper->channels; ++c)
+    {
+        input = shaper->input[c];
+        over = shaper->over[c];
+        shaped = over + length - 1;
+
+        // Without oversampling there is nothing to filter
+        if (factor == 1)
+        {
+            for (size_t n = 0; n < frames; ++n)
+            {
+                channels[c][n] = shape(shaper, channels[c][n]);
+            }
+            continue;
+        }
+        memcpy(input + SHAPER_TAPS - 1, channels[c], frames * sizeof(float));
+
+        for (size_t n = 0; n < frames; ++n)
+        {
+            for (int p = 0; p < factor; ++p)
+            {
+                shaped[n * factor + p] = dotProduct(shaper->up[p], input + n, SHAPER_TAPS);
+            }
+        }
+        for (size_t i = 0; i < frames * factor; ++i)
+        {
+            shaped[i] = shape(shaper, shaped[i]);
+        }
+        for (size_t n = 0; n < frames; ++n)
+        {
+            channels[c][n] = dotProduct(shaper->down, over + n * factor + factor - 1,
+                length);
+        }
+
+        // Keep the history the filters need for the next block
+        memmove(input, input + frames, (SHAPER_TAPS - 1) * sizeof(float));
+        memmove(over, over + frames * factor, (length - 1) * sizeof(float));
+    }
+}
+
+DspProcessor shaperProcessor(Shaper* shaper)
+{
+    DspProcessor processor = {"waveshaper", shaper, shaperProcess,
+        shaper->factor > 1 ? SHAPER_TAPS - 1 : 0};
+    return processor;
+}
@@ -0,0 +1,78 @@
+// Date: 10/19/2026
+// Summary: Oversampled waveshaper for overdrive and distortion without aliasing
+
+#ifndef SHAPER_H
+#define SHAPER_H
+
+#include "dsp.h"
+
+#define SHAPER_MAX_FACTOR 8                 // highest oversampling factor
+#define SHAPER_TAPS 32                      // taps in each phase of the resampling filters
+#define SHAPER_TABLE 1024                   // intervals in the lookup table of a curve
+#define SHAPER_RANGE 4.0f                   // the table covers inputs from -RANGE to RANGE
+#define SHAPER_LEVEL 0.5f                   // peak output (the loudest sample from the FPGA)
+#define SHAPER_DRIVE 12                     // default drive in dB (the FPGA shifts by 2 bits)
+
+/**
+ * \brief Transfer curves
+ */
+typedef enum
+{
+    SHAPER_HARD,        // clip at full scale, like the FPGA's overdrive
+    SHAPER_SOFT,        // hyperbolic tangent
+    SHAPER_CUBIC,       // cubic soft clipper, which only makes the third harmonic at low levels
+    SHAPER_CURVES       // number of curves
+} ShaperCurve;
+
+/**
+ * \brief State of the waveshaper
+ *
+ * Each block is upsampled by a polyphase interpolation filter, passed through the curve, and
+ * filtered and decimated back to 48 kHz.  Harmonics made by the curve above 24 kHz are removed
+ * before they can fold back into the audible band, as they do when clipping at 48 kHz.  Both
+ * filters are the same windowed sinc of factor * SHAPER_TAPS taps, which passes up to 20 kHz
+ * and removes everything above 28 kHz by about 80 dB.
+ */
+typedef struct
+{
+    int factor;                                         // oversampling factor (1, 2, 4 or 8)
+    int channels;                                       // channels processed
+    float drive;                                        // gain applied before the curve
+    float table[SHAPER_TABLE + 1];                      // curve sampled across the range
+    float up[SHAPER_MAX_FACTOR][SHAPER_TAPS];           // reversed phases of the interpolator
+    float down[SHAPER_MAX_FACTOR * SHAPER_TAPS];        // decimation filter
+    float input[MAX_CHANNELS][SHAPER_TAPS - 1 + DSP_BLOCK];     // recent input of each channel
+    float over[MAX_CHANNELS][SHAPER_MAX_FACTOR * (SHAPER_TAPS + DSP_BLOCK)];    // shaped samples
+} Shaper;
+
+/**
+ * \brief Build the table and filters
+ *
+ * \param shaper        waveshaper to initialize
+ * \param curve         transfer curve
+ * \param factor        oversampling factor (1 for none, 2, 4 or 8)
+ * \param drive         gain in dB applied before the curve
+ * \param channels      number of channels which will be processed
+ *
+ * \returns 0 on success, -1 if the curve or factor is not supported
+ */
+int shaperInit(Shaper* shaper, ShaperCurve curve, int factor, float drive, int channels);
+
+/**
+ * \brief Look up a curve by name ("hard", "soft" or "cubic")
+ *
+ * \returns the curve, or SHAPER_CURVES if there is none by that name
+ */
+ShaperCurve shaperCurve(const char* name);
+
+/**
+ * \brief Forget all input so the next block starts from silence
+ */
+void shaperReset(Shaper* shaper);
+
+/**
+ * \brief Processor which applies the waveshaper to up to DSP_BLOCK frames at a time
+ */
+DspProcessor shaperProcessor(Shaper* shaper);
+
+#endif
@@ -0,0 +1,129 @@
+// Date: 10/19/2026
+// Summary: Publishes the recordings and the looper's state to other processes through shared memory
+
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include "share.h"
+#include "wav.h"
+
+#define PAGE_BYTES 4096
+
+int shareCreate(Share* sh, const char* name, size_t arenaBytes)
+{
+    struct statvfs shm;
+    size_t arenaChunks = arenaBytes / (CHUNK_SAMPLES * sizeof(short));
+    size_t tableBytes = (LIVE_RECORDINGS * arenaChunks * sizeof(uint32_t) + PAGE_BYTES - 1)
+        & ~(size_t)(PAGE_BYTES - 1);
+    size_t bytes = LIVE_HEADER + tableBytes + arenaChunks * CHUNK_SAMPLES * sizeof(short);
+    void* map;
+    int fd;
+
+    memset(sh, 0, sizeof(*sh));
+
+    // Pages of /dev/shm are only allocated when touched, so a segment bigger than the space left
+    // would fail with SIGBUS in the middle of a recording rather than here
+    if (statvfs("/dev/shm", &shm) == 0 && (size_t)shm.f_bavail * shm.f_frsize < bytes)
+    {
+        return -1;
+    }
+
+    // Start from an empty segment; readers of an old one keep their (now orphaned) mapping
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    fchmod(fd, 0644);
+    if (ftruncate(fd, bytes))
+    {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return -1;
+    }
+
+    sh->header = map;
+    sh->tables = (uint32_t*)((char*)map + LIVE_HEADER);
+    sh->arena = (char*)map + LIVE_HEADER + tableBytes;
+    sh->arenaBytes = arenaChunks * CHUNK_SAMPLES * sizeof(short);
+
+    sh->header->magic = LIVE_MAGIC;
+    sh->header->version = LIVE_VERSION;
+    sh->header->sampleRate = SAMPLE_RATE;
+    sh->header->chunkSamples = CHUNK_SAMPLES;
+    sh->header->arenaChunks = arenaChunks;
+    sh->header->pid = getpid();
+    sh->header->tableOffset = LIVE_HEADER;
+    sh->header->arenaOffset = LIVE_HEADER + tableBytes;
+    sh->header->bytes = bytes;
+    return 0;
+}
+
+void shareWatch(Share* sh, const Recording* linear, const Recording* loop)
+{
+    sh->recordings[LIVE_LINEAR] = linear;
+    sh->recordings[LIVE_LOOP] = loop;
+    sh->header->channels = linear->channels;
+    sh->header->frameShift = linear->frameShift;
+}
+
+/**
+ * \brief Bring a recording's chunk table up to date
+ */
+static void syncTable(Share* sh, int r)
+{
+    const Recording* rec = sh->recordings[r];
+    uint32_t* table = sh->tables + r * sh->header->arenaChunks;
+    size_t filled = sh->state.chunks[r];
+
+    // A recording which shrank, moved to another chunk table (swapped with the pre-roll) or
+    // starts in another chunk was cleared or replaced, so its table starts over
+    if (rec->chunks != sh->lastChunks[r] || rec->frames < sh->state.recordIndex[r]
+        || rec->usedChunks < filled
+        || (filled > 0 && table[0] != (uint32_t)storeChunkIndex(rec->chunks[0])))
+    {
+        sh->lastChunks[r] = rec->chunks;
+        sh->state.generation[r]++;
+        filled = 0;
+    }
+
+    // Chunks are claimed one at a time as the recording grows
+    while (filled < rec->usedChunks)
+    {
+        table[filled] = (uint32_t)storeChunkIndex(rec->chunks[filled]);
+        filled++;
+    }
+    sh->state.chunks[r] = filled;
+    sh->state.recordIndex[r] = rec->frames;
+}
+
+void shareFrame(Share* sh)
+{
+    LiveHeader* header = sh->header;
+    unsigned int seq = atomic_load_explicit(&header->seq, memory_order_relaxed);
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    sh->state.frame++;
+    sh->state.time = now.tv_sec * 1000000000LL + now.tv_nsec;
+
+    // Readers retry while seq is odd, so the tables and the state change together
+    atomic_store_explicit(&header->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    syncTable(sh, LIVE_LINEAR);
+    syncTable(sh, LIVE_LOOP);
+    memcpy(&header->state, &sh->state, sizeof(sh->state));
+    atomic_store_explicit(&header->seq, seq + 2, memory_order_release);
+}
@@ -0,0 +1,57 @@
+// Date: 10/19/2026
+// Summary: Publishes the recordings and the looper's state to other processes through shared memory
+
+#ifndef SHARE_H
+#define SHARE_H
+
+#include <stddef.h>
+#include "live.h"
+#include "store.h"
+
+/**
+ * \brief The receiver's side of a shared-memory segment laid out as in live.h
+ *
+ * The recording arena lives inside the segment, so publishing a frame only copies the state
+ * into the header and fills in new chunk table entries; no samples are copied and nothing
+ * calls into the kernel.
+ */
+typedef struct
+{
+    LiveHeader* header;                         // start of the segment (NULL if not sharing)
+    uint32_t* tables;                           // chunk tables, one after the other
+    void* arena;                                // recording arena (passed to storeInitShared)
+    size_t arenaBytes;                          // size of the arena
+    const Recording* recordings[LIVE_RECORDINGS];   // recordings published
+    short** lastChunks[LIVE_RECORDINGS];        // chunk table of each at the last publish
+    LiveState state;                            // state published by shareFrame
+} Share;
+
+/**
+ * \brief Create a segment holding an arena of the given size, replacing any left behind
+ *
+ * The segment can be read (but not written) by every user.  Its pages are only committed as
+ * the arena is used, so there must be room in /dev/shm for the whole arena.
+ *
+ * \param sh            segment to create
+ * \param name          name of the segment (such as LIVE_NAME)
+ * \param arenaBytes    size of the arena (rounded down to a whole number of chunks)
+ *
+ * \returns 0 on success, -1 if the segment could not be created or /dev/shm is too small
+ */
+int shareCreate(Share* sh, const char* name, size_t arenaBytes);
+
+/**
+ * \brief Choose the recordings to publish (once storeInitShared has set up the arena)
+ */
+void shareWatch(Share* sh, const Recording* linear, const Recording* loop);
+
+/**
+ * \brief Publish the recordings and the state set in sh->state after a frame
+ *
+ * Fills in the chunks claimed since the last frame, rewrites a recording's table (and bumps its
+ * generation) if it was cleared or replaced, and stamps the frame with CLOCK_MONOTONIC (read
+ * through the vDSO, so without a system call).
+ */
+void shareFrame(Share* sh);
+
+#endif
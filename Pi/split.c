@@ -0,0 +1,192 @@
+// Date: 10/19/2026
+// Summary: Splits a long linear take into trimmed takes at the silences between songs
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "split.h"
+#include "audio.h"
+#include "logger.h"
+#include "wav.h"
+
+/**
+ * \brief Add a piece, padded with silence and kept clear of the piece before it
+ *
+ * \returns the new number of pieces
+ */
+static int addPiece(SplitPiece* pieces, int count, int maxPieces, size_t first, size_t end,
+    size_t frames)
+{
+    size_t pad = (size_t)SPLIT_PAD * SAMPLE_RATE / 1000;
+    size_t last = count > 0 ? pieces[count - 1].start + pieces[count - 1].frames : 0;
+
+    first = first > last + pad ? first - pad : last;
+    end = end + pad < frames ? end + pad : frames;
+    if (count >= maxPieces || end - first < (size_t)SPLIT_MIN_TAKE * SAMPLE_RATE / 1000)
+    {
+        return count;
+    }
+    pieces[count].start = first;
+    pieces[count].frames = end - first;
+    return count + 1;
+}
+
+int splitFind(const short* samples, size_t frames, int channels, float level,
+    SplitPiece* pieces, int maxPieces)
+{
+    // Thresholds on the mean square of a sample and on the peak, relative to full scale
+    float open = powf(10, level / 10) * 32768.0f * 32768.0f;
+    float close = powf(10, (level - SPLIT_HYSTERESIS) / 10) * 32768.0f * 32768.0f;
+    unsigned int openPeak = 32768 * powf(10, level / 20);
+    size_t gapBlocks = (size_t)SPLIT_GAP * SAMPLE_RATE / 1000 / SPLIT_BLOCK;
+    size_t blocks = (frames + SPLIT_BLOCK - 1) / SPLIT_BLOCK;
+    size_t first = 0, loud = 0, length;
+    unsigned int peak;
+    int sound = 0, count = 0;
+    float energy;
+
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        length = frames - b * SPLIT_BLOCK < SPLIT_BLOCK ? frames - b * SPLIT_BLOCK : SPLIT_BLOCK;
+        energy = blockEnergy(samples + b * SPLIT_BLOCK * channels, length * channels, &peak)
+            / (length * channels);
+
+        // Silence: wait for a block loud enough to start a piece
+        if (!sound)
+        {
+            if (energy >= open)
+            {
+                sound = 1;
+                first = loud = b;
+            }
+        }
+
+        // Sound: a block above the lower threshold (or with a loud peak) keeps the piece going
+        // until a long enough run of quiet blocks
+        else if (energy >= close || peak >= openPeak)
+        {
+            loud = b;
+        }
+        else if (b - loud >= gapBlocks)
+        {
+            count = addPiece(pieces, count, maxPieces, first * SPLIT_BLOCK,
+                (loud + 1) * SPLIT_BLOCK, frames);
+            sound = 0;
+        }
+    }
+
+    if (sound)
+    {
+        count = addPiece(pieces, count, maxPieces, first * SPLIT_BLOCK,
+            (loud + 1) * SPLIT_BLOCK < frames ? (loud + 1) * SPLIT_BLOCK : frames, frames);
+    }
+    return count;
+}
+
+/**
+ * \brief Split sp->take, save the pieces and list them
+ */
+static void* splitThread(void* arg)
+{
+    Splitter* sp = arg;
+    const TakeEntry* take = &sp->take;
+    const TakeEntry* piece;
+    unsigned int firstID = 0, lastID = 0;
+    char path[TAKE_PATH];
+    struct timespec start, end;
+    const short* samples;
+    size_t bytes;
+    float seconds;
+    FILE* list;
+    int count;
+
+    samples = takeMapSamples(sp->store, take, &bytes);
+    if (samples == NULL)
+    {
+        logPrint("can't read take %04u to split it\n", take->id);
+        atomic_store(&sp->busy, 0);
+        return NULL;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    count = splitFind(samples, take->frames, take->channels, sp->level, sp->pieces, SPLIT_MAX);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9f;
+
+    if (count == 0 || (count == 1 && sp->pieces[0].frames == take->frames))
+    {
+        logPrint("take %04u has no silences to split at\n", take->id);
+    }
+    else
+    {
+        // The pieces are still saved if they can't be listed, but never to a truncated path
+        list = NULL;
+        if (snprintf(path, TAKE_PATH, "%s/take-%04u-split.csv", sp->store->dir, take->id)
+            < TAKE_PATH)
+        {
+            list = fopen(path, "w");
+        }
+        if (list != NULL)
+        {
+            fprintf(list, "take,start,seconds\n");
+        }
+        else
+        {
+            logPrint("can't list the pieces of take %04u\n", take->id);
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            piece = takeSaveSamples(sp->store, samples + sp->pieces[i].start * take->channels,
+                sp->pieces[i].frames, take->channels, TAKE_PIECE);
+            if (piece == NULL)
+            {
+                logPrint("can't save piece %d of take %04u\n", i + 1, take->id);
+                break;
+            }
+            firstID = firstID ? firstID : piece->id;
+            lastID = piece->id;
+            if (list != NULL)
+            {
+                fprintf(list, "%u,%.3f,%.3f\n", piece->id,
+                    (float)sp->pieces[i].start / SAMPLE_RATE,
+                    (float)sp->pieces[i].frames / SAMPLE_RATE);
+            }
+        }
+        if (list != NULL)
+        {
+            fclose(list);
+        }
+        logPrint("split take %04u into takes %04u to %04u (analyzed at %.0fx real time)\n",
+            take->id, firstID, lastID,
+            seconds > 0 ? take->frames / (float)SAMPLE_RATE / seconds : 0);
+    }
+
+    munmap((void*)samples, bytes);
+    atomic_store(&sp->busy, 0);
+    return NULL;
+}
+
+void splitInit(Splitter* sp, TakeStore* store, float level)
+{
+    sp->store = store;
+    sp->level = level;
+    atomic_init(&sp->busy, 0);
+}
+
+int splitStart(Splitter* sp, const TakeEntry* take)
+{
+    if (atomic_load(&sp->busy))
+    {
+        return -1;
+    }
+    sp->take = *take;
+    atomic_store(&sp->busy, 1);
+    if (pthread_create(&sp->thread, NULL, splitThread, sp))
+    {
+        atomic_store(&sp->busy, 0);
+        return -1;
+    }
+    pthread_detach(sp->thread);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Date: 10/19/2026
+// Summary: Splits a long linear take into trimmed takes at the silences between songs
+
+#ifndef SPLIT_H
+#define SPLIT_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "take.h"
+
+#define SPLIT_BLOCK 480             // frames per measured block (10 ms)
+#define SPLIT_LEVEL -40             // default RMS level in dBFS at which sound starts
+#define SPLIT_HYSTERESIS 10         // dB below SPLIT_LEVEL at which sound may stop
+#define SPLIT_GAP 2000              // time in ms of silence which splits the take
+#define SPLIT_PAD 250               // time in ms of silence kept at each end of a piece
+#define SPLIT_MIN_TAKE 2000         // time in ms of the shortest piece kept
+#define SPLIT_MAX 64                // most pieces written for one take
+
+/**
+ * \brief Part of a take with sound in it
+ */
+typedef struct
+{
+    size_t start;                   // first frame
+    size_t frames;                  // number of frames
+} SplitPiece;
+
+/**
+ * \brief State of the thread which splits saved takes
+ */
+typedef struct
+{
+    TakeStore* store;               // store holding the takes (left alone by others while busy)
+    float level;                    // RMS level in dBFS at which sound starts
+    TakeEntry take;                 // take being split (a copy, since the index can move)
+    SplitPiece pieces[SPLIT_MAX];   // pieces found in the take
+    atomic_int busy;                // whether a take is being split
+    pthread_t thread;               // thread splitting the take
+} Splitter;
+
+/**
+ * \brief Find the pieces of a recording which have sound in them
+ *
+ * Each block's RMS and peak are measured; sound starts at a block whose RMS reaches level and
+ * lasts while blocks stay above level - SPLIT_HYSTERESIS (or a peak reaches level), so a
+ * note dying away isn't cut in half.  SPLIT_GAP ms of quieter blocks end a piece.  Pieces
+ * keep SPLIT_PAD ms of silence at each end, and pieces shorter than SPLIT_MIN_TAKE ms are
+ * dropped.
+ *
+ * \param samples       frames * channels interleaved samples
+ * \param frames        number of frames
+ * \param channels      number of channels (measured together)
+ * \param level         RMS level in dBFS at which sound starts
+ * \param pieces        receives up to maxPieces pieces in order
+ * \param maxPieces     number of entries in pieces
+ *
+ * \returns number of pieces found
+ */
+int splitFind(const short* samples, size_t frames, int channels, float level,
+    SplitPiece* pieces, int maxPieces);
+
+/**
+ * \brief Set up a splitter
+ *
+ * \param sp            splitter to initialize
+ * \param store         store holding the takes
+ * \param level         RMS level in dBFS at which sound starts
+ */
+void splitInit(Splitter* sp, TakeStore* store, float level);
+
+/**
+ * \brief Split a saved linear take in the background
+ *
+ * The take is read back from its file, so the recording can change while it is split.  Each
+ * piece is saved as a new take, and the pieces are listed in take-NNNN-split.csv next to the
+ * take.  Nothing is written if the take is one piece from start to end.  The store must not
+ * be touched until splitBusy returns 0.
+ *
+ * \returns 0 if the thread started, -1 if a take is still being split or it couldn't start
+ */
+int splitStart(Splitter* sp, const TakeEntry* take);
+
+/**
+ * \brief Whether a take is still being split
+ */
+static inline int splitBusy(Splitter* sp)
+{
+    return atomic_load(&sp->busy);
+}
+
+#endif
@@ -0,0 +1,251 @@
+// Date: 10/19/2026
+// Summary: Recording storage built from fixed-size chunks of a pre-reserved arena
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "store.h"
+
+#define CHUNK_BYTES (CHUNK_SAMPLES * sizeof(short))
+
+// The arena is shared by every recording in the process
+static char* arena;             // start of the reserved arena
+static size_t arenaChunks;      // number of chunks in the arena
+static size_t untouched;        // index of the first chunk which has never been used
+static short** freeChunks;      // stack of chunks returned by recordings
+static size_t freeCount;        // number of chunks on freeChunks
+
+/**
+ * \brief Start handing out chunks of a newly reserved arena
+ *
+ * \param map           start of the arena (MAP_FAILED if it couldn't be reserved)
+ * \param committed     number of chunks already committed (all of them, or none)
+ *
+ * \returns 0 on success, -1 if the arena or the free stack is missing
+ */
+static int arenaSetup(void* map, size_t committed)
+{
+    untouched = committed;
+    freeChunks = malloc(arenaChunks * sizeof(short*));
+    if (map == MAP_FAILED || freeChunks == NULL)
+    {
+        arenaChunks = 0;
+        return -1;
+    }
+    arena = map;
+
+    // With huge pages every chunk starts out committed, so they all begin on the free stack
+    // (in reverse so chunks are handed out in address order)
+    freeCount = 0;
+    while (freeCount < untouched)
+    {
+        freeChunks[freeCount] = (short*)(arena + (untouched - freeCount - 1) * CHUNK_BYTES);
+        freeCount++;
+    }
+
+    return 0;
+}
+
+int storeInit(size_t bytes, int hugePages)
+{
+    void* map = MAP_FAILED;
+    size_t committed = 0;
+
+    arenaChunks = bytes / CHUNK_BYTES;
+    bytes = arenaChunks * CHUNK_BYTES;
+
+    // Huge pages are populated up front (the kernel reserves them anyway), so the audio loop
+    // never takes a 2 MB page fault; fall back to normal pages if none are available
+    if (hugePages)
+    {
+        map = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (map != MAP_FAILED)
+        {
+            committed = arenaChunks;
+        }
+    }
+
+    // Otherwise only reserve address space; pages are committed as chunks are first used
+    if (map == MAP_FAILED)
+    {
+        map = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    }
+
+    return arenaSetup(map, committed);
+}
+
+int storeInitShared(void* memory, size_t bytes)
+{
+    arenaChunks = bytes / CHUNK_BYTES;
+    return arenaSetup(memory, 0);
+}
+
+void storeUsage(size_t* reserved, size_t* committed, size_t* inUse)
+{
+    *reserved = arenaChunks * CHUNK_BYTES;
+    *committed = untouched * CHUNK_BYTES;
+    *inUse = (untouched - freeCount) * CHUNK_BYTES;
+}
+
+long storeChunkIndex(const short* chunk)
+{
+    size_t offset = (const char*)chunk - arena;
+    return (const char*)chunk >= arena && offset < arenaChunks * CHUNK_BYTES ?
+        (long)(offset / CHUNK_BYTES) : -1;
+}
+
+/**
+ * \brief Take a chunk from the arena, preferring recently freed (and already committed) chunks
+ *
+ * \returns the chunk, or NULL if the arena is full
+ */
+static short* chunkAlloc()
+{
+    if (freeCount > 0)
+    {
+        return freeChunks[--freeCount];
+    }
+    if (untouched < arenaChunks)
+    {
+        return (short*)(arena + untouched++ * CHUNK_BYTES);
+    }
+    return NULL;
+}
+
+int recordingInit(Recording* rec, int channels)
+{
+    int channelShift = 0;
+    while ((1 << channelShift) < channels)
+    {
+        channelShift++;
+    }
+
+    rec->maxChunks = arenaChunks;
+    rec->chunks = malloc(rec->maxChunks * sizeof(short*));
+    rec->usedChunks = 0;
+    rec->frames = 0;
+    rec->channels = channels;
+    rec->frameShift = CHUNK_SHIFT - channelShift;
+    rec->frameMask = ((size_t)1 << rec->frameShift) - 1;
+    rec->pageMask = (PAGE_SAMPLES >> channelShift) - 1;
+    rec->map = NULL;
+    rec->mapBytes = 0;
+    rec->mappedChunks = 0;
+
+    return rec->chunks == NULL ? -1 : 0;
+}
+
+void recordingClear(Recording* rec)
+{
+    while (rec->usedChunks > rec->mappedChunks)
+    {
+        freeChunks[freeCount++] = rec->chunks[--rec->usedChunks];
+    }
+    if (rec->map != NULL)
+    {
+        munmap(rec->map, rec->mapBytes);
+        rec->map = NULL;
+        rec->mapBytes = 0;
+    }
+    rec->usedChunks = 0;
+    rec->mappedChunks = 0;
+    rec->frames = 0;
+}
+
+void recordingDropOldest(Recording* rec)
+{
+    if (rec->mappedChunks > 0 || rec->frames <= rec->frameMask)
+    {
+        return;
+    }
+    freeChunks[freeCount++] = rec->chunks[0];
+    rec->usedChunks--;
+    memmove(rec->chunks, rec->chunks + 1, rec->usedChunks * sizeof(short*));
+    rec->frames -= rec->frameMask + 1;
+}
+
+int recordingMap(Recording* rec, int fd, size_t offset, size_t frames)
+{
+    size_t chunkFrames = rec->frameMask + 1;
+    size_t fullChunks = frames >> rec->frameShift;
+    size_t tailFrames = frames & rec->frameMask;
+    short* samples;
+    short* tail;
+
+    recordingClear(rec);
+    if (fullChunks + (tailFrames > 0) > rec->maxChunks)
+    {
+        return -1;
+    }
+
+    rec->mapBytes = frames * rec->channels * sizeof(short);
+    if (rec->mapBytes == 0)
+    {
+        return 0;
+    }
+    rec->map = mmap(NULL, rec->mapBytes, PROT_READ, MAP_SHARED, fd, offset);
+    if (rec->map == MAP_FAILED)
+    {
+        rec->map = NULL;
+        rec->mapBytes = 0;
+        return -1;
+    }
+    samples = rec->map;
+
+    // Point the chunk table at the whole chunks of the file
+    for (rec->mappedChunks = 0; rec->mappedChunks < fullChunks; ++rec->mappedChunks)
+    {
+        rec->chunks[rec->mappedChunks] = samples + rec->mappedChunks * chunkFrames * rec->channels;
+    }
+    rec->usedChunks = rec->mappedChunks;
+
+    // Copy the partial chunk at the end so that appending never writes to the file
+    if (tailFrames > 0)
+    {
+        tail = chunkAlloc();
+        if (tail == NULL)
+        {
+            recordingClear(rec);
+            return -1;
+        }
+        memcpy(tail, samples + fullChunks * chunkFrames * rec->channels,
+            tailFrames * rec->channels * sizeof(short));
+        rec->chunks[rec->usedChunks++] = tail;
+    }
+
+    // Start reading the beginning of the file
+    madvise(rec->map, rec->mapBytes < CHUNK_BYTES ? rec->mapBytes : CHUNK_BYTES, MADV_WILLNEED);
+
+    rec->frames = frames;
+    return 0;
+}
+
+void recordingPrefetch(const Recording* rec, size_t frame)
+{
+    size_t next = (frame >> rec->frameShift) + 1;
+    if (next < rec->mappedChunks)
+    {
+        madvise(rec->chunks[next], CHUNK_BYTES, MADV_WILLNEED);
+    }
+}
+
+int recordingGrow(Recording* rec)
+{
+    size_t current = rec->frames >> rec->frameShift;
+    short* chunk;
+
+    // Keep one chunk beyond the current one so recordingAppend can fault it in gradually
+    while (rec->usedChunks < current + 2 && rec->usedChunks < rec->maxChunks)
+    {
+        chunk = chunkAlloc();
+        if (chunk == NULL)
+        {
+            break;
+        }
+        rec->chunks[rec->usedChunks++] = chunk;
+    }
+
+    return rec->usedChunks > current ? 0 : -1;
+}
@@ -0,0 +1,193 @@
+// Date: 10/19/2026
+// Summary: Recording storage built from fixed-size chunks of a pre-reserved arena
+
+#ifndef STORE_H
+#define STORE_H
+
+#include <stddef.h>
+
+#define CHUNK_SHIFT 15                      // log2 of the number of samples in a chunk
+#define CHUNK_SAMPLES (1 << CHUNK_SHIFT)    // samples per chunk (64 KB)
+#define PAGE_SAMPLES 2048                   // samples per 4 KB page
+
+/**
+ * \brief Recording stored as a table of chunks allocated from the arena on demand
+ *
+ * Frames never straddle chunks, so frame i lives in chunk i >> frameShift.  Chunks hold a
+ * power of two frames, which wastes part of each chunk when channels is not a power of two.
+ *
+ * The first mappedChunks chunks may instead point into a file mapped by recordingMap; they
+ * are read-only and are unmapped rather than returned to the arena.
+ */
+typedef struct
+{
+    short** chunks;     // chunks holding the recording in order
+    size_t maxChunks;   // number of entries in chunks
+    size_t usedChunks;  // number of chunks claimed (one more than needed while prefaulting)
+    size_t frames;      // number of frames stored
+    int channels;       // number of samples in each frame
+    int frameShift;     // log2 of the number of frames per chunk
+    size_t frameMask;   // number of frames per chunk - 1
+    size_t pageMask;    // number of frames per page - 1
+    void* map;          // mapping of a file holding the first chunks (NULL if none)
+    size_t mapBytes;    // length of map
+    size_t mappedChunks;    // number of chunks which point into map
+} Recording;
+
+/**
+ * \brief Reserve the arena from which all recordings are allocated
+ *
+ * Normal pages are only committed once a chunk is first used.  Huge pages are committed
+ * up front (they must be reserved in /proc/sys/vm/nr_hugepages) but cut TLB misses when
+ * playing back long recordings.
+ *
+ * \param bytes         size of the arena (rounded down to a whole number of chunks)
+ * \param hugePages     whether to back the arena with huge pages
+ *
+ * \returns 0 on success, -1 if the arena could not be reserved
+ */
+int storeInit(size_t bytes, int hugePages);
+
+/**
+ * \brief Use memory reserved by the caller (such as a shared mapping) as the arena
+ *
+ * \param memory        start of the arena (aligned to a page)
+ * \param bytes         size of the arena (rounded down to a whole number of chunks)
+ *
+ * \returns 0 on success, -1 if the free stack could not be allocated
+ */
+int storeInitShared(void* memory, size_t bytes);
+
+/**
+ * \brief Report the memory used by the arena
+ *
+ * \param reserved      receives the size of the arena in bytes
+ * \param committed     receives the bytes of chunks which have ever been used
+ * \param inUse         receives the bytes of chunks which currently belong to a recording
+ */
+void storeUsage(size_t* reserved, size_t* committed, size_t* inUse);
+
+/**
+ * \brief Find the position of a chunk in the arena
+ *
+ * \returns index of the chunk, or -1 if it is not part of the arena (such as a mapped chunk)
+ */
+long storeChunkIndex(const short* chunk);
+
+/**
+ * \brief Initialize an empty recording
+ *
+ * \param rec           recording to initialize
+ * \param channels      number of samples in each frame
+ *
+ * \returns 0 on success, -1 if the chunk table could not be allocated
+ */
+int recordingInit(Recording* rec, int channels);
+
+/**
+ * \brief Remove all frames from a recording and return its chunks to the arena
+ */
+void recordingClear(Recording* rec);
+
+/**
+ * \brief Replace the contents of a recording with interleaved samples from a file
+ *
+ * Whole chunks are mapped straight from the file, so nothing is read until it is played.
+ * The partial chunk at the end is copied into the arena so that appending frames never
+ * writes to the file.  Only works when channels is a power of two, so the file's frames
+ * line up with the chunks.
+ *
+ * \param rec           recording to fill (cleared first)
+ * \param fd            file descriptor of the file
+ * \param offset        offset in bytes of the first sample (a multiple of the page size)
+ * \param frames        number of frames in the file
+ *
+ * \returns 0 on success, -1 if the file could not be mapped or the recording is too long
+ */
+int recordingMap(Recording* rec, int fd, size_t offset, size_t frames);
+
+/**
+ * \brief Ask the kernel to read ahead the mapped chunk after the one holding a frame
+ *
+ * Call when playback enters a new chunk so the next one is in memory before it is needed.
+ */
+void recordingPrefetch(const Recording* rec, size_t frame);
+
+/**
+ * \brief Claim the chunk for the next frame (and the chunk after it) from the arena
+ *
+ * \returns 0 on success, -1 if the arena or chunk table is full
+ */
+int recordingGrow(Recording* rec);
+
+/**
+ * \brief Return the oldest chunk of a recording to the arena, dropping its frames
+ *
+ * The frames after it move down by a chunk's worth, so a recording which is only ever appended
+ * to and dropped from holds a sliding window of its input.  Does nothing unless the oldest
+ * chunk is full and came from the arena.
+ */
+void recordingDropOldest(Recording* rec);
+
+/**
+ * \brief Get a frame of a recording
+ *
+ * \param rec           recording containing the frame
+ * \param frame         index of the frame (must be less than rec->frames)
+ *
+ * \returns pointer to the channels samples of the frame
+ */
+static inline short* recordingFrame(const Recording* rec, size_t frame)
+{
+    return rec->chunks[frame >> rec->frameShift] + (frame & rec->frameMask) * rec->channels;
+}
+
+/**
+ * \brief Append a frame to a recording
+ *
+ * \param rec           recording to extend
+ *
+ * \returns pointer to the samples of the new frame, or NULL if the arena is full
+ */
+static inline short* recordingAppend(Recording* rec)
+{
+    size_t offset = rec->frames & rec->frameMask;
+    size_t next = (rec->frames >> rec->frameShift) + 1;
+
+    // Claim a chunk from the arena whenever we start a new one
+    if (offset == 0 && recordingGrow(rec))
+    {
+        return NULL;
+    }
+
+    // Touch one page of the following chunk per page we fill, so its page faults are spread
+    // out instead of all landing on the first frame written to it
+    if ((offset & rec->pageMask) == 0 && next < rec->usedChunks)
+    {
+        rec->chunks[next][offset * rec->channels] = 0;
+    }
+
+    return recordingFrame(rec, rec->frames++);
+}
+
+/**
+ * \brief Append a frame to a recording which only keeps its most recent chunks
+ *
+ * The chunk dropped on entering a new chunk goes straight back into the recording from the
+ * arena's free stack, so the window runs in the same keepChunks + 2 committed chunks forever.
+ *
+ * \param rec           recording to extend
+ * \param keepChunks    full chunks to keep before the one being filled
+ *
+ * \returns pointer to the samples of the new frame, or NULL if the arena is full
+ */
+static inline short* recordingAppendRecent(Recording* rec, size_t keepChunks)
+{
+    if ((rec->frames & rec->frameMask) == 0 && (rec->frames >> rec->frameShift) > keepChunks)
+    {
+        recordingDropOldest(rec);
+    }
+    return recordingAppend(rec);
+}
+
+#endif
@@ -0,0 +1,229 @@
+// Date: 10/19/2026
+// Summary: Streams a recorded loop at a new tempo without changing its pitch (WSOLA)
+
+#include <math.h>
+#include <unistd.h>
+#include "stretch.h"
+#include "audio.h"
+
+/**
+ * \brief Sum the channels of part of the loop into a mono block, wrapping at its end
+ *
+ * \param dst           receives frames samples
+ * \param start         first frame (may be beyond the end of the loop)
+ */
+static void loadMono(const Recording* loop, float* dst, size_t start, size_t frames)
+{
+    size_t index = start % loop->frames;
+    short* frame;
+
+    for (size_t i = 0; i < frames; ++i)
+    {
+        frame = recordingFrame(loop, index);
+        dst[i] = frame[0];
+        for (int c = 1; c < loop->channels; ++c)
+        {
+            dst[i] += frame[c];
+        }
+        if (++index == loop->frames)
+        {
+            index = 0;
+        }
+    }
+}
+
+/**
+ * \brief Find the shift of the segment which best continues the previous one
+ *
+ * Maximizes the normalized cross-correlation of the reference with every candidate.
+ *
+ * \returns offset into s->search of the best candidate
+ */
+static size_t bestOffset(Stretcher* s)
+{
+    size_t best = STRETCH_SEARCH;
+    float bestScore = 0;
+    float energy = 0;
+    float score;
+    float correlation;
+
+    // Keep a running sum of the candidates' energy instead of recomputing it for each one
+    for (size_t i = 0; i < STRETCH_HOP; ++i)
+    {
+        energy += s->search[i] * s->search[i];
+    }
+
+    for (size_t offset = 0; offset <= 2 * STRETCH_SEARCH; ++offset)
+    {
+        correlation = dotProduct(s->reference, s->search + offset, STRETCH_HOP);
+        if (correlation > 0 && energy > 0)
+        {
+            score = correlation * correlation / energy;
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = offset;
+            }
+        }
+
+        if (offset < 2 * STRETCH_SEARCH)
+        {
+            energy += s->search[offset + STRETCH_HOP] * s->search[offset + STRETCH_HOP]
+                - s->search[offset] * s->search[offset];
+        }
+    }
+
+    return best;
+}
+
+void stretchHop(Stretcher* s, short* out)
+{
+    const Recording* loop = s->loop;
+    size_t length = loop->frames;
+    size_t target = (size_t)s->position;
+    size_t start = target;
+    size_t index;
+    short* frame;
+    float sample;
+
+    // Line the segment up with the natural continuation of the previous one
+    if (!s->first)
+    {
+        loadMono(loop, s->reference, s->previous + STRETCH_HOP, STRETCH_HOP);
+        loadMono(loop, s->search, target + length - STRETCH_SEARCH,
+            2 * STRETCH_SEARCH + STRETCH_HOP);
+        start = (target + length - STRETCH_SEARCH + bestOffset(s)) % length;
+    }
+    s->first = 0;
+
+    // Overlap-add the segment: the first half completes this hop, the second half is kept
+    index = start;
+    for (size_t i = 0; i < STRETCH_WINDOW; ++i)
+    {
+        frame = recordingFrame(loop, index);
+        for (int c = 0; c < MAX_CHANNELS; ++c)
+        {
+            sample = frame[c < loop->channels ? c : 0] * s->window[i];
+            if (i < STRETCH_HOP)
+            {
+                sample += s->overlap[c][i];
+                sample = sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample;
+                out[i * MAX_CHANNELS + c] = (short)lrintf(sample);
+            }
+            else
+            {
+                s->overlap[c][i - STRETCH_HOP] = sample;
+            }
+        }
+        if (++index == length)
+        {
+            index = 0;
+        }
+    }
+
+    // Advance through the loop at the rate which makes it last outFrames
+    s->previous = start;
+    s->position += (double)STRETCH_HOP * length / s->outFrames;
+    if (s->position >= length)
+    {
+        s->position -= length;
+    }
+}
+
+/**
+ * \brief Thread which keeps the queue full while running
+ */
+static void* stretchThread(void* arg)
+{
+    Stretcher* s = arg;
+    short hop[STRETCH_HOP * MAX_CHANNELS];
+    size_t i;
+
+    while (1)
+    {
+        if (atomic_load(&s->state) == STRETCH_RUN
+            && ringCount(&s->frames) + STRETCH_HOP <= s->frames.mask + 1)
+        {
+            // Claim the loop, then make sure the audio loop didn't stop the stretch meanwhile;
+            // stretchStop clears state before checking busy, so one of them sees the other
+            atomic_store(&s->busy, 1);
+            if (atomic_load(&s->state) == STRETCH_RUN)
+            {
+                stretchHop(s, hop);
+                for (i = 0; i < STRETCH_HOP; ++i)
+                {
+                    ringPush(&s->frames, hop + i * MAX_CHANNELS);
+                }
+                atomic_store(&s->busy, 0);
+                continue;
+            }
+            atomic_store(&s->busy, 0);
+        }
+        usleep(1000);
+    }
+    return NULL;
+}
+
+int stretchInit(Stretcher* s)
+{
+    // A periodic Hann window sums to exactly one when overlapped by half
+    for (int i = 0; i < STRETCH_WINDOW; ++i)
+    {
+        s->window[i] = 0.5f - 0.5f * cosf(2 * M_PI * i / STRETCH_WINDOW);
+    }
+    s->underruns = 0;
+    atomic_init(&s->state, STRETCH_IDLE);
+    atomic_init(&s->busy, 0);
+
+    if (ringInit(&s->frames, MAX_CHANNELS * sizeof(short), STRETCH_QUEUE)
+        || pthread_create(&s->thread, NULL, stretchThread, s))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void stretchStart(Stretcher* s, const Recording* loop, size_t outFrames)
+{
+    short hop[STRETCH_HOP * MAX_CHANNELS];
+
+    s->loop = loop;
+    s->outFrames = outFrames;
+    s->position = 0;
+    s->previous = 0;
+    s->first = 1;
+    for (int c = 0; c < MAX_CHANNELS; ++c)
+    {
+        for (int i = 0; i < STRETCH_HOP; ++i)
+        {
+            s->overlap[c][i] = 0;
+        }
+    }
+
+    // The thread is idle, so the queue is ours to fill until it is handed over
+    stretchHop(s, hop);
+    for (int i = 0; i < STRETCH_HOP; ++i)
+    {
+        ringPush(&s->frames, hop + i * MAX_CHANNELS);
+    }
+    atomic_store(&s->state, STRETCH_RUN);
+}
+
+void stretchStop(Stretcher* s)
+{
+    short frame[MAX_CHANNELS];
+
+    if (atomic_load(&s->state) == STRETCH_IDLE)
+    {
+        return;
+    }
+    atomic_store(&s->state, STRETCH_IDLE);
+
+    // A hop already being made is finished before the loop is let go; no new one starts
+    while (atomic_load(&s->busy))
+    {
+    }
+    while (!ringPop(&s->frames, frame))
+    {
+    }
+}
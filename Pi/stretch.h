@@ -0,0 +1,107 @@
+// Date: 10/19/2026
+// Summary: Streams a recorded loop at a new tempo without changing its pitch (WSOLA)
+
+#ifndef STRETCH_H
+#define STRETCH_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "ring.h"
+#include "store.h"
+#include "wav.h"
+
+#define STRETCH_WINDOW 1024                 // frames in each overlapped segment (21 ms)
+#define STRETCH_HOP (STRETCH_WINDOW / 2)    // output frames added by each segment
+#define STRETCH_SEARCH 256                  // furthest a segment may move to line up (5 ms)
+#define STRETCH_QUEUE 4096                  // stretched frames buffered for the audio loop
+#define STRETCH_MIN 0.5f                    // shortest stretched loop relative to the original
+#define STRETCH_MAX 2.0f                    // longest stretched loop relative to the original
+
+/**
+ * \brief Background thread which time-stretches a loop into a queue of frames
+ *
+ * Each output hop overlap-adds a Hann-windowed segment of the loop.  The segment is taken
+ * from near where the new tempo says the loop should be, shifted by up to STRETCH_SEARCH
+ * frames to the position whose start best matches the natural continuation of the previous
+ * segment, so waveforms line up and the pitch is kept.  The loop wraps around, so a stretched
+ * loop of outFrames frames reads the original exactly once.
+ */
+typedef struct
+{
+    Ring frames;                // stretched frames (MAX_CHANNELS samples each) for the audio loop
+    const Recording* loop;      // loop being stretched (must not change while running)
+    size_t outFrames;           // frames in one pass of the stretched loop
+    atomic_int state;           // STRETCH_IDLE or STRETCH_RUN
+    atomic_int busy;            // whether the thread is making a hop (and reading the loop)
+    double position;            // position in the loop where the next segment should start
+    size_t previous;            // position in the loop where the last segment started
+    int first;                  // whether no segment has been played since starting
+    float window[STRETCH_WINDOW];   // Hann window
+    float reference[STRETCH_HOP];   // continuation of the previous segment (channels summed)
+    float search[2 * STRETCH_SEARCH + STRETCH_HOP];   // candidate starts (channels summed)
+    float overlap[MAX_CHANNELS][STRETCH_HOP];   // second half of the previous segment, windowed
+    size_t underruns;           // frames the audio loop wanted before they were ready
+    pthread_t thread;           // thread running the stretch
+} Stretcher;
+
+enum
+{
+    STRETCH_IDLE,               // thread is waiting to be started
+    STRETCH_RUN                 // thread is filling the queue
+};
+
+/**
+ * \brief Start the stretching thread (idle until stretchStart)
+ *
+ * \returns 0 on success, -1 on failure
+ */
+int stretchInit(Stretcher* s);
+
+/**
+ * \brief Begin streaming a loop at a new length (called by the audio loop)
+ *
+ * Makes the first hop itself, which needs no search, so playback starts without a gap and
+ * without waiting for the thread.
+ *
+ * \param s             idle stretcher
+ * \param loop          loop to stretch
+ * \param outFrames     frames in the stretched loop (between STRETCH_MIN and STRETCH_MAX times
+ *                      the loop's length)
+ */
+void stretchStart(Stretcher* s, const Recording* loop, size_t outFrames);
+
+/**
+ * \brief Stop streaming and discard the queued frames (called by the audio loop)
+ *
+ * Once this returns the loop is no longer read and may be changed.  The thread checks for the
+ * stop before each hop, so this only waits if a hop is already being made.
+ */
+void stretchStop(Stretcher* s);
+
+/**
+ * \brief Take the next stretched frame (called by the audio loop)
+ *
+ * \param frame         receives MAX_CHANNELS samples (silence if the thread fell behind)
+ */
+static inline void stretchNext(Stretcher* s, short* frame)
+{
+    if (ringPop(&s->frames, frame))
+    {
+        for (int c = 0; c < MAX_CHANNELS; ++c)
+        {
+            frame[c] = 0;
+        }
+        s->underruns++;
+    }
+}
+
+/**
+ * \brief Produce one hop of stretched frames
+ *
+ * Called by the thread; exposed so the stretch can be run without one.
+ *
+ * \param out           receives STRETCH_HOP frames of MAX_CHANNELS samples
+ */
+void stretchHop(Stretcher* s, short* out);
+
+#endif
@@ -0,0 +1,85 @@
+// Date: 10/19/2026
+// Summary: Generates tables.h, the lookup tables for the effects, when the receiver is built
+
+#include <stdio.h>
+#include "effects.h"
+
+/**
+ * \brief Convert an 11-bit sign-magnitude sample from the FPGA to a 16-bit sample
+ */
+static int decode(int bits)
+{
+    int sample = bits & 0x3FF;
+    return ((bits >> 10) & 0x1 ? -sample : sample) * VOLUME;
+}
+
+/**
+ * \brief Overdrive and saturate a magnitude as effects.sv does
+ *
+ * \param overdrive     whether overdrive is on
+ * \param sensor        whether the intensity controls the overdrive
+ * \param intensity     intensity from 0 to 15
+ */
+static int shape(int magnitude, int overdrive, int sensor, int intensity)
+{
+    unsigned int overdriven = magnitude;
+    unsigned int threshold = 0x3FF;
+
+    if (overdrive)
+    {
+        if (magnitude > 0x1F)
+        {
+            overdriven = (magnitude << (sensor ? intensity : 2)) & 0xFFFF;
+        }
+        threshold = sensor ? ((intensity << 6) - 1 + 0x7F) & 0xFFFF : 0xFF;
+    }
+    return (overdriven > threshold ? threshold : overdriven) & 0x3FF;
+}
+
+/**
+ * \brief Print a table as a C array
+ */
+static void printTable(const int* values, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        printf("%s%d,%s", i % 12 ? " " : "    ", values[i], i % 12 == 11 || i == count - 1
+            ? "\n" : "");
+    }
+}
+
+int main()
+{
+    int values[EFFECTS_MAGNITUDES];
+
+    printf("// Generated by tablegen.c; do not edit\n\n");
+    printf("#ifndef TABLES_H\n#define TABLES_H\n\n");
+
+    // Sign-magnitude decoding with the volume applied
+    printf("// 16-bit sample for each 11-bit sign-magnitude sample from the FPGA\n");
+    printf("static const short decodeTable[2048] = {\n");
+    for (int i = 0; i < 2048; ++i)
+    {
+        values[i] = decode(i);
+    }
+    printTable(values, 2048);
+    printf("};\n\n");
+
+    // Overdrive and saturation: clean, overdrive, then overdrive at each intensity
+    printf("// Magnitude after overdrive and saturation for each magnitude of the sum\n");
+    printf("static const unsigned short shapeTables[%d][%d] = {\n", EFFECTS_SHAPES,
+        EFFECTS_MAGNITUDES);
+    for (int t = 0; t < EFFECTS_SHAPES; ++t)
+    {
+        for (int i = 0; i < EFFECTS_MAGNITUDES; ++i)
+        {
+            values[i] = shape(i, t > 0, t > 1, t > 1 ? t - 2 : 0);
+        }
+        printf("  {\n");
+        printTable(values, EFFECTS_MAGNITUDES);
+        printf("  },\n");
+    }
+    printf("};\n\n#endif\n");
+
+    return 0;
+}
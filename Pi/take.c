@@ -0,0 +1,358 @@
+// Date: 10/19/2026
+// Summary: Keeps every saved recording as a numbered take with a compact on-disk index
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "take.h"
+#include "wav.h"
+
+/**
+ * \brief Path of the index file
+ */
+static void indexPath(const TakeStore* store, char* path)
+{
+    snprintf(path, TAKE_PATH, "%s/index.bin", store->dir);
+}
+
+/**
+ * \brief Make room for one more entry in memory
+ *
+ * \returns 0 on success, -1 if out of memory
+ */
+static int takeReserve(TakeStore* store, size_t count)
+{
+    size_t capacity = store->capacity ? store->capacity : 64;
+    TakeEntry* entries;
+
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+    if (capacity == store->capacity)
+    {
+        return 0;
+    }
+    entries = realloc(store->entries, capacity * sizeof(TakeEntry));
+    if (entries == NULL)
+    {
+        return -1;
+    }
+    store->entries = entries;
+    store->capacity = capacity;
+    return 0;
+}
+
+int takeStoreOpen(TakeStore* store, const char* dir)
+{
+    char path[TAKE_PATH];
+    TakeIndexHeader header;
+    size_t entrySize;
+    FILE* file;
+
+    store->entries = NULL;
+    store->count = 0;
+    store->capacity = 0;
+    store->readOnly = 1;
+
+    // A shorter directory leaves room for the name of every file in it
+    if (snprintf(store->dir, sizeof(store->dir), "%s", dir) >= (int)sizeof(store->dir)
+        || (mkdir(dir, 0755) && access(dir, W_OK)))
+    {
+        return -1;
+    }
+
+    // A missing index is an empty store
+    indexPath(store, path);
+    file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        if (errno != ENOENT || takeReserve(store, 1))
+        {
+            return -1;
+        }
+        store->readOnly = 0;
+        return 0;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != TAKE_MAGIC
+        || header.version != TAKE_VERSION || header.entrySize < sizeof(TakeEntry)
+        || takeReserve(store, header.count))
+    {
+        fclose(file);
+        return -1;
+    }
+
+    // Read every entry at once unless a newer version added fields to them
+    entrySize = header.entrySize;
+    if (entrySize == sizeof(TakeEntry))
+    {
+        store->count = fread(store->entries, sizeof(TakeEntry), header.count, file);
+    }
+    else
+    {
+        while (store->count < header.count
+            && fread(&store->entries[store->count], sizeof(TakeEntry), 1, file) == 1)
+        {
+            fseek(file, entrySize - sizeof(TakeEntry), SEEK_CUR);
+            store->count++;
+        }
+    }
+    fclose(file);
+
+    if (store->count != header.count)
+    {
+        return -1;
+    }
+
+    // Appending our shorter entries would corrupt an index with longer ones, so only read it
+    store->readOnly = entrySize != sizeof(TakeEntry);
+    return 0;
+}
+
+/**
+ * \brief Add an entry to the end of the index file
+ *
+ * The entry is written before the count is updated, so an interrupted save leaves the index
+ * as it was.
+ *
+ * \returns 0 on success, -1 on failure
+ */
+static int indexAppend(const TakeStore* store, const TakeEntry* entry, size_t count)
+{
+    char path[TAKE_PATH];
+    TakeIndexHeader header = {TAKE_MAGIC, TAKE_VERSION, count + 1, sizeof(TakeEntry)};
+    FILE* file;
+    int result;
+    int fd;
+
+    // Only the first take creates the index, and never over one which is already there
+    indexPath(store, path);
+    file = fopen(path, "r+b");
+    if (file == NULL && errno == ENOENT && count == 0)
+    {
+        fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+        file = fd < 0 ? NULL : fdopen(fd, "r+b");
+        if (file == NULL && fd >= 0)
+        {
+            close(fd);
+        }
+    }
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    result = fseek(file, sizeof(header) + count * sizeof(TakeEntry), SEEK_SET) == 0
+        && fwrite(entry, sizeof(TakeEntry), 1, file) == 1
+        && fflush(file) == 0
+        && fseek(file, 0, SEEK_SET) == 0
+        && fwrite(&header, sizeof(header), 1, file) == 1;
+
+    return fclose(file) == 0 && result ? 0 : -1;
+}
+
+/**
+ * \brief Fill in a new take's entry and start its file
+ *
+ * \returns the file positioned at the first sample, or NULL on failure
+ */
+static FILE* takeCreate(TakeStore* store, TakeEntry* entry, int channels, size_t frames,
+    size_t beatTime, int beatsPerMeasure, int measures)
+{
+    char path[TAKE_PATH];
+    FILE* file = NULL;
+
+    if (store->readOnly)
+    {
+        return NULL;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->id = store->count ? store->entries[store->count - 1].id + 1 : 1;
+    entry->frames = frames;
+    entry->beatTime = measures ? beatTime : 0;
+    entry->channels = channels;
+    entry->beatsPerMeasure = beatsPerMeasure;
+    entry->measures = measures;
+    entry->seekFrames = measures ? beatTime * beatsPerMeasure : SAMPLE_RATE;
+    entry->created = time(NULL);
+
+    if (takeReserve(store, store->count + 1))
+    {
+        return NULL;
+    }
+
+    // Frames are stored interleaved, so samples can be written directly after the header; a
+    // file which is already there (left by a save which never reached the index) is kept and
+    // its number skipped
+    for (int tries = 0; tries < TAKE_TRIES; ++tries, entry->id++)
+    {
+        takePath(store, entry, path);
+        file = fopen(path, "wbx");
+        if (file != NULL || errno != EEXIST)
+        {
+            break;
+        }
+    }
+    if (file != NULL)
+    {
+        entry->dataOffset = wavWriteHeaderAligned(file, channels, frames, TAKE_ALIGN);
+    }
+    return file;
+}
+
+/**
+ * \brief Close a new take's file and add its entry to the index if every frame was written
+ *
+ * A file cut short (say, by a full SD card) is left out of the index, like one whose save was
+ * interrupted, so its number is skipped by later saves.
+ *
+ * \param written       frames written to the file
+ *
+ * \returns the new take, or NULL if it could not be saved
+ */
+static const TakeEntry* takeFinish(TakeStore* store, const TakeEntry* entry, FILE* file,
+    size_t written)
+{
+    if (fclose(file) || written != entry->frames || indexAppend(store, entry, store->count))
+    {
+        return NULL;
+    }
+    store->entries[store->count] = *entry;
+    return &store->entries[store->count++];
+}
+
+const TakeEntry* takeSave(TakeStore* store, const Recording* rec, size_t beatTime,
+    int beatsPerMeasure, int measures)
+{
+    size_t chunkFrames = rec->frameMask + 1;
+    size_t frames;
+    size_t written = 0;
+    TakeEntry entry;
+    FILE* file = takeCreate(store, &entry, rec->channels, rec->frames, beatTime,
+        beatsPerMeasure, measures);
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < rec->frames && written == i; i += frames)
+    {
+        frames = rec->frames - i < chunkFrames ? rec->frames - i : chunkFrames;
+        written += fwrite(recordingFrame(rec, i), sizeof(short) * rec->channels, frames, file);
+    }
+    return takeFinish(store, &entry, file, written);
+}
+
+const TakeEntry* takeSaveSamples(TakeStore* store, const short* samples, size_t frames,
+    int channels, int flags)
+{
+    size_t written;
+    TakeEntry entry;
+    FILE* file = takeCreate(store, &entry, channels, frames, 0, 0, 0);
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    entry.flags = flags;
+    written = fwrite(samples, sizeof(short) * channels, frames, file);
+    return takeFinish(store, &entry, file, written);
+}
+
+const TakeEntry* takeFind(const TakeStore* store, unsigned int id)
+{
+    for (size_t i = 0; i < store->count; ++i)
+    {
+        if (store->entries[i].id == id)
+        {
+            return &store->entries[i];
+        }
+    }
+    return NULL;
+}
+
+const TakeEntry* takeLatest(const TakeStore* store, int loop)
+{
+    for (size_t i = store->count; i > 0; --i)
+    {
+        if ((store->entries[i - 1].measures != 0) == loop
+            && !(store->entries[i - 1].flags & TAKE_PIECE))
+        {
+            return &store->entries[i - 1];
+        }
+    }
+    return NULL;
+}
+
+void takePath(const TakeStore* store, const TakeEntry* take, char* path)
+{
+    snprintf(path, TAKE_PATH, "%s/take-%04u.wav", store->dir, take->id);
+}
+
+int takeLoad(const TakeStore* store, const TakeEntry* take, Recording* rec)
+{
+    char path[TAKE_PATH];
+    int fd;
+    int result;
+
+    if (take->channels != rec->channels)
+    {
+        return -1;
+    }
+
+    // The mapping keeps the file open, so the descriptor is not needed afterwards
+    takePath(store, take, path);
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    result = recordingMap(rec, fd, take->dataOffset, take->frames);
+    close(fd);
+    return result;
+}
+
+const short* takeMapSamples(const TakeStore* store, const TakeEntry* take, size_t* bytes)
+{
+    char path[TAKE_PATH];
+    void* map;
+    int fd;
+
+    *bytes = (size_t)take->frames * take->channels * sizeof(short);
+    takePath(store, take, path);
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || *bytes == 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return NULL;
+    }
+    map = mmap(NULL, *bytes, PROT_READ, MAP_SHARED, fd, take->dataOffset);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+    madvise(map, *bytes, MADV_SEQUENTIAL);
+    return map;
+}
+
+size_t takeSeek(const TakeEntry* take, float seconds)
+{
+    size_t frame = seconds > 0 ? (size_t)(seconds * SAMPLE_RATE) : 0;
+    if (frame >= take->frames)
+    {
+        return 0;
+    }
+    return frame / take->seekFrames * take->seekFrames;
+}
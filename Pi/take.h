@@ -0,0 +1,153 @@
+// Date: 10/19/2026
+// Summary: Keeps every saved recording as a numbered take with a compact on-disk index
+
+#ifndef TAKE_H
+#define TAKE_H
+
+#include <stddef.h>
+#include "store.h"
+
+#define TAKE_DIR "/var/www/html/takes"  // directory holding the takes and their index
+#define TAKE_MAGIC 0x454B4154           // "TAKE" at the start of the index
+#define TAKE_VERSION 1                  // version of the index format
+#define TAKE_ALIGN 4096                 // alignment of the samples in each take file
+#define TAKE_PATH 256                   // maximum length of a path in the store
+#define TAKE_NAME 32                    // room in TAKE_PATH for a file name after the directory
+#define TAKE_PIECE 1                    // TakeEntry flag of a piece split from a longer take
+#define TAKE_TRIES 100                  // numbers tried past files the index doesn't list
+
+/**
+ * \brief Header at the start of the index file, followed by count TakeEntries
+ */
+typedef struct
+{
+    unsigned int magic;         // TAKE_MAGIC
+    unsigned int version;       // TAKE_VERSION
+    unsigned int count;         // number of entries
+    unsigned int entrySize;     // sizeof(TakeEntry), so old readers can skip new fields
+} TakeIndexHeader;
+
+/**
+ * \brief Description of one take in the index
+ *
+ * Samples are stored as uncompressed interleaved PCM starting at dataOffset, so any frame can
+ * be found without reading the file.  Coarse seek points fall every seekFrames frames (each
+ * measure of a loop, or each second of a linear take).
+ */
+typedef struct
+{
+    unsigned int id;            // number of the take (in its file name)
+    unsigned int frames;        // number of frames in the take
+    unsigned int dataOffset;    // offset in bytes of the first sample in the file
+    unsigned int seekFrames;    // frames between seek points
+    unsigned int beatTime;      // samples per beat of a loop (0 for a linear take)
+    unsigned short channels;    // number of interleaved channels
+    unsigned short beatsPerMeasure; // beats in each measure of a loop
+    unsigned short measures;    // measures in a loop (0 for a linear take)
+    unsigned short flags;       // TAKE_PIECE, or 0 (older indexes always have 0)
+    long long created;          // time at which the take was saved (seconds since the epoch)
+} TakeEntry;
+
+/**
+ * \brief Index of all takes, loaded into memory
+ */
+typedef struct
+{
+    char dir[TAKE_PATH - TAKE_NAME];    // directory holding the takes
+    TakeEntry* entries;                 // takes in the order they were saved
+    size_t count;                       // number of takes
+    size_t capacity;                    // number of entries allocated
+    int readOnly;                       // whether saving is off (the index is unreadable or newer)
+} TakeStore;
+
+/**
+ * \brief Load the index of a take directory, creating the directory if needed
+ *
+ * If the directory or index can't be used, the store is left read-only (takes found so far
+ * can still be loaded, but nothing is saved) so that existing takes are never overwritten.
+ * An index written by a newer version with longer entries is loaded but also left read-only.
+ *
+ * \param store         store to initialize
+ * \param dir           directory holding the takes (shorter than TAKE_PATH - TAKE_NAME)
+ *
+ * \returns 0 on success, -1 if the directory or index could not be used
+ */
+int takeStoreOpen(TakeStore* store, const char* dir);
+
+/**
+ * \brief Write a recording as a new take and add it to the index
+ *
+ * \param store         store to add to
+ * \param rec           recording to save
+ * \param beatTime      samples per beat for a loop (0 for a linear take)
+ * \param beatsPerMeasure   beats in each measure of a loop
+ * \param measures      measures in a loop (0 for a linear take)
+ *
+ * \returns the new take, or NULL if it could not be saved
+ */
+const TakeEntry* takeSave(TakeStore* store, const Recording* rec, size_t beatTime,
+    int beatsPerMeasure, int measures);
+
+/**
+ * \brief Write interleaved samples as a new linear take and add it to the index
+ *
+ * \param store         store to add to
+ * \param samples       frames * channels interleaved samples
+ * \param frames        number of frames
+ * \param channels      number of channels
+ * \param flags         TakeEntry flags (such as TAKE_PIECE)
+ *
+ * \returns the new take, or NULL if it could not be saved
+ */
+const TakeEntry* takeSaveSamples(TakeStore* store, const short* samples, size_t frames,
+    int channels, int flags);
+
+/**
+ * \brief Map a take's samples straight from its file
+ *
+ * \param bytes         receives the length of the mapping
+ *
+ * \returns frames * channels interleaved samples (unmap with munmap), or NULL on failure
+ */
+const short* takeMapSamples(const TakeStore* store, const TakeEntry* take, size_t* bytes);
+
+/**
+ * \brief Find a take by its number
+ *
+ * \returns the take, or NULL if there is no such take
+ */
+const TakeEntry* takeFind(const TakeStore* store, unsigned int id);
+
+/**
+ * \brief Find the most recent linear or loop take, skipping pieces split from other takes
+ *
+ * \param loop          whether to look for a loop take
+ *
+ * \returns the take, or NULL if there is no such take
+ */
+const TakeEntry* takeLatest(const TakeStore* store, int loop);
+
+/**
+ * \brief Path of a take's file
+ *
+ * \param path          receives the path (TAKE_PATH characters)
+ */
+void takePath(const TakeStore* store, const TakeEntry* take, char* path);
+
+/**
+ * \brief Map a take into a recording without reading it
+ *
+ * \param rec           recording to fill (must have the same number of channels as the take)
+ *
+ * \returns 0 on success, -1 on failure
+ */
+int takeLoad(const TakeStore* store, const TakeEntry* take, Recording* rec);
+
+/**
+ * \brief First frame of the seek point at or before a time
+ *
+ * \param seconds       time from the start of the take
+ */
+size_t takeSeek(const TakeEntry* take, float seconds);
+
+#endif
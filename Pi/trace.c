@@ -0,0 +1,506 @@
+// Date: 10/19/2026
+// Summary: Compact pin-level traces of the SPI and user interface pins for replaying off the rig
+
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include "trace.h"
+
+#define TRACE_MAGIC "PINTRACE"
+#define TOKEN(pin, reads) ((unsigned char)(((pin) << 4) | (reads)))
+#define SCLK_INDEX 1                // index of SCLK in the trace
+#define MOSI_INDEX 2                // index of MOSI in the trace
+
+/**
+ * \brief Current time in microseconds
+ */
+static long long nowMicros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+////////////////////////////////
+//  Capture
+////////////////////////////////
+
+/**
+ * \brief Hand the chunk to the writer thread, stopping the trace if the writer is behind
+ */
+static void handChunk(Trace* trace)
+{
+    if (trace->chunk.used == 0)
+    {
+        return;
+    }
+    if (ringPush(&trace->chunks, &trace->chunk))
+    {
+        trace->dropped++;
+        trace->active = 0;
+    }
+    trace->chunk.used = 0;
+}
+
+static void putByte(Trace* trace, unsigned char byte)
+{
+    trace->chunk.bytes[trace->chunk.used++] = byte;
+    if (trace->chunk.used == TRACE_CHUNK)
+    {
+        handChunk(trace);
+    }
+}
+
+/**
+ * \brief Write 7 bits at a time, low bits first, with the top bit set on all but the last byte
+ */
+static void putVarint(Trace* trace, unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        putByte(trace, (value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    putByte(trace, value);
+}
+
+/**
+ * \brief Write any repeats of the last token which are still being counted
+ */
+static void flushRepeats(Trace* trace)
+{
+    if (trace->repeats > 0)
+    {
+        putByte(trace, TOKEN(TRACE_REPEAT, TRACE_META));
+        putVarint(trace, trace->repeats);
+        trace->repeats = 0;
+    }
+}
+
+/**
+ * \brief Write a token of one byte, counting it as a repeat if it matches the last one
+ */
+static void putToken(Trace* trace, unsigned char token)
+{
+    if (token == trace->lastToken)
+    {
+        trace->repeats++;
+        return;
+    }
+    flushRepeats(trace);
+    putByte(trace, token);
+    trace->lastToken = token;
+}
+
+/**
+ * \brief Write the changes of SCLK held back in case another fits in their byte
+ */
+static void flushSclk(Trace* trace)
+{
+    if (trace->sclk > 0)
+    {
+        putToken(trace, trace->sclkToken);
+        trace->sclk = 0;
+    }
+}
+
+/**
+ * \brief Write a change of a pin which came reads reads of it after its last change
+ */
+static void writeEdge(Trace* trace, int index, unsigned int reads)
+{
+    flushSclk(trace);
+    if (reads < TRACE_LONG)
+    {
+        putToken(trace, TOKEN(index, reads));
+    }
+    else
+    {
+        flushRepeats(trace);
+        putByte(trace, TOKEN(index, TRACE_LONG));
+        putVarint(trace, reads);
+        trace->lastToken = -1;
+    }
+}
+
+/**
+ * \brief Write a change of SCLK, packing it with its neighbours where the read counts are small
+ */
+static void writeSclk(Trace* trace, unsigned int reads, int rising)
+{
+    if (reads == 0 || reads > TRACE_SCLK_READS)
+    {
+        writeEdge(trace, SCLK_INDEX, reads);
+        trace->riseReads = UINT_MAX;
+        return;
+    }
+    if (trace->sclk == 2)
+    {
+        flushSclk(trace);
+    }
+    if (trace->sclk == 0)
+    {
+        trace->sclkToken = TRACE_SCLK | (reads - 1) << 5;
+    }
+    else
+    {
+        trace->sclkToken |= (reads - 1) << 2 | 1;
+    }
+    trace->sclk++;
+    trace->riseReads = rising ? trace->reads[MOSI_INDEX] : UINT_MAX;
+}
+
+/**
+ * \brief Write a change of MOSI, folding it into the last change of SCLK if it was read right
+ *        after SCLK rose
+ */
+static void writeMosi(Trace* trace, unsigned int reads)
+{
+    if (trace->sclk > 0 && trace->riseReads + 1 == trace->reads[MOSI_INDEX])
+    {
+        trace->sclkToken |= trace->sclk == 1 ? 1 << 4 : 1 << 1;
+        trace->riseReads = UINT_MAX;
+        return;
+    }
+    writeEdge(trace, MOSI_INDEX, reads);
+}
+
+/**
+ * \brief Write a TRACE_TIME or TRACE_POLL record
+ */
+static void writeTime(Trace* trace, int type, long long time)
+{
+    long long delta = time - trace->time;
+
+    flushSclk(trace);
+    flushRepeats(trace);
+    putByte(trace, TOKEN(type, TRACE_META));
+    putVarint(trace, ((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63));
+    trace->time = time;
+}
+
+/**
+ * \brief Background thread which writes chunks to the file until the trace is stopped
+ */
+static void* traceThread(void* arg)
+{
+    Trace* trace = arg;
+    TraceChunk chunk;
+    int stopping;
+
+    while (1)
+    {
+        stopping = trace->stop;
+        while (!ringPop(&trace->chunks, &chunk))
+        {
+            trace->written += fwrite(chunk.bytes, 1, chunk.used, trace->file);
+        }
+        fflush(trace->file);
+        if (stopping)
+        {
+            return NULL;
+        }
+        usleep(TRACE_WRITE_TIME);
+    }
+}
+
+int traceStart(Trace* trace, const char* path, const int* pins, unsigned int levels)
+{
+    TraceHeader header = {.magic = TRACE_MAGIC, .version = TRACE_VERSION};
+
+    memset(trace, 0, sizeof(Trace));
+    trace->lastToken = -1;
+    trace->riseReads = UINT_MAX;
+    trace->time = nowMicros();
+    trace->uiLevels = levels;
+    for (int i = 0; i < TRACE_PINS; ++i)
+    {
+        trace->pins[i] = header.pins[i] = pins[i];
+        trace->levels |= ((levels >> pins[i]) & 1) << i;
+    }
+    header.levels = trace->levels;
+    header.start = trace->time;
+
+    trace->file = fopen(path, "wb");
+    if (trace->file == NULL)
+    {
+        return -1;
+    }
+    if (fwrite(&header, sizeof(header), 1, trace->file) != 1
+        || ringInit(&trace->chunks, sizeof(TraceChunk), TRACE_CHUNKS)
+        || ringInit(&trace->polls, sizeof(TracePoll), TRACE_UI_QUEUE)
+        || pthread_create(&trace->thread, NULL, traceThread, trace))
+    {
+        fclose(trace->file);
+        return -1;
+    }
+    trace->written = sizeof(header);
+    trace->active = 1;
+    return 0;
+}
+
+void traceStop(Trace* trace)
+{
+    if (trace->active)
+    {
+        flushSclk(trace);
+        flushRepeats(trace);
+        putByte(trace, TOKEN(TRACE_END, TRACE_META));
+        handChunk(trace);
+        trace->active = 0;
+    }
+    trace->stop = 1;
+    pthread_join(trace->thread, NULL);
+    fclose(trace->file);
+    ringFree(&trace->chunks);
+    ringFree(&trace->polls);
+}
+
+void traceEdge(Trace* trace, int index)
+{
+    trace->levels ^= 1u << index;
+    if (index == SCLK_INDEX)
+    {
+        writeSclk(trace, trace->reads[index], (trace->levels >> index) & 1);
+    }
+    else if (index == MOSI_INDEX)
+    {
+        writeMosi(trace, trace->reads[index]);
+    }
+    else
+    {
+        writeEdge(trace, index, trace->reads[index]);
+    }
+    trace->reads[index] = 0;
+}
+
+/**
+ * \brief Write the changes of the UI pins seen by one poll, then the time of the poll
+ *
+ * An edge latched without a change in level is written as two changes.
+ */
+static void mergePoll(Trace* trace, const TracePoll* poll)
+{
+    unsigned int level, latched;
+
+    for (int i = TRACE_SPI_PINS; i < TRACE_PINS; ++i)
+    {
+        level = (poll->levels >> trace->pins[i]) & 1;
+        latched = (poll->events >> trace->pins[i]) & 1;
+        if (level != ((trace->levels >> i) & 1) || latched)
+        {
+            writeEdge(trace, i, 0);
+            if (level == ((trace->levels >> i) & 1))
+            {
+                writeEdge(trace, i, 0);
+            }
+            trace->levels = (trace->levels & ~(1u << i)) | (level << i);
+        }
+    }
+    writeTime(trace, TRACE_POLL, poll->time);
+}
+
+void traceFrame(Trace* trace)
+{
+    TracePoll poll;
+
+    if (++trace->frames >= TRACE_SYNC)
+    {
+        trace->frames = 0;
+        writeTime(trace, TRACE_TIME, nowMicros());
+    }
+    while (!ringPop(&trace->polls, &poll))
+    {
+        mergePoll(trace, &poll);
+    }
+
+    // Keep the file current even when little is changing
+    if (++trace->unflushed >= TRACE_FLUSH)
+    {
+        trace->unflushed = 0;
+        handChunk(trace);
+    }
+}
+
+void traceInput(Trace* trace, unsigned int events, unsigned int levels)
+{
+    unsigned int mask = 0;
+    TracePoll poll;
+
+    for (int i = TRACE_SPI_PINS; i < TRACE_PINS; ++i)
+    {
+        mask |= 1u << trace->pins[i];
+    }
+    if (!trace->active || !((events | (levels ^ trace->uiLevels)) & mask))
+    {
+        return;
+    }
+
+    trace->uiLevels = levels;
+    poll.events = events & mask;
+    poll.levels = levels;
+    poll.time = nowMicros();
+    if (ringPush(&trace->polls, &poll))
+    {
+        trace->lostPolls++;
+    }
+}
+
+////////////////////////////////
+//  Replay
+////////////////////////////////
+
+int traceOpen(TraceReader* reader, const char* path)
+{
+    memset(reader, 0, sizeof(TraceReader));
+    reader->lastToken = -1;
+    reader->second = -1;
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL)
+    {
+        return -1;
+    }
+    if (fread(&reader->header, sizeof(TraceHeader), 1, reader->file) != 1
+        || memcmp(reader->header.magic, TRACE_MAGIC, sizeof(reader->header.magic))
+        || reader->header.version != TRACE_VERSION)
+    {
+        fclose(reader->file);
+        return -1;
+    }
+    reader->time = reader->header.start;
+    return 0;
+}
+
+/**
+ * \brief Read a varint
+ *
+ * \returns 0 on success, -1 at the end of the file
+ */
+static int getVarint(TraceReader* reader, unsigned long long* value)
+{
+    int byte;
+    int shift = 0;
+
+    *value = 0;
+    do
+    {
+        byte = getc_unlocked(reader->file);
+        if (byte == EOF || shift > 63)
+        {
+            return -1;
+        }
+        *value |= (unsigned long long)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return 0;
+}
+
+/**
+ * \brief Decode one change of SCLK from the 3 bits which hold it in a token
+ */
+static void sclkRecord(TraceRecord* record, int bits)
+{
+    record->type = SCLK_INDEX;
+    record->reads = (bits >> 1) + 1;
+    record->mosi = bits & 1;
+}
+
+/**
+ * \brief Decode a token of one byte
+ */
+static void tokenRecord(TraceReader* reader, TraceRecord* record, int token)
+{
+    if (token & TRACE_SCLK)
+    {
+        sclkRecord(record, (token >> 4) & 7);
+        if (token & 1)
+        {
+            reader->second = (token >> 1) & 7;
+        }
+        return;
+    }
+    record->type = token >> 4;
+    record->reads = token & 15;
+    record->mosi = 0;
+}
+
+int traceNext(TraceReader* reader, TraceRecord* record)
+{
+    unsigned long long value;
+    int byte, pin, reads;
+
+    if (reader->second >= 0)
+    {
+        sclkRecord(record, reader->second);
+        reader->second = -1;
+        return 0;
+    }
+    if (reader->repeats > 0)
+    {
+        reader->repeats--;
+        tokenRecord(reader, record, reader->lastToken);
+        return 0;
+    }
+
+    byte = getc_unlocked(reader->file);
+    if (byte == EOF)
+    {
+        return -1;
+    }
+    if (byte & TRACE_SCLK)
+    {
+        reader->lastToken = byte;
+        tokenRecord(reader, record, byte);
+        return 0;
+    }
+    pin = byte >> 4;
+    reads = byte & 15;
+
+    if (reads == TRACE_META)
+    {
+        switch (pin)
+        {
+            case TRACE_TIME:
+            case TRACE_POLL:
+                if (getVarint(reader, &value))
+                {
+                    return -1;
+                }
+                reader->time += (long long)(value >> 1) ^ -(long long)(value & 1);
+                record->type = TRACE_RECORD_META(pin);
+                record->time = reader->time;
+                return 0;
+            case TRACE_REPEAT:
+                if (getVarint(reader, &value) || value == 0 || reader->lastToken < 0)
+                {
+                    return -1;
+                }
+                reader->repeats = value;
+                return traceNext(reader, record);
+            default:
+                return -1;
+        }
+    }
+
+    if (reads == TRACE_LONG)
+    {
+        if (getVarint(reader, &value))
+        {
+            return -1;
+        }
+        reader->lastToken = -1;
+        record->type = pin;
+        record->reads = value;
+        record->mosi = 0;
+        return 0;
+    }
+    reader->lastToken = byte;
+    tokenRecord(reader, record, byte);
+    return 0;
+}
+
+void traceClose(TraceReader* reader)
+{
+    fclose(reader->file);
+}
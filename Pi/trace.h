@@ -0,0 +1,203 @@
+// Date: 10/19/2026
+// Summary: Compact pin-level traces of the SPI and user interface pins for replaying off the rig
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "ring.h"
+
+#define TRACE_PINS 8                // pins traced: NCS, SCLK and MOSI, then the five UI pins
+#define TRACE_SPI_PINS 3            // pins read by the audio loop (the first in the trace)
+#define TRACE_VERSION 2             // changes whenever the format changes
+#define TRACE_CHUNK 4096            // bytes handed to the writer thread at once
+#define TRACE_CHUNKS 1024           // chunks which can wait for the writer (4 MB)
+#define TRACE_SYNC 48               // frames between timestamps (1 ms)
+#define TRACE_FLUSH 1024            // frames after which a partly full chunk is written anyway
+#define TRACE_UI_QUEUE 64           // polls of the UI pins which can wait to be merged
+#define TRACE_WRITE_TIME 10000      // time in microseconds between checks for chunks to write
+
+// Every record starts with a token byte.  With the top bit set, the byte holds one or two
+// changes of SCLK: 3 bits each (2 bits of reads of SCLK since its last change, less one, then
+// a bit set when the next read of MOSI changes too) and a low bit set when the second is used.
+// Otherwise the pin index is in bits 4-6 and the number of reads of that pin since its last
+// change in the bottom 4 (the read which saw the change included; always 0 for the UI pins,
+// which the audio loop doesn't read).
+#define TRACE_SCLK 0x80             // the byte holds changes of SCLK
+#define TRACE_SCLK_READS 4          // most reads between changes of SCLK held in such a byte
+#define TRACE_LONG 14               // the read count is a varint after the token instead
+#define TRACE_META 15               // the pin bits select one of the records below instead
+#define TRACE_TIME 0                // timestamp: zigzag varint of microseconds since the last
+#define TRACE_POLL 1                // the UI pins were polled: zigzag varint like TRACE_TIME
+#define TRACE_REPEAT 2              // the last token of one byte repeats: varint count
+#define TRACE_END 7                 // no more records
+
+/**
+ * \brief Start of a trace file
+ */
+typedef struct
+{
+    char magic[8];                  // "PINTRACE"
+    unsigned int version;           // TRACE_VERSION
+    unsigned int levels;            // level of each pin at the start (bit i for pins[i])
+    int pins[TRACE_PINS];           // GPIO number of each pin
+    long long start;                // time of the start in microseconds (CLOCK_MONOTONIC)
+} TraceHeader;
+
+/**
+ * \brief Bytes handed from the audio loop to the writer thread
+ */
+typedef struct
+{
+    size_t used;                            // bytes filled
+    unsigned char bytes[TRACE_CHUNK];       // records
+} TraceChunk;
+
+/**
+ * \brief Levels of the UI pins seen by one poll of the input thread
+ */
+typedef struct
+{
+    unsigned int events;            // latched edges of pins 0-31
+    unsigned int levels;            // levels of pins 0-31
+    long long time;                 // time of the poll in microseconds
+} TracePoll;
+
+/**
+ * \brief State of a trace being captured
+ *
+ * The audio loop calls traceRead with every level it reads from NCS, SCLK and MOSI, which
+ * costs one increment and one compare unless the level changed.  Changes are placed by counting
+ * the reads of the pin between them rather than by time, so two changes of SCLK, along with a
+ * change of MOSI read on a rising edge, fit in one byte, and a run of identical bytes (SCLK
+ * toggling while MOSI holds) becomes one repeat record.  Reads of the UI
+ * pins by the input thread are queued and merged into the trace at the next frame, and a
+ * timestamp is written every TRACE_SYNC frames.  Full chunks go to a writer thread so the
+ * audio loop never waits on the SD card; if the writer falls behind, the trace stops.
+ */
+typedef struct
+{
+    volatile int active;                // whether pins are being traced
+    unsigned int levels;                // last level of each pin (bit i for pins[i])
+    int pins[TRACE_PINS];               // GPIO number of each pin
+    unsigned int reads[TRACE_SPI_PINS]; // reads of each SPI pin since its last edge
+    int sclk;                           // changes of SCLK held in sclkToken (0 to 2)
+    unsigned char sclkToken;            // token being filled with changes of SCLK
+    unsigned int riseReads;             // reads of MOSI when SCLK last rose (UINT_MAX if it fell)
+    int lastToken;                      // last token written (-1 if it can't repeat)
+    unsigned int repeats;               // repeats of lastToken not yet written
+    long long time;                     // last time written in microseconds
+    unsigned int frames;                // frames since the last timestamp
+    unsigned int unflushed;             // frames since a chunk was handed to the writer
+    TraceChunk chunk;                   // chunk being filled by the audio loop
+    Ring chunks;                        // chunks waiting for the writer thread
+    Ring polls;                         // TracePolls waiting to be merged
+    unsigned int uiEvents;              // edges latched since the last poll (input thread)
+    unsigned int uiLevels;              // UI levels at the last poll (input thread)
+    FILE* file;                         // file being written
+    size_t written;                     // bytes written to the file
+    size_t dropped;                     // chunks lost because the writer fell behind
+    size_t lostPolls;                   // UI polls lost because the queue was full
+    volatile int stop;                  // tells the writer thread to finish
+    pthread_t thread;                   // thread writing chunks to the file
+} Trace;
+
+/**
+ * \brief A decoded record of a trace
+ */
+typedef struct
+{
+    int type;                   // pin index for an edge, or TRACE_META + 1 + a meta type
+    unsigned int reads;         // reads of the pin since its last edge (edges only)
+    int mosi;                   // whether the next read of MOSI changes too (SCLK only)
+    long long time;             // time in microseconds (TRACE_TIME and TRACE_POLL)
+} TraceRecord;
+
+#define TRACE_RECORD_META(type) (TRACE_META + 1 + (type))   // TraceRecord type of a meta record
+
+/**
+ * \brief State of a trace being read
+ */
+typedef struct
+{
+    FILE* file;                 // file being read
+    TraceHeader header;         // start of the file
+    int lastToken;              // last token of one byte read
+    unsigned int repeats;       // repeats of lastToken still to be returned
+    int second;                 // second change of SCLK still to be returned (-1 if none)
+    long long time;             // last time read in microseconds
+} TraceReader;
+
+/**
+ * \brief Start capturing a trace
+ *
+ * \param trace         trace to start
+ * \param path          file to write
+ * \param pins          GPIO numbers of the TRACE_PINS pins, SPI pins first
+ * \param levels        levels of pins 0-31 now
+ *
+ * \returns 0 on success, -1 if the file can't be written or the writer can't start
+ */
+int traceStart(Trace* trace, const char* path, const int* pins, unsigned int levels);
+
+/**
+ * \brief Write what is left and close the file
+ */
+void traceStop(Trace* trace);
+
+/**
+ * \brief Add a change of an SPI pin (called by traceRead)
+ */
+void traceEdge(Trace* trace, int index);
+
+/**
+ * \brief Note that a frame started: write a timestamp now and then and merge the UI polls
+ */
+void traceFrame(Trace* trace);
+
+/**
+ * \brief Queue a poll of the UI pins (called from the input thread)
+ *
+ * \param trace         trace being captured
+ * \param events        edges latched since the last poll of pins 0-31
+ * \param levels        levels of pins 0-31
+ */
+void traceInput(Trace* trace, unsigned int events, unsigned int levels);
+
+/**
+ * \brief Count a read of an SPI pin and record it if the level changed (audio loop only)
+ *
+ * \param trace         trace being captured
+ * \param index         index of the pin in the trace (below TRACE_SPI_PINS)
+ * \param level         level read
+ */
+static inline void traceRead(Trace* trace, int index, int level)
+{
+    trace->reads[index]++;
+    if ((unsigned int)level != ((trace->levels >> index) & 1))
+    {
+        traceEdge(trace, index);
+    }
+}
+
+/**
+ * \brief Open a trace for reading
+ *
+ * \returns 0 on success, -1 if the file is not a trace of this version
+ */
+int traceOpen(TraceReader* reader, const char* path);
+
+/**
+ * \brief Read the next record
+ *
+ * \returns 0 on success, -1 at the end of the trace
+ */
+int traceNext(TraceReader* reader, TraceRecord* record);
+
+/**
+ * \brief Close a trace opened for reading
+ */
+void traceClose(TraceReader* reader);
+
+#endif
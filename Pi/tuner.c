@@ -0,0 +1,201 @@
+// Date: 10/19/2026
+// Summary: Chromatic tuner using an incrementally updated YIN difference function
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "tuner.h"
+#include "logger.h"
+
+#define GATE_POWER ((long long)TUNER_WINDOW * (TUNER_GATE * 16 * TUNER_DECIMATION) \
+    * (TUNER_GATE * 16 * TUNER_DECIMATION))
+
+static const char* noteNames[12] =
+    {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+/**
+ * \brief Estimate the pitch from the difference function and publish it
+ */
+static void tunerEstimate(Tuner* t)
+{
+    float normalized[TUNER_MAX_LAG + 2];
+    long long running = 0;
+    float lag, shift, frequency, midi;
+    long long a, b, c;
+    int tau;
+
+    // Too quiet to tune
+    if (t->power < GATE_POWER)
+    {
+        atomic_store(&t->note, -1);
+        return;
+    }
+
+    // Cumulative mean normalized difference function
+    normalized[0] = 1;
+    for (tau = 1; tau <= TUNER_MAX_LAG + 1; ++tau)
+    {
+        running += t->diff[tau];
+        normalized[tau] = running ? (float)t->diff[tau] * tau / running : 1;
+    }
+
+    // Take the first dip below the threshold, following it down to its minimum
+    for (tau = TUNER_MIN_LAG; tau <= TUNER_MAX_LAG; ++tau)
+    {
+        if (normalized[tau] < TUNER_THRESHOLD)
+        {
+            while (tau < TUNER_MAX_LAG && normalized[tau + 1] < normalized[tau])
+            {
+                tau++;
+            }
+            break;
+        }
+    }
+    if (tau > TUNER_MAX_LAG)
+    {
+        atomic_store(&t->note, -1);
+        return;
+    }
+
+    // Refine the period with a parabola through the raw difference function
+    a = t->diff[tau - 1];
+    b = t->diff[tau];
+    c = t->diff[tau + 1];
+    shift = (a - 2 * b + c) > 0 ? 0.5f * (a - c) / (a - 2 * b + c) : 0;
+    lag = tau + shift;
+
+    frequency = (float)TUNER_RATE / lag;
+    midi = 69 + 12 * log2f(frequency / 440);
+    atomic_store(&t->frequency, (int)(frequency * 100));
+    atomic_store(&t->cents, (int)lroundf((midi - roundf(midi)) * 100));
+    atomic_store(&t->note, (int)roundf(midi));
+}
+
+/**
+ * \brief Thread which consumes samples from the audio loop
+ */
+static void* tunerThread(void* arg)
+{
+    Tuner* t = arg;
+    short sample;
+    int lastNote = -1, lastCents = 0, note, cents;
+    char name[TUNER_NAME];
+
+    while (1)
+    {
+        if (atomic_exchange(&t->resetPending, 0))
+        {
+            tunerReset(t);
+            lastNote = -1;
+        }
+        while (!ringPop(&t->samples, &sample))
+        {
+            if (!tunerProcess(t, sample))
+            {
+                continue;
+            }
+
+            // Print the estimate whenever it changes noticeably
+            note = atomic_load(&t->note);
+            cents = atomic_load(&t->cents);
+            if (note != lastNote || abs(cents - lastCents) > 1)
+            {
+                if (note >= 0)
+                {
+                    tunerNoteName(note, name);
+                    logPrint("%-3s %+3d cents (%.2f Hz)\n", name, cents,
+                        atomic_load(&t->frequency) / 100.0f);
+                }
+                lastNote = note;
+                lastCents = cents;
+            }
+        }
+        usleep(2000);
+    }
+    return NULL;
+}
+
+int tunerStart(Tuner* t, int thread)
+{
+    tunerReset(t);
+    atomic_init(&t->resetPending, 0);
+    if (ringInit(&t->samples, sizeof(short), TUNER_QUEUE))
+    {
+        return -1;
+    }
+    if (thread && pthread_create(&t->thread, NULL, tunerThread, t))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void tunerReset(Tuner* t)
+{
+    memset(t->history, 0, sizeof(t->history));
+    memset(t->diff, 0, sizeof(t->diff));
+    t->count = 0;
+    t->accumulator = 0;
+    t->phase = 0;
+    t->power = 0;
+    atomic_store(&t->note, -1);
+    atomic_store(&t->cents, 0);
+    atomic_store(&t->frequency, 0);
+}
+
+void tunerRequestReset(Tuner* t)
+{
+    atomic_store(&t->resetPending, 1);
+}
+
+int tunerProcess(Tuner* t, short sample)
+{
+    int x, old, d;
+    int* now;
+    int* then;
+
+    // Decimate by summing (a boxcar filter); the scale does not matter to YIN
+    t->accumulator += sample;
+    if (++t->phase < TUNER_DECIMATION)
+    {
+        return 0;
+    }
+    x = t->accumulator;
+    t->accumulator = 0;
+    t->phase = 0;
+
+    // now[-tau] is the sample tau before x, then[-tau] the sample tau before the one leaving
+    // the window (samples before the first are zero)
+    now = t->history + (t->count & (TUNER_HISTORY - 1)) + TUNER_HISTORY;
+    now[0] = x;
+    now[-TUNER_HISTORY] = x;
+    then = now - TUNER_WINDOW;
+    old = then[0];
+
+    for (int tau = 1; tau <= TUNER_MAX_LAG + 1; ++tau)
+    {
+        d = x - now[-tau];
+        t->diff[tau] += (long long)d * d;
+        d = old - then[-tau];
+        t->diff[tau] -= (long long)d * d;
+    }
+    t->power += (long long)x * x - (long long)old * old;
+    t->count++;
+
+    // Estimate once the window is full, then every hop
+    if (t->count >= TUNER_WINDOW + TUNER_MAX_LAG && t->count % TUNER_HOP == 0)
+    {
+        tunerEstimate(t);
+        return 1;
+    }
+    return 0;
+}
+
+void tunerNoteName(int note, char* name)
+{
+    // Keep to the MIDI notes (C-1 to G9), so the octave is one digit or -1 and the name fits
+    note = note < 0 ? 0 : note > 127 ? 127 : note;
+    snprintf(name, TUNER_NAME, "%s%d", noteNames[note % 12], note / 12 - 1);
+}
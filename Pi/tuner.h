@@ -0,0 +1,96 @@
+// Date: 10/19/2026
+// Summary: Chromatic tuner using an incrementally updated YIN difference function
+
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "ring.h"
+#include "wav.h"
+
+#define TUNER_DECIMATION 4                              // input samples per tuner sample
+#define TUNER_RATE (SAMPLE_RATE / TUNER_DECIMATION)     // tuner samples per second
+#define TUNER_WINDOW 512        // tuner samples in the YIN integration window (43 ms)
+#define TUNER_MIN_LAG 6         // shortest period in tuner samples (2000 Hz)
+#define TUNER_MAX_LAG 180       // longest period in tuner samples (67 Hz)
+#define TUNER_HOP 256           // tuner samples between pitch estimates (21 ms)
+#define TUNER_HISTORY 1024      // tuner samples of history (power of 2 >= window + max lag)
+#define TUNER_THRESHOLD 0.15f   // YIN threshold on the normalized difference function
+#define TUNER_GATE 8            // quietest input in ADC steps which is tuned
+#define TUNER_QUEUE 8192        // input samples which can wait for the tuner thread
+#define TUNER_NAME 8            // characters in a note name, including the terminator
+
+/**
+ * \brief State of the tuner
+ *
+ * For every lag tau, diff[tau] holds the YIN difference function
+ *   sum over the window of (x[n] - x[n - tau])^2
+ * and is updated in O(TUNER_MAX_LAG) per tuner sample by adding the newest term and
+ * subtracting the one that left the window.  Integer samples keep the sums exact, so they
+ * never drift.  Decimation divides this cost by TUNER_DECIMATION per input sample.
+ */
+typedef struct
+{
+    Ring samples;                           // input samples from the audio loop
+    int history[2 * TUNER_HISTORY];         // tuner samples, stored twice so that the last
+                                            // TUNER_HISTORY are always contiguous
+    size_t count;                           // tuner samples received
+    int accumulator;                        // sum of the input samples of the tuner sample
+    int phase;                              // input samples in accumulator
+    long long diff[TUNER_MAX_LAG + 2];      // difference function for each lag
+    long long power;                        // sum of squares over the window
+    atomic_int note;                        // MIDI note of the last estimate (-1 if none)
+    atomic_int cents;                       // offset of the last estimate from note in cents
+    atomic_int frequency;                   // last estimate in hundredths of Hz
+    atomic_int resetPending;                // whether the thread should call tunerReset
+    pthread_t thread;                       // thread which consumes samples
+} Tuner;
+
+/**
+ * \brief Initialize the tuner
+ *
+ * \param t             tuner to initialize
+ * \param thread        whether to run a thread which consumes the samples from tunerPush
+ *                      and prints each new estimate
+ *
+ * \returns 0 on success, -1 on failure
+ */
+int tunerStart(Tuner* t, int thread);
+
+/**
+ * \brief Forget all samples so the next estimate only uses new input
+ */
+void tunerReset(Tuner* t);
+
+/**
+ * \brief Have the tuner thread call tunerReset once it has taken the samples already queued
+ *
+ * The audio loop calls this rather than tunerReset, which would race with the thread.
+ */
+void tunerRequestReset(Tuner* t);
+
+/**
+ * \brief Queue an input sample for the tuner thread (called by the audio loop)
+ */
+static inline void tunerPush(Tuner* t, short sample)
+{
+    ringPush(&t->samples, &sample);
+}
+
+/**
+ * \brief Add an input sample, updating the estimate every TUNER_HOP tuner samples
+ *
+ * \returns 1 if a new estimate was made, 0 otherwise
+ */
+int tunerProcess(Tuner* t, short sample);
+
+/**
+ * \brief Name of a MIDI note (such as "E2")
+ *
+ * \param note          MIDI note number (clamped to 0-127)
+ * \param name          receives the name (TUNER_NAME characters)
+ */
+void tunerNoteName(int note, char* name);
+
+#endif
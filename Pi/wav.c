@@ -0,0 +1,114 @@
+// Date: 10/19/2026
+// Summary: Reads and writes the headers of 16-bit PCM .wav files
+
+#include <string.h>
+#include "wav.h"
+
+/**
+ * \brief Fill in a header for 16-bit PCM samples directly following it
+ */
+static void wavFillHeader(WavHeader* header, int channels, size_t frames)
+{
+    size_t dataLength = frames * channels * sizeof(short);
+
+    memcpy(header->fileFormat, "RIFF", 4);
+    header->fileLength = dataLength + sizeof(WavHeader) - 8;
+    memcpy(header->fileType, "WAVE", 4);
+    memcpy(header->formatHeader, "fmt ", 4);
+    header->formatLength = 16;
+    header->formatType = 1;
+    header->channels = channels;
+    header->sampleRate = SAMPLE_RATE;
+    header->bitRate = SAMPLE_RATE * BIT_DEPTH * channels / 8;
+    header->bytesPerSample = BIT_DEPTH * channels / 8;
+    header->bitDepth = BIT_DEPTH;
+    memcpy(header->dataHeader, "data", 4);
+    header->dataLength = dataLength;
+}
+
+void wavWriteHeader(FILE* file, int channels, size_t frames)
+{
+    WavHeader header;
+    wavFillHeader(&header, channels, frames);
+    fwrite(&header, sizeof(WavHeader), 1, file);
+}
+
+size_t wavWriteHeaderAligned(FILE* file, int channels, size_t frames, size_t align)
+{
+    WavHeader header;
+    size_t dataOffset;
+    unsigned int padLength;
+
+    if (sizeof(WavHeader) % align == 0)
+    {
+        wavWriteHeader(file, channels, frames);
+        return sizeof(WavHeader);
+    }
+
+    // Leave room for the JUNK chunk's own 8-byte header before rounding up
+    dataOffset = (sizeof(WavHeader) + 8 + align - 1) / align * align;
+    padLength = dataOffset - sizeof(WavHeader) - 8;
+
+    // Write the RIFF and format chunks, the padding and then the header of the data chunk
+    wavFillHeader(&header, channels, frames);
+    header.fileLength += dataOffset - sizeof(WavHeader);
+    fwrite(&header, offsetof(WavHeader, dataHeader), 1, file);
+    fwrite("JUNK", 1, 4, file);
+    fwrite(&padLength, 4, 1, file);
+    fseek(file, padLength, SEEK_CUR);
+    fwrite(header.dataHeader, 1, 8, file);
+
+    return dataOffset;
+}
+
+int wavReadHeader(FILE* file, WavInfo* info)
+{
+    char riff[12];
+    char chunkID[4];
+    unsigned int chunkLength;
+    short format[8];
+    int haveFormat = 0;
+
+    // The file must start with a RIFF chunk of type WAVE
+    if (fread(riff, 1, 12, file) != 12 || memcmp(riff, "RIFF", 4) || memcmp(riff + 8, "WAVE", 4))
+    {
+        return -1;
+    }
+
+    // Walk the sub-chunks until we find the samples, skipping any we do not understand
+    while (fread(chunkID, 1, 4, file) == 4 && fread(&chunkLength, 4, 1, file) == 1)
+    {
+        if (!memcmp(chunkID, "fmt ", 4) && chunkLength >= 16)
+        {
+            if (fread(format, 1, 16, file) != 16)
+            {
+                return -1;
+            }
+            fseek(file, chunkLength - 16 + (chunkLength & 1), SEEK_CUR);
+
+            // format = {type, channels, rate (2 shorts), bit rate (2 shorts), block, depth}
+            info->channels = format[1];
+            memcpy(&info->sampleRate, &format[2], sizeof(int));
+            if (format[0] != 1 || format[7] != BIT_DEPTH || info->channels < 1)
+            {
+                return -1;
+            }
+            haveFormat = 1;
+        }
+        else if (!memcmp(chunkID, "data", 4))
+        {
+            if (!haveFormat)
+            {
+                return -1;
+            }
+            info->frames = chunkLength / (info->channels * sizeof(short));
+            return 0;
+        }
+        else
+        {
+            fseek(file, chunkLength + (chunkLength & 1), SEEK_CUR);
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,78 @@
+// Date: 10/19/2026
+// Summary: Reads and writes the headers of 16-bit PCM .wav files
+
+#ifndef WAV_H
+#define WAV_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// WAV constants
+#define SAMPLE_RATE 48000   // samples per second
+#define BIT_DEPTH 16        // bits per sample
+#define MAX_CHANNELS 2      // maximum number of interleaved channels the receiver handles
+
+/**
+ * \brief Struct storing the 44-bit file header of a .wav file
+ */
+typedef struct
+{
+    char fileFormat[4];
+    int fileLength;
+    char fileType[4];
+    char formatHeader[4];
+    int formatLength;
+    short formatType;
+    short channels;
+    int sampleRate;
+    int bitRate;
+    short bytesPerSample;
+    short bitDepth;
+    char dataHeader[4];
+    int dataLength;
+} WavHeader;
+
+/**
+ * \brief Format of the audio stored in a .wav file
+ */
+typedef struct
+{
+    int channels;       // number of interleaved channels
+    int sampleRate;     // frames per second
+    size_t frames;      // number of frames (one sample from every channel) in the file
+} WavInfo;
+
+/**
+ * \brief Write the header of a 16-bit PCM .wav file
+ *
+ * \param file          file positioned at its beginning
+ * \param channels      number of interleaved channels
+ * \param frames        number of frames that will follow the header
+ */
+void wavWriteHeader(FILE* file, int channels, size_t frames);
+
+/**
+ * \brief Write the header of a 16-bit PCM .wav file, padded so the samples start aligned
+ *
+ * A "JUNK" chunk (which readers skip) fills the gap between the format and the samples.
+ *
+ * \param file          file positioned at its beginning
+ * \param channels      number of interleaved channels
+ * \param frames        number of frames that will follow the header
+ * \param align         required alignment in bytes of the samples (such as the page size)
+ *
+ * \returns offset in bytes of the first sample
+ */
+size_t wavWriteHeaderAligned(FILE* file, int channels, size_t frames, size_t align);
+
+/**
+ * \brief Read the header of a 16-bit PCM .wav file and seek to its sample data
+ *
+ * \param file          file positioned at its beginning
+ * \param info          filled with the format of the file
+ *
+ * \returns 0 on success, -1 if file is not a 16-bit PCM .wav file
+ */
+int wavReadHeader(FILE* file, WavInfo* info);
+
+#endif